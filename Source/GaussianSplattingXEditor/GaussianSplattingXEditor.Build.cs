@@ -42,6 +42,8 @@ public class GaussianSplattingXEditor : ModuleRules
 				"Slate",
 				"SlateCore",
 				"NiagaraEditor",
+				"ContentBrowser",
+				"GaussianSplattingXRuntime",
 				"GaussianSplattingXImporter"
 				// ... add private dependencies that you statically link with here ...	
 			]
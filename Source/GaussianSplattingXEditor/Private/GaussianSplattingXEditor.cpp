@@ -1,4 +1,4 @@
-// Copyright Epic Games, Inc. All Rights Reserved.
+﻿// Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "GaussianSplattingXEditor.h"
 #include "Style.h"
@@ -7,11 +7,100 @@
 #include "IDesktopPlatform.h"
 #include "Widgets/Docking/SDockTab.h"
 #include "Widgets/Layout/SBox.h"
+#include "Widgets/SBoxPanel.h"
 #include "ToolMenus.h"
+#include "ContentBrowserModule.h"
+#include "IContentBrowserSingleton.h"
+#include "Misc/MessageDialog.h"
+#include "GaussianSplattingXImporter/Public/SceneExporter.h"
 #include "GaussianSplattingXImporter/Public/SceneManager.h"
 
 static const FName GaussianSplattingXTabName("GaussianSplattingX");
 
+/// 打开文件选择对话框选择场景文件（.ply / .splat / .spz），如果用户取消或没有选择文件则返回 false
+static bool OpenSceneFileDialog(const FString& Title, const EFileDialogFlags::Type Flags, TArray<FString>& OutFiles)
+{
+	IDesktopPlatform* DesktopPlatform = FDesktopPlatformModule::Get();
+	if (!DesktopPlatform)
+	{
+		return false;
+	}
+
+	const void* ParentWindowHandle = nullptr;
+	const bool bOpened = DesktopPlatform->OpenFileDialog(
+		ParentWindowHandle,
+		Title,
+		FPaths::ProjectContentDir(),
+		TEXT(""),
+		TEXT("Gaussian Splatting Scene (*.ply;*.splat;*.spz)|*.ply;*.splat;*.spz"),
+		Flags,
+		OutFiles
+	);
+
+	return bOpened && OutFiles.Num() > 0;
+}
+
+/// 导出内容浏览器中选中的第一个 SceneBufferAsset
+static void ExportSelectedSceneAsset()
+{
+	const FContentBrowserModule& ContentBrowserModule = FModuleManager::LoadModuleChecked<FContentBrowserModule>(
+		TEXT("ContentBrowser"));
+	TArray<FAssetData> SelectedAssets;
+	ContentBrowserModule.Get().GetSelectedAssets(SelectedAssets);
+
+	const USceneBufferAsset* SceneBufferAsset = nullptr;
+	for (const FAssetData& AssetData : SelectedAssets)
+	{
+		if (AssetData.IsInstanceOf<USceneBufferAsset>())
+		{
+			SceneBufferAsset = Cast<USceneBufferAsset>(AssetData.GetAsset());
+			break;
+		}
+	}
+	if (!SceneBufferAsset)
+	{
+		FMessageDialog::Open(EAppMsgType::Ok,
+		                     FText::FromString("Select a SceneBufferAsset in the Content Browser to export."));
+		return;
+	}
+
+	IDesktopPlatform* DesktopPlatform = FDesktopPlatformModule::Get();
+	if (!DesktopPlatform)
+	{
+		return;
+	}
+
+	TArray<FString> OutFiles;
+	const bool bSaved = DesktopPlatform->SaveFileDialog(
+		nullptr,
+		TEXT("Export scene"),
+		FPaths::ProjectSavedDir(),
+		SceneBufferAsset->GetName() + TEXT(".spz"),
+		TEXT("Niantic SPZ (*.spz)|*.spz|Splat (*.splat)|*.splat|Binary PLY (*.ply)|*.ply"),
+		EFileDialogFlags::None,
+		OutFiles
+	);
+	if (!bSaved || OutFiles.Num() == 0)
+	{
+		return;
+	}
+
+	ESceneExportFormat Format;
+	if (!FSceneExporter::GetFormatFromExtension(OutFiles[0], Format))
+	{
+		FMessageDialog::Open(EAppMsgType::Ok, FText::FromString("Unsupported export format, use .ply, .splat or .spz."));
+		return;
+	}
+
+	FScopedSlowTask SlowTask(100.f, FText::FromString("Exporting scene..."));
+	SlowTask.MakeDialog();
+
+	FSceneExporter::ExportScene(*SceneBufferAsset, OutFiles[0], Format, [&SlowTask](const float Progress)
+	{
+		SlowTask.EnterProgressFrame(Progress * 100.f - SlowTask.CompletedWork);
+	});
+}
+
 #define LOCTEXT_NAMESPACE "FGaussianSplattingXEditor"
 
 void FGaussianSplattingXEditorModule::StartupModule()
@@ -64,43 +153,85 @@ TSharedRef<SDockTab> FGaussianSplattingXEditorModule::OnSpawnPluginTab(const FSp
 			.HAlign(HAlign_Center)
 			.VAlign(VAlign_Center)
 			[
-				SNew(SButton)
-				.Text(FText::FromString("Import .ply file"))
-				.OnClicked(FOnClicked::CreateLambda([]() -> FReply
-				{
-					IDesktopPlatform* DesktopPlatform = FDesktopPlatformModule::Get();
-					if (!DesktopPlatform)
+				SNew(SVerticalBox)
+				+ SVerticalBox::Slot()
+				.AutoHeight()
+				.Padding(4.0f)
+				[
+					SNew(SButton)
+					.Text(FText::FromString("Import scene file"))
+					.OnClicked(FOnClicked::CreateLambda([]() -> FReply
 					{
+						TArray<FString> OutFiles;
+						if (!OpenSceneFileDialog(TEXT("Select scene file to import"), EFileDialogFlags::None, OutFiles))
+						{
+							return FReply::Handled();
+						}
+
+						// 只读取文件头预览，确认之后再读取全部数据
+						FSceneFileSummary Summary;
+						if (FSceneManager::ScanSceneFile(OutFiles[0], Summary) &&
+							FMessageDialog::Open(EAppMsgType::OkCancel, FText::FromString(
+								                     FString::Printf(TEXT("%s\n\n%s\n\nImport this scene?"),
+								                                     *FPaths::GetCleanFilename(OutFiles[0]),
+								                                     *Summary.ToString()))) != EAppReturnType::Ok)
+						{
+							return FReply::Handled();
+						}
+
+						FScopedSlowTask SlowTask(100.f, FText::FromString("Importing scene file..."));
+						SlowTask.MakeDialog();
+
+						FSceneManager::ImportScene(OutFiles[0], [&SlowTask](const float Progress)
+						{
+							SlowTask.EnterProgressFrame(Progress * 100.f - SlowTask.CompletedWork);
+						});
+
 						return FReply::Handled();
-					}
-
-					const void* ParentWindowHandle = nullptr;
-					TArray<FString> OutFiles;
-					const bool bOpened = DesktopPlatform->OpenFileDialog(
-						ParentWindowHandle,
-						TEXT("Select .ply file to import"),
-						FPaths::ProjectContentDir(),
-						TEXT(""),
-						TEXT("*.ply"),
-						EFileDialogFlags::None,
-						OutFiles
-					);
-
-					if (!bOpened || OutFiles.Num() == 0)
+					}))
+				]
+				+ SVerticalBox::Slot()
+				.AutoHeight()
+				.Padding(4.0f)
+				[
+					SNew(SButton)
+					.Text(FText::FromString("Reimport changed scene files"))
+					.ToolTipText(FText::FromString(
+						"Reimport the selected files in place, skipping files that have not changed since the last import"))
+					.OnClicked(FOnClicked::CreateLambda([]() -> FReply
 					{
-						return FReply::Handled();
-					}
+						TArray<FString> OutFiles;
+						if (!OpenSceneFileDialog(TEXT("Select scene files to reimport"), EFileDialogFlags::Multiple,
+						                         OutFiles))
+						{
+							return FReply::Handled();
+						}
 
-					FScopedSlowTask SlowTask(100.f, FText::FromString("Importing .ply file..."));
-					SlowTask.MakeDialog();
+						FScopedSlowTask SlowTask(100.f, FText::FromString("Reimporting scene files..."));
+						SlowTask.MakeDialog();
 
-					FSceneManager::ImportScene(OutFiles[0], [&SlowTask](const float Progress)
-					{
-						SlowTask.EnterProgressFrame(Progress * 100.f - SlowTask.CompletedWork);
-					});
+						FSceneManager::ReimportScenes(OutFiles, [&SlowTask](const float Progress)
+						{
+							SlowTask.EnterProgressFrame(Progress * 100.f - SlowTask.CompletedWork);
+						});
 
-					return FReply::Handled();
-				}))
+						return FReply::Handled();
+					}))
+				]
+				+ SVerticalBox::Slot()
+				.AutoHeight()
+				.Padding(4.0f)
+				[
+					SNew(SButton)
+					.Text(FText::FromString("Export selected scene asset"))
+					.ToolTipText(FText::FromString(
+						"Export the SceneBufferAsset selected in the Content Browser to .spz, .splat or binary .ply"))
+					.OnClicked(FOnClicked::CreateLambda([]() -> FReply
+					{
+						ExportSelectedSceneAsset();
+						return FReply::Handled();
+					}))
+				]
 			]
 		];
 }
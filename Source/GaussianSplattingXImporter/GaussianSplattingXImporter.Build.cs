@@ -19,7 +19,8 @@ public class GaussianSplattingXImporter : ModuleRules
 				"CoreUObject",
 				"Engine",
 				"UnrealEd",
-				"Kismet"
+				"Kismet",
+				"DirectoryWatcher"
 			]
 		);
 
@@ -1,4 +1,5 @@
 ﻿#include "GaussianSplattingXImporter.h"
+#include "SceneLiveReload.h"
 #include "tinyply.h"
 
 #define LOCTEXT_NAMESPACE "FGaussianSplattingXImporterModule"
@@ -6,10 +7,14 @@
 void FGaussianSplattingXImporterModule::StartupModule()
 {
 	UE_LOG(LogTemp, Log, TEXT("GaussianSplattingXImporter loaded"));
+
+	// 监视开启了 Live Reload 的 Scene Actor 绑定的 PLY 文件
+	FSceneLiveReload::Startup();
 }
 
 void FGaussianSplattingXImporterModule::ShutdownModule()
 {
+	FSceneLiveReload::Shutdown();
 }
 
 #undef LOCTEXT_NAMESPACE
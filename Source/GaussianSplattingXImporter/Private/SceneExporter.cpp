@@ -0,0 +1,415 @@
+﻿#include "SceneExporter.h"
+
+#include "Async/ParallelFor.h"
+#include "HAL/FileManager.h"
+#include "Misc/Compression.h"
+#include "Tasks/Task.h"
+
+namespace
+{
+	/// 0 阶球谐函数的系数，颜色 = SH_C0 * f_dc + 0.5
+	constexpr double SH_C0 = 0.28209479177387814;
+
+	constexpr double InvSqrt2 = 0.70710678118654752;
+
+	/// 每个并行任务编码的高斯数量
+	constexpr int32 EncodeBatchSize = 1024;
+
+	/// 流式写入时每块的高斯数量
+	constexpr int64 StreamBlockSize = 1 << 16;
+
+	/// 按批次并行处理 [Begin, Begin + Count) 的高斯
+	void ParallelForGaussians(const int64 Begin, const int64 Count, const TFunctionRef<void(int64 Index)> Body)
+	{
+		const int32 NumBatches = static_cast<int32>((Count + EncodeBatchSize - 1) / EncodeBatchSize);
+		ParallelFor(NumBatches, [Begin, Count, &Body](const int32 BatchIndex)
+		{
+			const int64 BatchBegin = static_cast<int64>(BatchIndex) * EncodeBatchSize;
+			const int64 BatchEnd = FMath::Min(BatchBegin + EncodeBatchSize, Count);
+			for (int64 i = BatchBegin; i < BatchEnd; ++i)
+			{
+				Body(Begin + i);
+			}
+		});
+	}
+
+	/// 资产中保存的是激活后的不透明度，PLY 需要写回 logit
+	double InverseSigmoid(const double Value)
+	{
+		const double Clamped = FMath::Clamp(Value, UE_DOUBLE_SMALL_NUMBER, 1.0 - UE_DOUBLE_SMALL_NUMBER);
+		return FMath::Loge(Clamped / (1.0 - Clamped));
+	}
+
+	/// 资产中保存的是线性缩放，PLY 和 .spz 需要对数缩放
+	double LogScale(const double Value)
+	{
+		return FMath::Loge(FMath::Max(Value, UE_DOUBLE_SMALL_NUMBER));
+	}
+
+	uint8 QuantizeUnorm8(const double Value)
+	{
+		return static_cast<uint8>(FMath::Clamp(FMath::RoundToInt(Value * 255.0), 0, 255));
+	}
+
+	void WriteFloat(uint8*& Dest, const float Value)
+	{
+		FMemory::Memcpy(Dest, &Value, sizeof(float));
+		Dest += sizeof(float);
+	}
+
+	void WriteHeader(FArchive& Writer, const FString& Header)
+	{
+		const FTCHARToUTF8 Utf8Header(*Header);
+		Writer.Serialize(const_cast<ANSICHAR*>(Utf8Header.Get()), Utf8Header.Length());
+	}
+}
+
+bool FSceneExporter::ExportScene(const USceneBufferAsset& Scene, const FString& FilePath,
+                                 const ESceneExportFormat Format, TFunction<void(float)> OnProgress)
+{
+	if (!OnProgress)
+	{
+		OnProgress = [](float) {};
+	}
+
+	OnProgress(0.0f);
+	UE_LOG(LogTemp, Log, TEXT("Exporting %s (%u Gaussians) to: %s"), *Scene.GetName(), Scene.GaussianCount, *FilePath);
+
+	const TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*FilePath));
+	if (!Writer)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to open file for writing: %s"), *FilePath);
+		return false;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	bool bSuccess = false;
+	switch (Format)
+	{
+	case ESceneExportFormat::Ply:
+		bSuccess = ExportPly(Scene, *Writer, OnProgress);
+		break;
+	case ESceneExportFormat::Splat:
+		bSuccess = ExportSplat(Scene, *Writer, OnProgress);
+		break;
+	case ESceneExportFormat::Spz:
+		bSuccess = ExportSpz(Scene, *Writer, OnProgress);
+		break;
+	}
+	bSuccess &= Writer->Close();
+
+	if (!bSuccess)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to export scene to: %s"), *FilePath);
+		IFileManager::Get().Delete(*FilePath);
+		return false;
+	}
+
+	OnProgress(1.0f);
+	UE_LOG(LogTemp, Log, TEXT("Export completed in %.2f s: %s"), FPlatformTime::Seconds() - StartTime, *FilePath);
+	return true;
+}
+
+bool FSceneExporter::GetFormatFromExtension(const FString& FilePath, ESceneExportFormat& OutFormat)
+{
+	const FString Extension = FPaths::GetExtension(FilePath);
+	if (Extension.Equals(TEXT("ply"), ESearchCase::IgnoreCase))
+	{
+		OutFormat = ESceneExportFormat::Ply;
+		return true;
+	}
+	if (Extension.Equals(TEXT("splat"), ESearchCase::IgnoreCase))
+	{
+		OutFormat = ESceneExportFormat::Splat;
+		return true;
+	}
+	if (Extension.Equals(TEXT("spz"), ESearchCase::IgnoreCase))
+	{
+		OutFormat = ESceneExportFormat::Spz;
+		return true;
+	}
+	return false;
+}
+
+void FSceneExporter::GetPlyRotation(const FQuat& Rotation, float OutRotation[4])
+{
+	OutRotation[0] = Rotation.W;
+	OutRotation[1] = Rotation.X;
+	OutRotation[2] = Rotation.Y;
+	OutRotation[3] = Rotation.Z;
+}
+
+void FSceneExporter::WriteStreamed(FArchive& Writer, const int64 GaussianCount, const int64 BytesPerGaussian,
+                                   const TFunctionRef<void(int64 Index, uint8* Dest)> EncodeGaussian,
+                                   const TFunction<void(float)>& OnProgress)
+{
+	// 两个缓冲区交替使用：一个在后台写入文件，另一个在编码下一块
+	TArray64<uint8> Buffers[2];
+	UE::Tasks::FTask WriteTask;
+
+	int64 BlockIndex = 0;
+	for (int64 BlockStart = 0; BlockStart < GaussianCount; BlockStart += StreamBlockSize, ++BlockIndex)
+	{
+		const int64 BlockCount = FMath::Min(StreamBlockSize, GaussianCount - BlockStart);
+		TArray64<uint8>& Buffer = Buffers[BlockIndex % 2];
+		Buffer.SetNumUninitialized(BlockCount * BytesPerGaussian, EAllowShrinking::No);
+
+		uint8* BufferData = Buffer.GetData();
+		ParallelForGaussians(BlockStart, BlockCount, [&](const int64 Index)
+		{
+			EncodeGaussian(Index, BufferData + (Index - BlockStart) * BytesPerGaussian);
+		});
+
+		// 上一块写完之后才能开始写这一块，同时保证再下一块复用的缓冲区已经空闲
+		if (WriteTask.IsValid())
+		{
+			WriteTask.Wait();
+		}
+		WriteTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [&Writer, &Buffer]
+		{
+			Writer.Serialize(Buffer.GetData(), Buffer.Num());
+		});
+
+		OnProgress(static_cast<float>(BlockStart + BlockCount) / static_cast<float>(GaussianCount));
+	}
+
+	if (WriteTask.IsValid())
+	{
+		WriteTask.Wait();
+	}
+}
+
+// =============================== PLY ===============================
+
+bool FSceneExporter::ExportPly(const USceneBufferAsset& Scene, FArchive& Writer,
+                               const TFunction<void(float)>& OnProgress)
+{
+	const int64 NumRestPerChannel = Scene.SHCoefficientsCount - 1;
+
+	// 属性顺序与训练器输出一致：位置、f_dc、f_rest（按颜色通道分组）、不透明度、缩放、旋转
+	FString Header = FString::Printf(
+		TEXT("ply\nformat binary_little_endian 1.0\nelement vertex %u\n"), Scene.GaussianCount);
+	for (const TCHAR* Name : {TEXT("x"), TEXT("y"), TEXT("z"), TEXT("f_dc_0"), TEXT("f_dc_1"), TEXT("f_dc_2")})
+	{
+		Header += FString::Printf(TEXT("property float %s\n"), Name);
+	}
+	for (int64 i = 0; i < NumRestPerChannel * 3; ++i)
+	{
+		Header += FString::Printf(TEXT("property float f_rest_%lld\n"), i);
+	}
+	for (const TCHAR* Name : {
+		     TEXT("opacity"), TEXT("scale_0"), TEXT("scale_1"), TEXT("scale_2"),
+		     TEXT("rot_0"), TEXT("rot_1"), TEXT("rot_2"), TEXT("rot_3")
+	     })
+	{
+		Header += FString::Printf(TEXT("property float %s\n"), Name);
+	}
+	Header += TEXT("end_header\n");
+	WriteHeader(Writer, Header);
+
+	const int64 BytesPerGaussian = (3 + 3 + NumRestPerChannel * 3 + 1 + 3 + 4) * sizeof(float);
+	WriteStreamed(Writer, Scene.GaussianCount, BytesPerGaussian, [&Scene, NumRestPerChannel](const int64 i, uint8* Dest)
+	{
+		const FVector& Position = Scene.GaussianPositions[i];
+		WriteFloat(Dest, Position.X);
+		WriteFloat(Dest, Position.Y);
+		WriteFloat(Dest, Position.Z);
+
+		const FVector* SH = &Scene.GaussianSHCoefficients[i * Scene.SHCoefficientsCount];
+		for (int32 k = 0; k < 3; ++k)
+		{
+			WriteFloat(Dest, SH[0][k]);
+		}
+		for (int32 k = 0; k < 3; ++k)
+		{
+			for (int64 j = 1; j <= NumRestPerChannel; ++j)
+			{
+				WriteFloat(Dest, SH[j][k]);
+			}
+		}
+
+		WriteFloat(Dest, InverseSigmoid(Scene.GaussianOpacities[i]));
+
+		const FVector& Scale = Scene.GaussianScales[i];
+		WriteFloat(Dest, LogScale(Scale.X));
+		WriteFloat(Dest, LogScale(Scale.Y));
+		WriteFloat(Dest, LogScale(Scale.Z));
+
+		float Rotation[4];
+		GetPlyRotation(Scene.GaussianRotations[i], Rotation);
+		for (int32 k = 0; k < 4; ++k)
+		{
+			WriteFloat(Dest, Rotation[k]);
+		}
+	}, OnProgress);
+
+	return !Writer.IsError();
+}
+
+// =============================== .splat ===============================
+
+bool FSceneExporter::ExportSplat(const USceneBufferAsset& Scene, FArchive& Writer,
+                                 const TFunction<void(float)>& OnProgress)
+{
+	// 每个高斯 32 字节：位置 3 x float，线性缩放 3 x float，颜色 RGBA 4 x uint8，旋转 wxyz 4 x uint8
+	constexpr int64 SplatStride = 32;
+
+	WriteStreamed(Writer, Scene.GaussianCount, SplatStride, [&Scene](const int64 i, uint8* Dest)
+	{
+		const FVector& Position = Scene.GaussianPositions[i];
+		WriteFloat(Dest, Position.X);
+		WriteFloat(Dest, Position.Y);
+		WriteFloat(Dest, Position.Z);
+
+		const FVector& Scale = Scene.GaussianScales[i];
+		WriteFloat(Dest, Scale.X);
+		WriteFloat(Dest, Scale.Y);
+		WriteFloat(Dest, Scale.Z);
+
+		const FVector& DC = Scene.GaussianSHCoefficients[i * Scene.SHCoefficientsCount];
+		*Dest++ = QuantizeUnorm8(SH_C0 * DC.X + 0.5);
+		*Dest++ = QuantizeUnorm8(SH_C0 * DC.Y + 0.5);
+		*Dest++ = QuantizeUnorm8(SH_C0 * DC.Z + 0.5);
+		*Dest++ = QuantizeUnorm8(Scene.GaussianOpacities[i]);
+
+		// 资产中的旋转已经归一化
+		float Rotation[4];
+		GetPlyRotation(Scene.GaussianRotations[i], Rotation);
+		for (int32 k = 0; k < 4; ++k)
+		{
+			*Dest++ = static_cast<uint8>(FMath::Clamp(FMath::RoundToInt(Rotation[k] * 128.0f + 128.0f), 0, 255));
+		}
+	}, OnProgress);
+
+	return !Writer.IsError();
+}
+
+// =============================== .spz ===============================
+
+bool FSceneExporter::ExportSpz(const USceneBufferAsset& Scene, FArchive& Writer,
+                               const TFunction<void(float)>& OnProgress)
+{
+	constexpr uint32 SpzMagic = 0x5053474e; // "NGSP"
+	constexpr uint32 SpzVersion = 3;
+	constexpr int64 SpzHeaderSize = 16;
+	constexpr uint32 FractionalBits = 12;
+	constexpr double SpzColorScale = 0.15;
+
+	const int64 Count = Scene.GaussianCount;
+	const uint32 SHDegree = FMath::Min<uint32>(Scene.SHDim, 3);
+	const int64 NumRestPerChannel = (SHDegree + 1) * (SHDegree + 1) - 1;
+
+	// 每个属性连续存储：位置、不透明度、颜色、缩放、旋转、球谐系数
+	const int64 DataSize = SpzHeaderSize + Count * (9 + 1 + 3 + 3 + 4 + NumRestPerChannel * 3);
+	if (DataSize > MAX_int32)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Scene is too large for .spz export (%lld bytes before compression)."), DataSize);
+		return false;
+	}
+
+	TArray64<uint8> Data;
+	Data.SetNumZeroed(DataSize);
+	uint8* Header = Data.GetData();
+	FMemory::Memcpy(Header + 0, &SpzMagic, sizeof(uint32));
+	FMemory::Memcpy(Header + 4, &SpzVersion, sizeof(uint32));
+	const uint32 NumPoints = Count;
+	FMemory::Memcpy(Header + 8, &NumPoints, sizeof(uint32));
+	Header[12] = SHDegree;
+	Header[13] = FractionalBits;
+
+	uint8* Positions = Data.GetData() + SpzHeaderSize;
+	uint8* Alphas = Positions + Count * 9;
+	uint8* Colors = Alphas + Count;
+	uint8* Scales = Colors + Count * 3;
+	uint8* Rotations = Scales + Count * 3;
+	uint8* SHRest = Rotations + Count * 4;
+
+	// .spz 内部使用 RUB 坐标系，PLY 使用 RDF，需要翻转 y 和 z；球谐系数按基函数的奇偶性翻转符号
+	static constexpr double FlipSH[15] = {
+		-1, -1, 1,
+		-1, 1, 1, -1, 1,
+		-1, 1, -1, -1, 1, -1, 1,
+	};
+	static constexpr double FlipPosition[3] = {1, -1, -1};
+
+	ParallelForGaussians(0, Count, [&](const int64 i)
+	{
+		// 24 位有符号定点数
+		const FVector& Position = Scene.GaussianPositions[i];
+		for (int32 k = 0; k < 3; ++k)
+		{
+			const int32 Fixed = FMath::Clamp(
+				static_cast<int32>(FMath::RoundToDouble(Position[k] * FlipPosition[k] * (1 << FractionalBits))),
+				-(1 << 23), (1 << 23) - 1);
+			Positions[i * 9 + k * 3 + 0] = Fixed & 0xff;
+			Positions[i * 9 + k * 3 + 1] = (Fixed >> 8) & 0xff;
+			Positions[i * 9 + k * 3 + 2] = (Fixed >> 16) & 0xff;
+		}
+
+		Alphas[i] = QuantizeUnorm8(Scene.GaussianOpacities[i]);
+
+		const FVector* SH = &Scene.GaussianSHCoefficients[i * Scene.SHCoefficientsCount];
+		for (int32 k = 0; k < 3; ++k)
+		{
+			Colors[i * 3 + k] = QuantizeUnorm8(SH[0][k] * SpzColorScale + 0.5);
+			Scales[i * 3 + k] = static_cast<uint8>(FMath::Clamp(
+				FMath::RoundToInt((LogScale(Scene.GaussianScales[i][k]) + 10.0) * 16.0), 0, 255));
+		}
+
+		// .spz 的球谐系数按 [系数][RGB] 存储
+		for (int64 j = 0; j < NumRestPerChannel; ++j)
+		{
+			for (int32 k = 0; k < 3; ++k)
+			{
+				const double Value = SH[j + 1][k] * FlipSH[j];
+				SHRest[(i * NumRestPerChannel + j) * 3 + k] = static_cast<uint8>(
+					FMath::Clamp(FMath::RoundToInt(Value * 128.0 + 128.0), 0, 255));
+			}
+		}
+
+		// 旋转转成 xyzw 并翻转坐标系，然后用 smallest-three 编码：最高两位是最大分量的下标，其余分量各 10 位
+		float PlyRotation[4];
+		GetPlyRotation(Scene.GaussianRotations[i], PlyRotation);
+		const FQuat4d Rotation(PlyRotation[1], -PlyRotation[2], -PlyRotation[3], PlyRotation[0]);
+		const double Components[4] = {Rotation.X, Rotation.Y, Rotation.Z, Rotation.W};
+
+		int32 LargestIndex = 0;
+		for (int32 k = 1; k < 4; ++k)
+		{
+			if (FMath::Abs(Components[k]) > FMath::Abs(Components[LargestIndex]))
+			{
+				LargestIndex = k;
+			}
+		}
+		const bool bNegate = Components[LargestIndex] < 0.0;
+
+		constexpr uint32 ValueMask = (1u << 9) - 1;
+		uint32 Packed = LargestIndex;
+		for (int32 k = 0; k < 4; ++k)
+		{
+			if (k != LargestIndex)
+			{
+				const uint32 NegativeBit = (Components[k] < 0.0) ^ bNegate;
+				const uint32 Magnitude = FMath::Min<uint32>(
+					static_cast<uint32>(ValueMask * (FMath::Abs(Components[k]) / InvSqrt2) + 0.5), ValueMask);
+				Packed = (Packed << 10) | (NegativeBit << 9) | Magnitude;
+			}
+		}
+		FMemory::Memcpy(Rotations + i * 4, &Packed, sizeof(uint32));
+	});
+	OnProgress(0.6f);
+
+	// .spz 整体用 gzip 压缩，无法流式写入
+	int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Gzip, DataSize);
+	TArray64<uint8> Compressed;
+	Compressed.SetNumUninitialized(CompressedSize);
+	if (!FCompression::CompressMemory(NAME_Gzip, Compressed.GetData(), CompressedSize, Data.GetData(), DataSize))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to compress .spz data."));
+		return false;
+	}
+	OnProgress(0.9f);
+
+	Writer.Serialize(Compressed.GetData(), CompressedSize);
+	return !Writer.IsError();
+}
@@ -0,0 +1,242 @@
+﻿#include "SceneLiveReload.h"
+
+#include "DirectoryWatcherModule.h"
+#include "EngineUtils.h"
+#include "IDirectoryWatcher.h"
+#include "SceneActor.h"
+#include "SceneManager.h"
+#include "Async/Async.h"
+
+namespace
+{
+	TUniquePtr<FSceneLiveReload> LiveReload;
+
+	IDirectoryWatcher* GetDirectoryWatcher()
+	{
+		return FModuleManager::LoadModuleChecked<FDirectoryWatcherModule>(TEXT("DirectoryWatcher")).Get();
+	}
+
+	FString NormalizeFilePath(const FString& FilePath)
+	{
+		FString Result = FPaths::ConvertRelativePathToFull(FilePath);
+		FPaths::NormalizeFilename(Result);
+		return Result;
+	}
+}
+
+void FSceneLiveReload::Startup()
+{
+	LiveReload = MakeUnique<FSceneLiveReload>();
+	LiveReload->WorldTickStartHandle = FWorldDelegates::OnWorldTickStart.AddRaw(
+		LiveReload.Get(), &FSceneLiveReload::OnWorldTickStart);
+}
+
+void FSceneLiveReload::Shutdown()
+{
+	LiveReload.Reset();
+}
+
+FSceneLiveReload::~FSceneLiveReload()
+{
+	FWorldDelegates::OnWorldTickStart.Remove(WorldTickStartHandle);
+	for (TPair<FString, FWatchedFile>& Pair : WatchedFiles)
+	{
+		// 工作线程还在写 Staging，等它结束之后才能释放
+		if (Pair.Value.Future.IsValid())
+		{
+			Pair.Value.Future.Wait();
+		}
+		UnwatchFile(Pair.Value);
+	}
+}
+
+void FSceneLiveReload::OnWorldTickStart(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	// 编辑器和 PIE 的 World 都会触发，每帧只处理一次
+	if (LastTickFrame == GFrameCounter)
+	{
+		return;
+	}
+	LastTickFrame = GFrameCounter;
+
+	const double Now = FPlatformTime::Seconds();
+	if (Now >= NextScanTime)
+	{
+		NextScanTime = Now + ScanIntervalSeconds;
+		ScanActors();
+	}
+
+	bool bLoaded = false;
+	for (TPair<FString, FWatchedFile>& Pair : WatchedFiles)
+	{
+		FWatchedFile& File = Pair.Value;
+		if (File.Future.IsValid())
+		{
+			if (File.Future.IsReady())
+			{
+				FinishLoad(Pair.Key, File);
+				bLoaded = true;
+			}
+		}
+		else if (File.bChanged && Now - File.ChangeTime >= DebounceSeconds)
+		{
+			StartLoad(Pair.Key, File);
+		}
+	}
+
+	// 第一次读取完成后立即绑定，不用等到下一次扫描
+	if (bLoaded)
+	{
+		ScanActors();
+	}
+}
+
+void FSceneLiveReload::ScanActors()
+{
+	TSet<FString> UsedFiles;
+	for (const FWorldContext& Context : GEngine->GetWorldContexts())
+	{
+		UWorld* World = Context.World();
+		if (!World || (Context.WorldType != EWorldType::Editor && Context.WorldType != EWorldType::PIE))
+		{
+			continue;
+		}
+
+		for (TActorIterator<ASceneActor> It(World); It; ++It)
+		{
+			ASceneActor* SceneActor = *It;
+			if (!SceneActor->bLiveReload || SceneActor->LiveReloadFile.FilePath.IsEmpty())
+			{
+				// 关闭 Live Reload 后恢复使用 SceneNiagaraParameter 中的资产
+				if (SceneActor->GetLiveSceneBufferAsset())
+				{
+					SceneActor->SetLiveSceneBufferAsset(nullptr);
+				}
+				continue;
+			}
+
+			const FString FilePath = NormalizeFilePath(SceneActor->LiveReloadFile.FilePath);
+			UsedFiles.Add(FilePath);
+			const FWatchedFile& File = FindOrAddFile(FilePath);
+			if (File.Asset && SceneActor->GetLiveSceneBufferAsset() != File.Asset.Get())
+			{
+				SceneActor->SetLiveSceneBufferAsset(File.Asset.Get());
+			}
+		}
+	}
+
+	for (auto It = WatchedFiles.CreateIterator(); It; ++It)
+	{
+		if (!UsedFiles.Contains(It.Key()) && !It.Value().Future.IsValid())
+		{
+			UnwatchFile(It.Value());
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void FSceneLiveReload::StartLoad(const FString& FilePath, FWatchedFile& File)
+{
+	File.bChanged = false;
+
+	// 同一目录下其他文件的变化也会触发回调，时间戳没有变化时不需要重新读取
+	const FDateTime Timestamp = IFileManager::Get().GetTimeStamp(*FilePath);
+	if (Timestamp == FDateTime::MinValue())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Live reload file does not exist: %s"), *FilePath);
+		return;
+	}
+	if (Timestamp == File.LoadedTimestamp)
+	{
+		return;
+	}
+
+	File.PendingTimestamp = Timestamp;
+	File.Staging.Reset(NewObject<USceneBufferAsset>(GetTransientPackage(), NAME_None, RF_Transient));
+	File.Future = Async(EAsyncExecution::ThreadPool, [FilePath, Scene = File.Staging.Get()]()
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		FLoadResult Result;
+		Result.bSuccess = FSceneManager::LoadSceneData(FilePath, *Scene);
+		if (Result.bSuccess)
+		{
+			Result.Payload.Pack(*Scene);
+		}
+		Result.Seconds = FPlatformTime::Seconds() - StartTime;
+		return Result;
+	});
+}
+
+void FSceneLiveReload::FinishLoad(const FString& FilePath, FWatchedFile& File)
+{
+	FLoadResult Result = File.Future.Consume();
+	TStrongObjectPtr<USceneBufferAsset> Staging = MoveTemp(File.Staging);
+
+	// 训练器可能还在写文件，保留上一次的数据，文件写完时还会再触发一次变化
+	if (!Result.bSuccess)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Live reload failed to read %s, keeping the previous data."), *FilePath);
+		return;
+	}
+	File.LoadedTimestamp = File.PendingTimestamp;
+
+	if (!File.Asset)
+	{
+		File.Asset = MoveTemp(Staging);
+	}
+	else
+	{
+		USceneBufferAsset& Asset = *File.Asset;
+		Asset.SHDim = Staging->SHDim;
+		Asset.SHCoefficientsCount = Staging->SHCoefficientsCount;
+		Asset.bAttributesActivated = Staging->bAttributesActivated;
+		Asset.GaussianCount = Staging->GaussianCount;
+		Asset.GaussianPositions = MoveTemp(Staging->GaussianPositions);
+		Asset.GaussianScales = MoveTemp(Staging->GaussianScales);
+		Asset.GaussianRotations = MoveTemp(Staging->GaussianRotations);
+		Asset.GaussianOpacities = MoveTemp(Staging->GaussianOpacities);
+		Asset.GaussianSHCoefficients = MoveTemp(Staging->GaussianSHCoefficients);
+		Asset.Chunks = MoveTemp(Staging->Chunks);
+	}
+	File.Asset->UpdateRenderResource(MoveTemp(Result.Payload));
+
+	UE_LOG(LogTemp, Log, TEXT("Live reloaded %u Gaussians from %s (read and packed in %.2f ms)."),
+	       File.Asset->GaussianCount, *FilePath, Result.Seconds * 1000.0);
+}
+
+FSceneLiveReload::FWatchedFile& FSceneLiveReload::FindOrAddFile(const FString& FilePath)
+{
+	if (FWatchedFile* File = WatchedFiles.Find(FilePath))
+	{
+		return *File;
+	}
+
+	FWatchedFile& File = WatchedFiles.Add(FilePath);
+	File.Directory = FPaths::GetPath(FilePath);
+	GetDirectoryWatcher()->RegisterDirectoryChangedCallback_Handle(
+		File.Directory, IDirectoryWatcher::FDirectoryChanged::CreateRaw(this, &FSceneLiveReload::OnDirectoryChanged),
+		File.WatcherHandle);
+	return File;
+}
+
+void FSceneLiveReload::UnwatchFile(FWatchedFile& File)
+{
+	if (File.WatcherHandle.IsValid())
+	{
+		GetDirectoryWatcher()->UnregisterDirectoryChangedCallback_Handle(File.Directory, File.WatcherHandle);
+		File.WatcherHandle.Reset();
+	}
+}
+
+void FSceneLiveReload::OnDirectoryChanged(const TArray<FFileChangeData>& Changes)
+{
+	const double Now = FPlatformTime::Seconds();
+	for (const FFileChangeData& Change : Changes)
+	{
+		if (FWatchedFile* File = WatchedFiles.Find(NormalizeFilePath(Change.Filename)))
+		{
+			File->bChanged = true;
+			File->ChangeTime = Now;
+		}
+	}
+}
@@ -5,81 +5,374 @@
 
 #include "FileHelpers.h"
 #include "SceneActor.h"
+#include "SceneBufferAssetImportData.h"
 #include "tinyply.h"
 #include "AssetRegistry/AssetRegistryModule.h"
+#include "Async/ParallelFor.h"
 #include "Kismet2/BlueprintEditorUtils.h"
 #include "Kismet2/KismetEditorUtilities.h"
 #include "UObject/SavePackage.h"
 
-void FSceneManager::ImportScene(const FString& FilePath, TFunction<void(float)> OnProgress)
+ESceneImportResult FSceneManager::ImportScene(const FString& FilePath, TFunction<void(float)> OnProgress,
+                                              const bool bSkipUnchanged)
 {
-	// 读取 .ply 文件，创建 SceneBufferAsset 资产
+	if (!OnProgress)
+	{
+		OnProgress = [](float) {};
+	}
+
+	// 读取场景文件，创建或更新 SceneBufferAsset 资产
 	OnProgress(0.0f);
-	UE_LOG(LogTemp, Log, TEXT("Importing PLY file: %s"), *FilePath);
-	const FString SceneBufferAssetPath = ImportPlyFile(FilePath,
-	                                                   [&OnProgress](const float Progress)
-	                                                   {
-		                                                   // 进度映射到 0.0 - 0.8
-		                                                   OnProgress(Progress * 0.8f);
-	                                                   });
-
-	// 创建一个 Scene Actor 蓝图资产引用它
-	OnProgress(0.8f);
-	UE_LOG(LogTemp, Log, TEXT("Creating new Scene Actor to Content Browser"));
-	CreateActorInContentBrowser(SceneBufferAssetPath);
+	UE_LOG(LogTemp, Log, TEXT("Importing scene file: %s"), *FilePath);
+	ESceneImportResult Result = ESceneImportResult::Failed;
+	const FString SceneBufferAssetPath = ImportSceneFile(FilePath,
+	                                                     [&OnProgress](const float Progress)
+	                                                     {
+		                                                     // 进度映射到 0.0 - 0.8
+		                                                     OnProgress(Progress * 0.8f);
+	                                                     }, bSkipUnchanged, Result);
+
+	if (Result == ESceneImportResult::Created || Result == ESceneImportResult::Reimported)
+	{
+		// 创建一个 Scene Actor 蓝图资产引用它，已经存在的蓝图会被保留
+		OnProgress(0.8f);
+		UE_LOG(LogTemp, Log, TEXT("Creating new Scene Actor to Content Browser"));
+		CreateActorInContentBrowser(SceneBufferAssetPath);
+	}
 
 	OnProgress(1.0f);
 	UE_LOG(LogTemp, Log, TEXT("Import process completed."));
+	return Result;
 }
 
-FString FSceneManager::ImportPlyFile(const FString& FilePath, TFunction<void(float)> OnProgress)
+TArray<ESceneImportResult> FSceneManager::ReimportScenes(const TArray<FString>& FilePaths,
+                                                         TFunction<void(float)> OnProgress)
 {
-	// 创建一个新的包和 SceneBufferAsset 资产
+	if (!OnProgress)
+	{
+		OnProgress = [](float) {};
+	}
+
+	TArray<ESceneImportResult> Results;
+	Results.Reserve(FilePaths.Num());
+
+	int32 NumSkipped = 0;
+	int32 NumFailed = 0;
 	OnProgress(0.0f);
-	UE_LOG(LogTemp, Log, TEXT("Starting import of PLY file: %s"), *FilePath);
-	const FString Name = FPaths::GetBaseFilename(FilePath);
-	const FString PackageName = FString::Format(TEXT("/Game/GaussianSplattingX/{0}"), {Name});
-	const FString PackageFilename = FPackageName::LongPackageNameToFilename(
-		PackageName, FPackageName::GetAssetPackageExtension());
+	for (int32 i = 0; i < FilePaths.Num(); ++i)
+	{
+		const float ProgressStart = static_cast<float>(i) / FilePaths.Num();
+		const float ProgressScale = 1.0f / FilePaths.Num();
+		const ESceneImportResult Result = ImportScene(FilePaths[i],
+		                                              [&OnProgress, ProgressStart, ProgressScale](const float Progress)
+		                                              {
+			                                              OnProgress(ProgressStart + Progress * ProgressScale);
+		                                              }, true);
+		NumSkipped += Result == ESceneImportResult::Skipped;
+		NumFailed += Result == ESceneImportResult::Failed;
+		Results.Add(Result);
+	}
+	OnProgress(1.0f);
 
-	UPackage* Package = CreatePackage(*PackageName);
-	USceneBufferAsset* SceneBufferAsset = NewObject<USceneBufferAsset>(Package, USceneBufferAsset::StaticClass(), *Name,
-	                                                                   RF_Public | RF_Standalone);
+	UE_LOG(LogTemp, Log, TEXT("Reimported %d files: %d updated, %d skipped (unchanged), %d failed."),
+	       FilePaths.Num(), FilePaths.Num() - NumSkipped - NumFailed, NumSkipped, NumFailed);
+	return Results;
+}
+
+ESceneImportResult FSceneManager::ReimportAsset(USceneBufferAsset& SceneBufferAsset, TFunction<void(float)> OnProgress)
+{
+	if (!OnProgress)
+	{
+		OnProgress = [](float) {};
+	}
+
+	const FString FilePath = SceneBufferAsset.AssetImportData
+		                         ? SceneBufferAsset.AssetImportData->GetFirstFilename()
+		                         : FString();
+	if (FilePath.IsEmpty() || !FPaths::FileExists(FilePath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Cannot reimport %s: source file '%s' not found."),
+		       *SceneBufferAsset.GetPathName(), *FilePath);
+		return ESceneImportResult::Failed;
+	}
+
+	ESceneImportResult Result = ESceneImportResult::Failed;
+	ImportSceneFile(FilePath, MoveTemp(OnProgress), true, Result, &SceneBufferAsset);
+	return Result;
+}
+
+bool FSceneManager::LoadSceneData(const FString& FilePath, USceneBufferAsset& Scene)
+{
+	FScenePruneReport PruneReport;
+	return ReadSceneFile(FilePath, Scene, GetDefault<UGaussianSplattingXSettings>()->ImportPruneOptions, PruneReport,
+	                     [](float)
+	                     {
+	                     });
+}
+
+FString FSceneFileSummary::ToString() const
+{
+	return FString::Printf(TEXT("%lld Gaussians, SH degree %d%s\nFile size: %.2f MB\nGPU memory: %.2f MB"),
+	                       GaussianCount, SHDegree, bCompressed ? TEXT(" (compressed PLY)") : TEXT(""),
+	                       FileSize / (1024.0 * 1024.0), GPUBytes / (1024.0 * 1024.0));
+}
+
+bool FSceneManager::ScanSceneFile(const FString& FilePath, FSceneFileSummary& OutSummary)
+{
+	OutSummary = FSceneFileSummary();
+	OutSummary.FileSize = IFileManager::Get().FileSize(*FilePath);
+	if (OutSummary.FileSize < 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Scene file not found: %s"), *FilePath);
+		return false;
+	}
+
+	const FString Extension = FPaths::GetExtension(FilePath);
+	if (Extension.Equals(TEXT("spz"), ESearchCase::IgnoreCase))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Cannot scan .spz files without decompressing them: %s"), *FilePath);
+		return false;
+	}
+	if (Extension.Equals(TEXT("splat"), ESearchCase::IgnoreCase))
+	{
+		// 没有文件头，每个高斯固定 32 字节，只有 0 阶球谐系数
+		OutSummary.GaussianCount = OutSummary.FileSize / 32;
+	}
+	else
+	{
+		try
+		{
+			std::ifstream FileStream(std::string(TCHAR_TO_UTF8(*FilePath)), std::ios::binary);
+			tinyply::PlyFile File;
+			if (!File.parse_header(FileStream))
+			{
+				UE_LOG(LogTemp, Error, TEXT("Failed to parse PLY header: %s"), *FilePath);
+				return false;
+			}
+
+			// 和 ReadPlyFile 一样按 f_rest 属性的数量推算 SH 阶数，压缩 PLY 的 sh 元素按同样的方式计数
+			int64 NumRestSHCoefficients = 0;
+			for (const tinyply::PlyElement& Element : File.get_elements())
+			{
+				if (Element.name == "chunk")
+				{
+					OutSummary.bCompressed = true;
+				}
+				else if (Element.name == "vertex")
+				{
+					OutSummary.GaussianCount = Element.size;
+				}
+				if (Element.name == "vertex" || Element.name == "sh")
+				{
+					for (const tinyply::PlyProperty& Property : Element.properties)
+					{
+						NumRestSHCoefficients += FString(Property.name.c_str()).StartsWith(TEXT("f_rest"));
+					}
+				}
+			}
+			OutSummary.SHDegree = FMath::RoundToInt(FMath::Sqrt(NumRestSHCoefficients / 3 + 1.0)) - 1;
+		}
+		catch (const std::exception& e)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Failed to scan PLY file: %s"), *FString(e.what()));
+			return false;
+		}
+	}
+
+	OutSummary.GPUBytes = OutSummary.GaussianCount * USceneBufferAsset::GetGPUBytesPerGaussian(
+		FMath::Square(OutSummary.SHDegree + 1));
+	return true;
+}
+
+FString FSceneManager::GetScenePackageName(const FString& FilePath)
+{
+	return FString::Format(TEXT("/Game/GaussianSplattingX/{0}"), {FPaths::GetBaseFilename(FilePath)});
+}
+
+FString FSceneManager::ImportSceneFile(const FString& FilePath, TFunction<void(float)> OnProgress,
+                                     const bool bSkipUnchanged, ESceneImportResult& OutResult,
+                                     USceneBufferAsset* ExistingAsset)
+{
+	OnProgress(0.0f);
+	UE_LOG(LogTemp, Log, TEXT("Starting import of scene file: %s"), *FilePath);
+	const FString AbsoluteFilePath = FPaths::ConvertRelativePathToFull(FilePath);
 
-	// 读取 PLY 文件并填充数据
+	// 查找已经存在的资产，存在的话原地更新，引用它的 Scene Actor 蓝图就不需要重新创建
+	USceneBufferAsset* SceneBufferAsset = ExistingAsset;
+	if (!SceneBufferAsset)
+	{
+		const FString PackageName = GetScenePackageName(FilePath);
+		if (FPackageName::DoesPackageExist(PackageName))
+		{
+			const FString Name = FPaths::GetBaseFilename(FilePath);
+			SceneBufferAsset = LoadObject<USceneBufferAsset>(nullptr, *(PackageName + TEXT(".") + Name));
+		}
+	}
+
+	// 源文件没有变化，直接跳过
+	FMD5Hash SourceFileHash;
+	if (SceneBufferAsset && bSkipUnchanged && SceneBufferAsset->AssetImportData &&
+		SceneBufferAsset->AssetImportData->IsSourceFileUnchanged(AbsoluteFilePath, SourceFileHash))
+	{
+		UE_LOG(LogTemp, Log, TEXT("Source file unchanged, skipping import: %s"), *FilePath);
+		OutResult = ESceneImportResult::Skipped;
+		OnProgress(1.0f);
+		return SceneBufferAsset->GetPathName();
+	}
+
+	// 创建一个新的包和 SceneBufferAsset 资产，如果资产已经存在，先读到临时对象中，成功后再替换数据，避免读取失败时破坏已有资产
+	UPackage* Package = nullptr;
+	USceneBufferAsset* TargetAsset = nullptr;
+	if (SceneBufferAsset)
+	{
+		Package = SceneBufferAsset->GetPackage();
+		TargetAsset = NewObject<USceneBufferAsset>(GetTransientPackage());
+	}
+	else
+	{
+		const FString Name = FPaths::GetBaseFilename(FilePath);
+		Package = CreatePackage(*GetScenePackageName(FilePath));
+		SceneBufferAsset = NewObject<USceneBufferAsset>(Package, USceneBufferAsset::StaticClass(), *Name,
+		                                                RF_Public | RF_Standalone);
+		TargetAsset = SceneBufferAsset;
+	}
+	const bool bReimport = TargetAsset != SceneBufferAsset;
+	const FString PackageFilename = FPackageName::LongPackageNameToFilename(
+		Package->GetName(), FPackageName::GetAssetPackageExtension());
+
+	// 读取场景文件并填充数据
 	OnProgress(0.1f);
-	UE_LOG(LogTemp, Log, TEXT("Reading PLY file: %s"), *FilePath);
-	const bool Success = ReadPlyFile(FilePath, *SceneBufferAsset,
-	                                 [&OnProgress](const float Progress)
-	                                 {
-		                                 OnProgress(0.1f + Progress * 0.8f);
-	                                 });
+	UE_LOG(LogTemp, Log, TEXT("Reading scene file: %s"), *FilePath);
+	FScenePruneReport PruneReport;
+	const bool Success = ReadSceneFile(FilePath, *TargetAsset,
+	                                   GetDefault<UGaussianSplattingXSettings>()->ImportPruneOptions, PruneReport,
+	                                   [&OnProgress](const float Progress)
+	                                   {
+		                                   OnProgress(0.1f + Progress * 0.8f);
+	                                   });
 
 	if (!Success)
 	{
+		OutResult = ESceneImportResult::Failed;
 		OnProgress(1.0f);
 		return "";
 	}
+	PruneReport.Log();
+
+	if (bReimport)
+	{
+		SceneBufferAsset->Modify();
+		SceneBufferAsset->SHDim = TargetAsset->SHDim;
+		SceneBufferAsset->SHCoefficientsCount = TargetAsset->SHCoefficientsCount;
+		SceneBufferAsset->bAttributesActivated = TargetAsset->bAttributesActivated;
+		SceneBufferAsset->GaussianCount = TargetAsset->GaussianCount;
+		SceneBufferAsset->GaussianPositions = MoveTemp(TargetAsset->GaussianPositions);
+		SceneBufferAsset->GaussianScales = MoveTemp(TargetAsset->GaussianScales);
+		SceneBufferAsset->GaussianRotations = MoveTemp(TargetAsset->GaussianRotations);
+		SceneBufferAsset->GaussianOpacities = MoveTemp(TargetAsset->GaussianOpacities);
+		SceneBufferAsset->GaussianSHCoefficients = MoveTemp(TargetAsset->GaussianSHCoefficients);
+		SceneBufferAsset->Chunks = MoveTemp(TargetAsset->Chunks);
+		TargetAsset->MarkAsGarbage();
+	}
+
+	// 记录源文件信息，下次重新导入时用来判断文件是否发生变化
+	if (!SceneBufferAsset->AssetImportData)
+	{
+		SceneBufferAsset->AssetImportData = NewObject<USceneBufferAssetImportData>(
+			SceneBufferAsset, TEXT("AssetImportData"));
+	}
+	SceneBufferAsset->AssetImportData->UpdateSourceFile(AbsoluteFilePath, SourceFileHash);
 
 	// 保存资产到包中
 	OnProgress(0.9f);
 	UE_LOG(LogTemp, Log, TEXT("Saving asset to package: %s"), *PackageFilename);
 
-	FAssetRegistryModule::AssetCreated(SceneBufferAsset);
+	if (bReimport)
+	{
+		SceneBufferAsset->PostEditChange();
+	}
+	else
+	{
+		FAssetRegistryModule::AssetCreated(SceneBufferAsset);
+	}
 	[[maybe_unused]] bool Suppressed = Package->MarkPackageDirty();
 
 	FSavePackageArgs SaveArgs;
 	SaveArgs.TopLevelFlags = RF_Public | RF_Standalone;
 	UPackage::SavePackage(Package, SceneBufferAsset, *PackageFilename, SaveArgs);
 
-	UE_LOG(LogTemp, Log, TEXT("PLY import completed successfully."));
+	UE_LOG(LogTemp, Log, TEXT("Scene import completed successfully."));
+	OutResult = bReimport ? ESceneImportResult::Reimported : ESceneImportResult::Created;
 	OnProgress(1.0f);
 
 	// 返回 Buffer 的引用路径
-	return PackageName + TEXT(".") + Name;
+	return SceneBufferAsset->GetPathName();
 }
 
-bool FSceneManager::ReadPlyFile(const FString& FilePath, USceneBufferAsset& Scene, TFunction<void(float)> OnProgress)
+void FSceneManager::ParallelForGaussians(const int64 Count, const TFunctionRef<void(int64 Index)> Body)
+{
+	// 每个并行任务处理的高斯数量
+	constexpr int64 BatchSize = 4096;
+
+	const int32 NumBatches = static_cast<int32>((Count + BatchSize - 1) / BatchSize);
+	ParallelFor(NumBatches, [Count, &Body](const int32 BatchIndex)
+	{
+		const int64 Begin = BatchIndex * BatchSize;
+		const int64 End = FMath::Min(Begin + BatchSize, Count);
+		for (int64 i = Begin; i < End; ++i)
+		{
+			Body(i);
+		}
+	});
+}
+
+bool FSceneManager::ReadSceneFile(const FString& FilePath, USceneBufferAsset& Scene,
+                                  const FScenePruneOptions& PruneOptions, FScenePruneReport& OutPruneReport,
+                                  TFunction<void(float)> OnProgress)
+{
+	const FString Extension = FPaths::GetExtension(FilePath);
+	bool bSuccess = false;
+	if (!Extension.Equals(TEXT("splat"), ESearchCase::IgnoreCase) &&
+		!Extension.Equals(TEXT("spz"), ESearchCase::IgnoreCase))
+	{
+		bSuccess = ReadPlyFile(FilePath, Scene, PruneOptions, OutPruneReport, [&OnProgress](const float Progress)
+		{
+			OnProgress(Progress * 0.9f);
+		});
+	}
+	else
+	{
+		// 紧凑格式需要先解码才能知道每个高斯的属性，解码之后再剪枝
+		bSuccess = Extension.Equals(TEXT("splat"), ESearchCase::IgnoreCase)
+			           ? ReadSplatFile(FilePath, Scene, [&OnProgress](const float Progress)
+			           {
+				           OnProgress(Progress * 0.9f);
+			           })
+			           : ReadSpzFile(FilePath, Scene, [&OnProgress](const float Progress)
+			           {
+				           OnProgress(Progress * 0.9f);
+			           });
+		if (bSuccess)
+		{
+			PruneScene(Scene, PruneOptions, OutPruneReport);
+		}
+	}
+
+	if (bSuccess)
+	{
+		// 资产中保存激活后的值，渲染时不需要再逐帧计算 sigmoid / exp
+		Scene.ActivateAttributes();
+
+		// 按空间划分 Chunk，运行时以 Chunk 为单位流送
+		Scene.BuildChunks();
+	}
+	OnProgress(1.0f);
+	return bSuccess;
+}
+
+bool FSceneManager::ReadPlyFile(const FString& FilePath, USceneBufferAsset& Scene,
+                                const FScenePruneOptions& PruneOptions, FScenePruneReport& OutPruneReport,
+                                TFunction<void(float)> OnProgress)
 {
 	try
 	{
@@ -90,6 +383,20 @@ bool FSceneManager::ReadPlyFile(const FString& FilePath, USceneBufferAsset& Scen
 		tinyply::PlyFile File;
 		File.parse_header(FileStream);
 
+		// 压缩 PLY（SuperSplat / PlayCanvas 导出的格式）包含 chunk 元素，属性都是量化后的整数，需要单独解码
+		for (const tinyply::PlyElement& Element : File.get_elements())
+		{
+			if (Element.name == "chunk")
+			{
+				const bool bSuccess = ReadCompressedPlyFile(File, FileStream, Scene, OnProgress);
+				if (bSuccess)
+				{
+					PruneScene(Scene, PruneOptions, OutPruneReport);
+				}
+				return bSuccess;
+			}
+		}
+
 		uint32_t NumRestSHCoefficients = 0;
 		const tinyply::PlyElement VertexElement = File.get_elements()[0];
 		for (const auto& Prop : VertexElement.properties)
@@ -123,45 +430,55 @@ bool FSceneManager::ReadPlyFile(const FString& FilePath, USceneBufferAsset& Scen
 
 		// 读取所有的顶点
 		File.read(FileStream);
+		OnProgress(0.4f);
 
-		Scene.SetGaussianCount(Vertices->count);
-		for (size_t i = 0; i < Scene.GaussianCount; ++i)
+		const float* VertexBuffer = reinterpret_cast<const float*>(Vertices->buffer.get_const());
+		const size_t VertexStride = PropertyKeys.size();
+
+		// 在确定数组大小之前剪枝，只解码保留下来的高斯
+		TArray<uint32> KeptIndices;
+		OutPruneReport = SelectGaussians(
+			Vertices->count, PruneOptions, Scene.SHCoefficientsCount,
+			[VertexBuffer, VertexStride](const int64 i)
+			{
+				const float* VertexData = VertexBuffer + i * VertexStride;
+				return FVector(VertexData[0], VertexData[1], VertexData[2]);
+			},
+			[VertexBuffer, VertexStride](const int64 i)
+			{
+				return 1.0 / (1.0 + FMath::Exp(-VertexBuffer[i * VertexStride + 3]));
+			},
+			[VertexBuffer, VertexStride](const int64 i)
+			{
+				const float* VertexData = VertexBuffer + i * VertexStride;
+				return FVector(FMath::Exp(VertexData[4]), FMath::Exp(VertexData[5]), FMath::Exp(VertexData[6]));
+			},
+			KeptIndices);
+		OnProgress(0.6f);
+
+		Scene.SetGaussianCount(KeptIndices.Num());
+		const size_t NumRestPerChannel = Scene.SHCoefficientsCount - 1;
+		ParallelForGaussians(KeptIndices.Num(), [&](const int64 i)
 		{
-			const float* VertexData = reinterpret_cast<const float*>(Vertices->buffer.get_const()) + i * PropertyKeys.
-				size();
+			const float* VertexData = VertexBuffer + KeptIndices[i] * VertexStride;
 
 			Scene.GaussianPositions[i] = FVector{VertexData[0], VertexData[1], VertexData[2]};
 			Scene.GaussianOpacities[i] = VertexData[3];
 			Scene.GaussianScales[i] = FVector{VertexData[4], VertexData[5], VertexData[6]};
-			Scene.GaussianRotations[i] = FQuat{VertexData[7], VertexData[8], VertexData[9], VertexData[10]};
-			for (size_t j = 0; j < Scene.SHCoefficientsCount; ++j)
+			Scene.GaussianRotations[i] = MakePlyRotation(VertexData[7], VertexData[8], VertexData[9], VertexData[10]);
+
+			// f_dc_* 是 0 阶系数，f_rest_* 按颜色通道分组存储：先是所有 R 通道的系数，然后是 G、B
+			FVector* SH = &Scene.GaussianSHCoefficients[i * Scene.SHCoefficientsCount];
+			for (size_t k = 0; k < 3; ++k)
 			{
-				for (size_t k = 0; k < 3; ++k)
+				SH[0][k] = VertexData[11 + k];
+				for (size_t j = 1; j < Scene.SHCoefficientsCount; ++j)
 				{
-					Scene.GaussianSHCoefficients[i * Scene.SHCoefficientsCount + j][k] =
-						VertexData[11 + j * 3 + k];
+					SH[j][k] = VertexData[14 + k * NumRestPerChannel + (j - 1)];
 				}
 			}
-
-			OnProgress(static_cast<float>(i + 1) / static_cast<float>(Vertices->count));
-
-			UE_LOG(LogTemp, Verbose,
-			       TEXT(
-				       "Gaussian %llu: Pos(%.3f, %.3f, %.3f), Scale(%.3f, %.3f, %.3f), Rot(%.3f, %.3f, %.3f, %.3f), Alpha(%.3f), SH(%.3f, %.3f, %.3f, ..., %.3f, %.3f, %.3f)"
-			       ),
-			       i,
-			       Scene.GaussianPositions[i].X, Scene.GaussianPositions[i].Y, Scene.GaussianPositions[i].Z,
-			       Scene.GaussianScales[i].X, Scene.GaussianScales[i].Y, Scene.GaussianScales[i].Z,
-			       Scene.GaussianRotations[i].X, Scene.GaussianRotations[i].Y, Scene.GaussianRotations[i].Z,
-			       Scene.GaussianRotations[i].W,
-			       Scene.GaussianOpacities[i],
-			       Scene.GaussianSHCoefficients[i * Scene.SHCoefficientsCount + 0][0],
-			       Scene.GaussianSHCoefficients[i * Scene.SHCoefficientsCount + 0][1],
-			       Scene.GaussianSHCoefficients[i * Scene.SHCoefficientsCount + 0][2],
-			       Scene.GaussianSHCoefficients[i * Scene.SHCoefficientsCount + Scene.SHCoefficientsCount - 1][0],
-			       Scene.GaussianSHCoefficients[i * Scene.SHCoefficientsCount + Scene.SHCoefficientsCount - 1][1],
-			       Scene.GaussianSHCoefficients[i * Scene.SHCoefficientsCount + Scene.SHCoefficientsCount - 1][2]);
-		}
+		});
+		OnProgress(1.0f);
 
 		UE_LOG(LogTemp, Log, TEXT("Successfully read %d Gaussians from PLY file."), Scene.GaussianCount);
 	}
@@ -178,8 +495,13 @@ void FSceneManager::CreateActorInContentBrowser(const FString& SceneBufferAssetP
 {
 	const FString Name = FPaths::GetBaseFilename(SceneBufferAssetPath) + TEXT("_Actor");
 	const FString PackageName = FString::Format(TEXT("/Game/GaussianSplattingX/{0}"), {Name});
-	const FString PackageFilename = FPackageName::LongPackageNameToFilename(
-		PackageName, FPackageName::GetAssetPackageExtension());
+
+	// 蓝图已经存在时保留它，它引用的 SceneBufferAsset 路径没有变化，不需要重新编译和保存
+	if (FPackageName::DoesPackageExist(PackageName))
+	{
+		UE_LOG(LogTemp, Log, TEXT("Scene Actor blueprint already exists, keeping it: %s"), *PackageName);
+		return;
+	}
 
 	UPackage* Package = CreatePackage(*PackageName);
 
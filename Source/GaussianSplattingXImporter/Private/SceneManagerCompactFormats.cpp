@@ -0,0 +1,417 @@
+﻿//! 紧凑格式的读取：
+//! - .splat：https://github.com/antimatter15/splat
+//! - .spz：https://github.com/nianticlabs/spz
+//! - 压缩 PLY：https://github.com/playcanvas/supersplat
+
+#include "SceneManager.h"
+
+#include "tinyply.h"
+#include "Misc/Compression.h"
+#include "Misc/FileHelper.h"
+
+namespace
+{
+	/// 0 阶球谐函数的系数，颜色 = SH_C0 * f_dc + 0.5
+	constexpr double SH_C0 = 0.28209479177387814;
+
+	constexpr double InvSqrt2 = 0.70710678118654752;
+
+	/// sigmoid 的反函数，把 [0, 1] 的不透明度还原成训练器使用的 logit
+	double InverseSigmoid(const double Value)
+	{
+		const double Clamped = FMath::Clamp(Value, 1e-6, 1.0 - 1e-6);
+		return FMath::Loge(Clamped / (1.0 - Clamped));
+	}
+
+	/// 把 [0, 1] 的颜色还原成 0 阶球谐系数
+	double ColorToSHDC(const double Color)
+	{
+		return (Color - 0.5) / SH_C0;
+	}
+
+	uint32 ReadUInt32(const uint8* Data)
+	{
+		return Data[0] | (Data[1] << 8) | (Data[2] << 16) | (static_cast<uint32>(Data[3]) << 24);
+	}
+
+	float ReadFloat(const uint8* Data)
+	{
+		float Value;
+		FMemory::Memcpy(&Value, Data, sizeof(float));
+		return Value;
+	}
+
+	/// 将 Value 的低 Bits 位解码为 [0, 1] 的浮点数
+	double UnpackUnorm(const uint32 Value, const uint32 Bits)
+	{
+		const uint32 Mask = (1u << Bits) - 1;
+		return static_cast<double>(Value & Mask) / Mask;
+	}
+
+	/// 11-10-11 位打包的三维向量
+	FVector Unpack111011(const uint32 Value)
+	{
+		return FVector(UnpackUnorm(Value >> 21, 11), UnpackUnorm(Value >> 11, 10), UnpackUnorm(Value, 11));
+	}
+
+	/// 8-8-8-8 位打包的 RGBA
+	FVector4 Unpack8888(const uint32 Value)
+	{
+		return FVector4(UnpackUnorm(Value >> 24, 8), UnpackUnorm(Value >> 16, 8), UnpackUnorm(Value >> 8, 8),
+		                UnpackUnorm(Value, 8));
+	}
+
+	/// 读取 gzip 数据，gzip 的最后 4 个字节是未压缩数据的大小
+	bool UncompressGzip(const TArray64<uint8>& Compressed, TArray64<uint8>& OutData)
+	{
+		if (Compressed.Num() < 18)
+		{
+			return false;
+		}
+		const uint32 UncompressedSize = ReadUInt32(Compressed.GetData() + Compressed.Num() - 4);
+		OutData.SetNumUninitialized(UncompressedSize);
+		return FCompression::UncompressMemory(NAME_Gzip, OutData.GetData(), UncompressedSize, Compressed.GetData(),
+		                                      Compressed.Num());
+	}
+}
+
+FQuat FSceneManager::MakePlyRotation(const float Rot0, const float Rot1, const float Rot2, const float Rot3)
+{
+	// PLY 中 w 在前，FQuat 的构造函数是 x,y,z,w 的顺序；归一化在 ActivateAttributes 中统一完成
+	return FQuat{Rot1, Rot2, Rot3, Rot0};
+}
+
+// =============================== 压缩 PLY ===============================
+
+bool FSceneManager::ReadCompressedPlyFile(tinyply::PlyFile& File, std::istream& FileStream, USceneBufferAsset& Scene,
+                                          const TFunction<void(float)>& OnProgress)
+{
+	constexpr int64 ChunkSize = 256;
+
+	bool bHasChunkColor = false;
+	uint32 NumRestSHCoefficients = 0;
+	for (const tinyply::PlyElement& Element : File.get_elements())
+	{
+		for (const tinyply::PlyProperty& Prop : Element.properties)
+		{
+			if (Element.name == "chunk" && Prop.name == "min_r")
+			{
+				bHasChunkColor = true;
+			}
+			if (Element.name == "sh" && FString(Prop.name.c_str()).StartsWith("f_rest"))
+			{
+				++NumRestSHCoefficients;
+			}
+		}
+	}
+
+	Scene.SHCoefficientsCount = NumRestSHCoefficients / 3 + 1;
+	Scene.SHDim = round(sqrt(Scene.SHCoefficientsCount)) - 1;
+	UE_LOG(LogTemp, Log, TEXT("Compressed PLY: Detected SH Dimension: %d"), Scene.SHDim);
+
+	// chunk 中的属性都是 float，vertex 中都是 uint32，sh 中都是 uint8
+	std::vector<std::string> ChunkKeys = {
+		"min_x", "min_y", "min_z", "max_x", "max_y", "max_z",
+		"min_scale_x", "min_scale_y", "min_scale_z", "max_scale_x", "max_scale_y", "max_scale_z",
+	};
+	if (bHasChunkColor)
+	{
+		ChunkKeys.insert(ChunkKeys.end(), {"min_r", "min_g", "min_b", "max_r", "max_g", "max_b"});
+	}
+	const std::vector<std::string> VertexKeys = {"packed_position", "packed_rotation", "packed_scale", "packed_color"};
+	std::vector<std::string> SHKeys;
+	for (uint32 i = 0; i < NumRestSHCoefficients; ++i)
+	{
+		SHKeys.push_back("f_rest_" + std::to_string(i));
+	}
+
+	const std::shared_ptr<tinyply::PlyData> Chunks = File.request_properties_from_element("chunk", ChunkKeys);
+	const std::shared_ptr<tinyply::PlyData> Vertices = File.request_properties_from_element("vertex", VertexKeys);
+	const std::shared_ptr<tinyply::PlyData> SHData = NumRestSHCoefficients > 0
+		                                                 ? File.request_properties_from_element("sh", SHKeys)
+		                                                 : nullptr;
+	File.read(FileStream);
+	OnProgress(0.5f);
+
+	const int64 Count = Vertices->count;
+	if (static_cast<int64>(Chunks->count) * ChunkSize < Count)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Compressed PLY has %llu chunks, not enough for %lld Gaussians."),
+		       static_cast<uint64>(Chunks->count), Count);
+		return false;
+	}
+
+	const float* ChunkData = reinterpret_cast<const float*>(Chunks->buffer.get_const());
+	const uint32* VertexData = reinterpret_cast<const uint32*>(Vertices->buffer.get_const());
+	const uint8* SHBytes = SHData ? SHData->buffer.get_const() : nullptr;
+	const size_t ChunkStride = ChunkKeys.size();
+	const size_t NumRestPerChannel = Scene.SHCoefficientsCount - 1;
+
+	Scene.SetGaussianCount(Count);
+	ParallelForGaussians(Count, [&](const int64 i)
+	{
+		const float* Chunk = ChunkData + (i / ChunkSize) * ChunkStride;
+		const uint32* Vertex = VertexData + i * 4;
+
+		const FVector MinPosition(Chunk[0], Chunk[1], Chunk[2]);
+		const FVector MaxPosition(Chunk[3], Chunk[4], Chunk[5]);
+		const FVector MinScale(Chunk[6], Chunk[7], Chunk[8]);
+		const FVector MaxScale(Chunk[9], Chunk[10], Chunk[11]);
+
+		Scene.GaussianPositions[i] = MinPosition + (MaxPosition - MinPosition) * Unpack111011(Vertex[0]);
+		Scene.GaussianScales[i] = MinScale + (MaxScale - MinScale) * Unpack111011(Vertex[2]);
+
+		// 旋转用 2-10-10-10 的 smallest-three 编码，最高两位是绝对值最大的分量的下标
+		const double Norm = 1.0 / InvSqrt2;
+		const double A = (UnpackUnorm(Vertex[1] >> 20, 10) - 0.5) * Norm;
+		const double B = (UnpackUnorm(Vertex[1] >> 10, 10) - 0.5) * Norm;
+		const double C = (UnpackUnorm(Vertex[1], 10) - 0.5) * Norm;
+		const double M = FMath::Sqrt(FMath::Max(0.0, 1.0 - (A * A + B * B + C * C)));
+		switch (Vertex[1] >> 30)
+		{
+		case 0: Scene.GaussianRotations[i] = MakePlyRotation(M, A, B, C);
+			break;
+		case 1: Scene.GaussianRotations[i] = MakePlyRotation(A, M, B, C);
+			break;
+		case 2: Scene.GaussianRotations[i] = MakePlyRotation(A, B, M, C);
+			break;
+		default: Scene.GaussianRotations[i] = MakePlyRotation(A, B, C, M);
+			break;
+		}
+
+		FVector4 Color = Unpack8888(Vertex[3]);
+		if (bHasChunkColor)
+		{
+			for (int32 k = 0; k < 3; ++k)
+			{
+				Color[k] = FMath::Lerp(static_cast<double>(Chunk[12 + k]), static_cast<double>(Chunk[15 + k]),
+				                       Color[k]);
+			}
+		}
+		Scene.GaussianOpacities[i] = InverseSigmoid(Color.W);
+
+		FVector* SH = &Scene.GaussianSHCoefficients[i * Scene.SHCoefficientsCount];
+		SH[0] = FVector(ColorToSHDC(Color.X), ColorToSHDC(Color.Y), ColorToSHDC(Color.Z));
+		if (SHBytes)
+		{
+			// 与全精度 PLY 一样，f_rest_* 按颜色通道分组存储，每个字节量化到 [-4, 4]
+			const uint8* Rest = SHBytes + i * NumRestSHCoefficients;
+			for (size_t k = 0; k < 3; ++k)
+			{
+				for (size_t j = 1; j < Scene.SHCoefficientsCount; ++j)
+				{
+					const uint8 Value = Rest[k * NumRestPerChannel + (j - 1)];
+					const double Normalized = Value == 0 ? 0.0 : Value == 255 ? 1.0 : (Value + 0.5) / 256.0;
+					SH[j][k] = (Normalized - 0.5) * 8.0;
+				}
+			}
+		}
+	});
+
+	OnProgress(1.0f);
+	UE_LOG(LogTemp, Log, TEXT("Successfully read %d Gaussians from compressed PLY file."), Scene.GaussianCount);
+	return true;
+}
+
+// =============================== .splat ===============================
+
+bool FSceneManager::ReadSplatFile(const FString& FilePath, USceneBufferAsset& Scene, TFunction<void(float)> OnProgress)
+{
+	// 每个高斯 32 字节：位置 3 x float，缩放 3 x float，颜色 RGBA 4 x uint8，旋转 wxyz 4 x uint8
+	constexpr int64 SplatStride = 32;
+
+	TArray64<uint8> FileData;
+	if (!FFileHelper::LoadFileToArray(FileData, *FilePath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to read .splat file: %s"), *FilePath);
+		return false;
+	}
+	if (FileData.Num() % SplatStride != 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Invalid .splat file size %lld, expected a multiple of %lld: %s"),
+		       FileData.Num(), SplatStride, *FilePath);
+		return false;
+	}
+	OnProgress(0.3f);
+
+	// .splat 只保存了 0 阶球谐系数
+	Scene.SHCoefficientsCount = 1;
+	Scene.SHDim = 0;
+	Scene.SetGaussianCount(FileData.Num() / SplatStride);
+
+	const uint8* Data = FileData.GetData();
+	ParallelForGaussians(Scene.GaussianCount, [&Scene, Data](const int64 i)
+	{
+		const uint8* Splat = Data + i * SplatStride;
+		const uint8* Color = Splat + 24;
+		const uint8* Rotation = Splat + 28;
+
+		Scene.GaussianPositions[i] = FVector(ReadFloat(Splat + 0), ReadFloat(Splat + 4), ReadFloat(Splat + 8));
+
+		// .splat 中的缩放已经是线性的，转回 log 空间
+		Scene.GaussianScales[i] = FVector(FMath::Loge(FMath::Max(ReadFloat(Splat + 12), UE_SMALL_NUMBER)),
+		                                  FMath::Loge(FMath::Max(ReadFloat(Splat + 16), UE_SMALL_NUMBER)),
+		                                  FMath::Loge(FMath::Max(ReadFloat(Splat + 20), UE_SMALL_NUMBER)));
+
+		Scene.GaussianOpacities[i] = InverseSigmoid(Color[3] / 255.0);
+		Scene.GaussianSHCoefficients[i] = FVector(ColorToSHDC(Color[0] / 255.0), ColorToSHDC(Color[1] / 255.0),
+		                                          ColorToSHDC(Color[2] / 255.0));
+
+		Scene.GaussianRotations[i] = MakePlyRotation((Rotation[0] - 128) / 128.0f, (Rotation[1] - 128) / 128.0f,
+		                                             (Rotation[2] - 128) / 128.0f, (Rotation[3] - 128) / 128.0f);
+	});
+
+	OnProgress(1.0f);
+	UE_LOG(LogTemp, Log, TEXT("Successfully read %d Gaussians from .splat file."), Scene.GaussianCount);
+	return true;
+}
+
+// =============================== .spz ===============================
+
+bool FSceneManager::ReadSpzFile(const FString& FilePath, USceneBufferAsset& Scene, TFunction<void(float)> OnProgress)
+{
+	constexpr uint32 SpzMagic = 0x5053474e; // "NGSP"
+	constexpr int64 SpzHeaderSize = 16;
+	constexpr double SpzColorScale = 0.15;
+
+	TArray64<uint8> Compressed;
+	TArray64<uint8> FileData;
+	if (!FFileHelper::LoadFileToArray(Compressed, *FilePath) || !UncompressGzip(Compressed, FileData))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to read or decompress .spz file: %s"), *FilePath);
+		return false;
+	}
+	Compressed.Empty();
+	OnProgress(0.3f);
+
+	if (FileData.Num() < SpzHeaderSize || ReadUInt32(FileData.GetData()) != SpzMagic)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Invalid .spz header: %s"), *FilePath);
+		return false;
+	}
+
+	const uint32 Version = ReadUInt32(FileData.GetData() + 4);
+	const int64 Count = ReadUInt32(FileData.GetData() + 8);
+	const uint32 SHDegree = FileData[12];
+	const uint32 FractionalBits = FileData[13];
+	if (Version < 1 || Version > 3 || SHDegree > 3)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Unsupported .spz version %u or SH degree %u: %s"), Version, SHDegree, *FilePath);
+		return false;
+	}
+
+	// 每个属性连续存储：位置、不透明度、颜色、缩放、旋转、球谐系数
+	const int64 PositionStride = Version == 1 ? 6 : 9;
+	const int64 RotationStride = Version >= 3 ? 4 : 3;
+	const int64 NumRestPerChannel = (SHDegree + 1) * (SHDegree + 1) - 1;
+	const uint8* Positions = FileData.GetData() + SpzHeaderSize;
+	const uint8* Alphas = Positions + Count * PositionStride;
+	const uint8* Colors = Alphas + Count;
+	const uint8* Scales = Colors + Count * 3;
+	const uint8* Rotations = Scales + Count * 3;
+	const uint8* SHRest = Rotations + Count * RotationStride;
+	if (SHRest + Count * NumRestPerChannel * 3 > FileData.GetData() + FileData.Num())
+	{
+		UE_LOG(LogTemp, Error, TEXT(".spz file is truncated: %s"), *FilePath);
+		return false;
+	}
+
+	Scene.SHCoefficientsCount = NumRestPerChannel + 1;
+	Scene.SHDim = SHDegree;
+	Scene.SetGaussianCount(Count);
+
+	// .spz 内部使用 RUB 坐标系，PLY 使用 RDF，需要翻转 y 和 z；球谐系数按基函数的奇偶性翻转符号
+	static constexpr double FlipSH[15] = {
+		-1, -1, 1,
+		-1, 1, 1, -1, 1,
+		-1, 1, -1, -1, 1, -1, 1,
+	};
+
+	const double PositionScale = 1.0 / (1 << FractionalBits);
+	ParallelForGaussians(Count, [&, Version](const int64 i)
+	{
+		FVector Position;
+		if (Version == 1)
+		{
+			const uint16* Half = reinterpret_cast<const uint16*>(Positions + i * PositionStride);
+			for (int32 k = 0; k < 3; ++k)
+			{
+				FFloat16 Value;
+				Value.Encoded = Half[k];
+				Position[k] = Value.GetFloat();
+			}
+		}
+		else
+		{
+			// 24 位有符号定点数
+			const uint8* Fixed = Positions + i * PositionStride;
+			for (int32 k = 0; k < 3; ++k)
+			{
+				int32 Value = Fixed[k * 3 + 0] | (Fixed[k * 3 + 1] << 8) | (Fixed[k * 3 + 2] << 16);
+				Value |= (Value & 0x800000) ? 0xff000000 : 0;
+				Position[k] = Value * PositionScale;
+			}
+		}
+		Scene.GaussianPositions[i] = FVector(Position.X, -Position.Y, -Position.Z);
+
+		Scene.GaussianOpacities[i] = InverseSigmoid(Alphas[i] / 255.0);
+		Scene.GaussianScales[i] = FVector(Scales[i * 3 + 0] / 16.0 - 10.0, Scales[i * 3 + 1] / 16.0 - 10.0,
+		                                  Scales[i * 3 + 2] / 16.0 - 10.0);
+
+		FVector* SH = &Scene.GaussianSHCoefficients[i * Scene.SHCoefficientsCount];
+		for (int32 k = 0; k < 3; ++k)
+		{
+			SH[0][k] = (Colors[i * 3 + k] / 255.0 - 0.5) / SpzColorScale;
+		}
+		// .spz 的球谐系数按 [系数][RGB] 存储
+		for (int64 j = 0; j < NumRestPerChannel; ++j)
+		{
+			for (int32 k = 0; k < 3; ++k)
+			{
+				const uint8 Value = SHRest[(i * NumRestPerChannel + j) * 3 + k];
+				SH[j + 1][k] = (Value - 128.0) / 128.0 * FlipSH[j];
+			}
+		}
+
+		// 旋转按 xyzw 存储
+		double Rotation[4];
+		const uint8* Packed = Rotations + i * RotationStride;
+		if (Version >= 3)
+		{
+			// smallest-three：最高两位是最大分量的下标，其余三个分量各占 10 位（9 位数值 + 1 位符号）
+			constexpr uint32 ValueMask = (1u << 9) - 1;
+			uint32 Bits = ReadUInt32(Packed);
+			const uint32 LargestIndex = Bits >> 30;
+			double SumSquares = 0.0;
+			for (int32 k = 3; k >= 0; --k)
+			{
+				if (k == static_cast<int32>(LargestIndex))
+				{
+					continue;
+				}
+				const uint32 Magnitude = Bits & ValueMask;
+				const bool bNegative = (Bits >> 9) & 1;
+				Bits >>= 10;
+				Rotation[k] = InvSqrt2 * Magnitude / ValueMask * (bNegative ? -1.0 : 1.0);
+				SumSquares += Rotation[k] * Rotation[k];
+			}
+			Rotation[LargestIndex] = FMath::Sqrt(FMath::Max(0.0, 1.0 - SumSquares));
+		}
+		else
+		{
+			// 只存了 xyz，w 非负，由单位长度推出
+			for (int32 k = 0; k < 3; ++k)
+			{
+				Rotation[k] = Packed[k] / 127.5 - 1.0;
+			}
+			Rotation[3] = FMath::Sqrt(FMath::Max(0.0, 1.0 - (Rotation[0] * Rotation[0] + Rotation[1] * Rotation[1] +
+				Rotation[2] * Rotation[2])));
+		}
+		Scene.GaussianRotations[i] = MakePlyRotation(Rotation[3], Rotation[0], -Rotation[1], -Rotation[2]);
+	});
+
+	OnProgress(1.0f);
+	UE_LOG(LogTemp, Log, TEXT("Successfully read %d Gaussians from .spz file (version %u)."), Scene.GaussianCount,
+	       Version);
+	return true;
+}
@@ -0,0 +1,217 @@
+﻿#include "SceneManager.h"
+
+namespace
+{
+	/// 每个高斯被移除的原因
+	enum class EPruneReason : uint8
+	{
+		Kept,
+		Crop,
+		Opacity,
+		Scale,
+		Density,
+	};
+
+	/// 网格坐标的每个分量占 21 位，打包成一个 64 位的键
+	uint64 MakeCellKey(const FIntVector& Cell)
+	{
+		constexpr int32 Offset = 1 << 20;
+		constexpr uint64 Mask = (1ull << 21) - 1;
+		return (static_cast<uint64>(Cell.X + Offset) & Mask) |
+			((static_cast<uint64>(Cell.Y + Offset) & Mask) << 21) |
+			((static_cast<uint64>(Cell.Z + Offset) & Mask) << 42);
+	}
+
+	FIntVector GetCell(const FVector& Position, const double CellSize)
+	{
+		return FIntVector(FMath::FloorToInt(Position.X / CellSize), FMath::FloorToInt(Position.Y / CellSize),
+		                  FMath::FloorToInt(Position.Z / CellSize));
+	}
+}
+
+void FScenePruneReport::Log() const
+{
+	if (GetRemovedCount() == 0)
+	{
+		return;
+	}
+
+	UE_LOG(LogTemp, Display,
+	       TEXT(
+		       "Pruned %lld of %lld Gaussians (%.1f%%): %lld outside crop box, %lld low opacity, %lld small scale, %lld outliers. Saved %.2f MB."
+	       ),
+	       GetRemovedCount(), OriginalCount, OriginalCount > 0 ? 100.0 * GetRemovedCount() / OriginalCount : 0.0,
+	       RemovedByCrop, RemovedByOpacity, RemovedByScale, RemovedByDensity, BytesSaved / (1024.0 * 1024.0));
+}
+
+FScenePruneReport FSceneManager::SelectGaussians(const int64 Count, const FScenePruneOptions& Options,
+                                                 const int64 SHCoefficientsCount,
+                                                 const TFunctionRef<FVector(int64)> GetPosition,
+                                                 const TFunctionRef<double(int64)> GetOpacity,
+                                                 const TFunctionRef<FVector(int64)> GetScale,
+                                                 TArray<uint32>& OutKeptIndices)
+{
+	FScenePruneReport Report;
+	Report.OriginalCount = Count;
+
+	TArray<EPruneReason> Reasons;
+	Reasons.SetNumUninitialized(Count);
+
+	// 逐个高斯的过滤条件，每个高斯只记录第一个不满足的条件
+	ParallelForGaussians(Count, [&](const int64 i)
+	{
+		EPruneReason Reason = EPruneReason::Kept;
+		if (Options.bEnabled)
+		{
+			if (Options.bCropToBox && !Options.CropBox.IsInsideOrOn(GetPosition(i)))
+			{
+				Reason = EPruneReason::Crop;
+			}
+			else if (Options.MinOpacity > 0.0f && GetOpacity(i) < Options.MinOpacity)
+			{
+				Reason = EPruneReason::Opacity;
+			}
+			else if (Options.MinScale > 0.0f && GetScale(i).GetMax() < Options.MinScale)
+			{
+				Reason = EPruneReason::Scale;
+			}
+		}
+		Reasons[i] = Reason;
+	});
+
+	// 离群点：统计每个网格中的高斯数量（只统计通过了前面条件的高斯），周围 27 个网格中邻居太少的认为是离群点
+	if (Options.bEnabled && Options.bRemoveOutliers)
+	{
+		const double CellSize = FMath::Max(Options.OutlierRadius, UE_KINDA_SMALL_NUMBER);
+
+		TArray<uint64> CellKeys;
+		CellKeys.SetNumUninitialized(Count);
+		ParallelForGaussians(Count, [&](const int64 i)
+		{
+			CellKeys[i] = MakeCellKey(GetCell(GetPosition(i), CellSize));
+		});
+
+		TMap<uint64, int32> CellCounts;
+		for (int64 i = 0; i < Count; ++i)
+		{
+			if (Reasons[i] == EPruneReason::Kept)
+			{
+				++CellCounts.FindOrAdd(CellKeys[i]);
+			}
+		}
+
+		ParallelForGaussians(Count, [&](const int64 i)
+		{
+			if (Reasons[i] != EPruneReason::Kept)
+			{
+				return;
+			}
+
+			const FIntVector Cell = GetCell(GetPosition(i), CellSize);
+			int32 Neighbors = -1; // 不算自己
+			for (int32 z = -1; z <= 1; ++z)
+			{
+				for (int32 y = -1; y <= 1; ++y)
+				{
+					for (int32 x = -1; x <= 1; ++x)
+					{
+						if (const int32* CellCount = CellCounts.Find(MakeCellKey(Cell + FIntVector(x, y, z))))
+						{
+							Neighbors += *CellCount;
+						}
+					}
+				}
+			}
+			if (Neighbors < Options.OutlierMinNeighbors)
+			{
+				Reasons[i] = EPruneReason::Density;
+			}
+		});
+	}
+
+	OutKeptIndices.Reset(Count);
+	for (int64 i = 0; i < Count; ++i)
+	{
+		switch (Reasons[i])
+		{
+		case EPruneReason::Kept:
+			OutKeptIndices.Add(static_cast<uint32>(i));
+			break;
+		case EPruneReason::Crop:
+			++Report.RemovedByCrop;
+			break;
+		case EPruneReason::Opacity:
+			++Report.RemovedByOpacity;
+			break;
+		case EPruneReason::Scale:
+			++Report.RemovedByScale;
+			break;
+		case EPruneReason::Density:
+			++Report.RemovedByDensity;
+			break;
+		}
+	}
+
+	const int64 BytesPerGaussian = sizeof(FVector) * 2 + sizeof(FQuat) + sizeof(float) +
+		sizeof(FVector) * SHCoefficientsCount;
+	Report.BytesSaved = Report.GetRemovedCount() * BytesPerGaussian;
+	return Report;
+}
+
+void FSceneManager::PruneScene(USceneBufferAsset& Scene, const FScenePruneOptions& Options,
+                               FScenePruneReport& OutPruneReport)
+{
+	// 先激活，剪枝阈值直接和资产中的值比较
+	Scene.ActivateAttributes();
+
+	TArray<uint32> KeptIndices;
+	OutPruneReport = SelectGaussians(
+		Scene.GaussianCount, Options, Scene.SHCoefficientsCount,
+		[&Scene](const int64 i)
+		{
+			return Scene.GaussianPositions[i];
+		},
+		[&Scene](const int64 i)
+		{
+			return static_cast<double>(Scene.GaussianOpacities[i]);
+		},
+		[&Scene](const int64 i)
+		{
+			return Scene.GaussianScales[i];
+		},
+		KeptIndices);
+
+	if (OutPruneReport.GetRemovedCount() == 0)
+	{
+		return;
+	}
+
+	// 把保留下来的高斯并行收集到新的数组中
+	const int64 SHCount = Scene.SHCoefficientsCount;
+	TArray<FVector> Positions, Scales, SHCoefficients;
+	TArray<FQuat> Rotations;
+	TArray<float> Opacities;
+	Positions.SetNumUninitialized(KeptIndices.Num());
+	Scales.SetNumUninitialized(KeptIndices.Num());
+	Rotations.SetNumUninitialized(KeptIndices.Num());
+	Opacities.SetNumUninitialized(KeptIndices.Num());
+	SHCoefficients.SetNumUninitialized(KeptIndices.Num() * SHCount);
+
+	ParallelForGaussians(KeptIndices.Num(), [&](const int64 i)
+	{
+		const int64 Source = KeptIndices[i];
+		Positions[i] = Scene.GaussianPositions[Source];
+		Scales[i] = Scene.GaussianScales[Source];
+		Rotations[i] = Scene.GaussianRotations[Source];
+		Opacities[i] = Scene.GaussianOpacities[Source];
+		FMemory::Memcpy(&SHCoefficients[i * SHCount], &Scene.GaussianSHCoefficients[Source * SHCount],
+		                sizeof(FVector) * SHCount);
+	});
+
+	Scene.GaussianCount = KeptIndices.Num();
+	Scene.GaussianPositions = MoveTemp(Positions);
+	Scene.GaussianScales = MoveTemp(Scales);
+	Scene.GaussianRotations = MoveTemp(Rotations);
+	Scene.GaussianOpacities = MoveTemp(Opacities);
+	Scene.GaussianSHCoefficients = MoveTemp(SHCoefficients);
+}
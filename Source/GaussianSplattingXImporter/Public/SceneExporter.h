@@ -0,0 +1,48 @@
+﻿#pragma once
+
+#include "GaussianSplattingXRuntime/Public/SceneBufferAsset.h"
+
+/// 导出的文件格式
+enum class ESceneExportFormat : uint8
+{
+	/// 全精度二进制 PLY，与训练器输出的格式一致
+	Ply,
+	/// antimatter15 的 .splat 格式，每个高斯 32 字节，只保留 0 阶球谐系数
+	Splat,
+	/// Niantic 的 .spz 格式（版本 3），定点量化后 gzip 压缩
+	Spz,
+};
+
+/// 场景导出器，把 SceneBufferAsset 写回常见的 3DGS 文件格式，方便交给其他团队或 Web 查看器使用
+/// @note 编码在多个工作线程上并行执行；PLY 和 .splat 按块流式写入，编码下一块的同时写入上一块
+class GAUSSIANSPLATTINGXIMPORTER_API FSceneExporter
+{
+public:
+	/// 导出场景到指定文件
+	/// @param Scene 要导出的场景
+	/// @param FilePath 输出文件路径，已存在的文件会被覆盖
+	/// @param Format 输出格式
+	/// @param OnProgress 进度回调函数，参数为当前进度（0.0 到 1.0）
+	/// @return 如果导出成功则返回 true，否则返回 false
+	static bool ExportScene(const USceneBufferAsset& Scene, const FString& FilePath, ESceneExportFormat Format,
+	                        TFunction<void(float)> OnProgress = {});
+
+	/// 根据扩展名（.ply / .splat / .spz）推断导出格式，无法识别时返回 false
+	static bool GetFormatFromExtension(const FString& FilePath, ESceneExportFormat& OutFormat);
+
+private:
+	static bool ExportPly(const USceneBufferAsset& Scene, FArchive& Writer, const TFunction<void(float)>& OnProgress);
+	static bool ExportSplat(const USceneBufferAsset& Scene, FArchive& Writer, const TFunction<void(float)>& OnProgress);
+	static bool ExportSpz(const USceneBufferAsset& Scene, FArchive& Writer, const TFunction<void(float)>& OnProgress);
+
+	/// 按块流式写入：每块的高斯并行编码到缓冲区，然后在后台任务中写入文件，同时编码下一块
+	/// @param GaussianCount 高斯数量
+	/// @param BytesPerGaussian 每个高斯编码后的字节数
+	/// @param EncodeGaussian 把第 Index 个高斯编码到 Dest 中
+	static void WriteStreamed(FArchive& Writer, int64 GaussianCount, int64 BytesPerGaussian,
+	                          TFunctionRef<void(int64 Index, uint8* Dest)> EncodeGaussian,
+	                          const TFunction<void(float)>& OnProgress);
+
+	/// 按 PLY 中 rot_0..rot_3 的顺序取出旋转，与 FSceneManager 导入时的存储约定相反
+	static void GetPlyRotation(const FQuat& Rotation, float OutRotation[4]);
+};
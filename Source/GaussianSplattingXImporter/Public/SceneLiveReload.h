@@ -0,0 +1,75 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "SceneBufferRenderResource.h"
+#include "Engine/EngineBaseTypes.h"
+#include "UObject/StrongObjectPtr.h"
+
+struct FFileChangeData;
+class UWorld;
+
+/// 把开启了 Live Reload 的 ASceneActor 绑定到磁盘上的 PLY 文件，用于在关卡中查看训练过程中的检查点
+/// @note 文件变化后在工作线程上读取、激活、划分 Chunk 并打包，GT 上只交换数组和创建 RenderResource，不会卡住编辑器
+/// @note 数据放在临时资产中，不会修改或保存任何包
+/// @note 交换在每帧第一个 World 开始 Tick 时进行，Niagara System 在同一帧的 Tick 中切换到新数据
+class GAUSSIANSPLATTINGXIMPORTER_API FSceneLiveReload
+{
+public:
+	static void Startup();
+	static void Shutdown();
+
+	/// 文件最后一次变化之后等待的时间，训练器写文件时会连续触发多次变化
+	static constexpr double DebounceSeconds = 1.0;
+
+	/// 查找开启了 Live Reload 的 Actor 的间隔
+	static constexpr double ScanIntervalSeconds = 0.5;
+
+	~FSceneLiveReload();
+
+private:
+	struct FLoadResult
+	{
+		bool bSuccess = false;
+		FSceneGPUPayload Payload;
+		double Seconds = 0.0;
+	};
+
+	struct FWatchedFile
+	{
+		/// Actor 正在绘制的临时资产，第一次读取成功之前为空
+		TStrongObjectPtr<USceneBufferAsset> Asset;
+
+		/// 后台读取使用的临时资产，读取成功后把数据交换到 Asset 中
+		TStrongObjectPtr<USceneBufferAsset> Staging;
+		TFuture<FLoadResult> Future;
+
+		/// 已经读取的文件时间戳，和正在读取的文件时间戳
+		FDateTime LoadedTimestamp = FDateTime::MinValue();
+		FDateTime PendingTimestamp = FDateTime::MinValue();
+
+		bool bChanged = true;
+		double ChangeTime = 0.0;
+
+		FString Directory;
+		FDelegateHandle WatcherHandle;
+	};
+
+	void OnWorldTickStart(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+
+	/// 找到所有开启了 Live Reload 的 Actor，绑定到对应文件的资产，并停止监视不再使用的文件
+	void ScanActors();
+
+	void StartLoad(const FString& FilePath, FWatchedFile& File);
+	void FinishLoad(const FString& FilePath, FWatchedFile& File);
+
+	FWatchedFile& FindOrAddFile(const FString& FilePath);
+	void UnwatchFile(FWatchedFile& File);
+	void OnDirectoryChanged(const TArray<FFileChangeData>& Changes);
+
+	/// 以规范化的绝对路径为键
+	TMap<FString, FWatchedFile> WatchedFiles;
+
+	FDelegateHandle WorldTickStartHandle;
+	uint64 LastTickFrame = 0;
+	double NextScanTime = 0.0;
+};
@@ -1,12 +1,75 @@
 ﻿#pragma once
 
+#include "GaussianSplattingXRuntime/Public/GaussianSplattingXSettings.h"
 #include "GaussianSplattingXRuntime/Public/SceneBufferAsset.h"
 
+#include <istream>
+
+namespace tinyply
+{
+	class PlyFile;
+}
+
+/// 导入一个场景文件的结果
+enum class ESceneImportResult : uint8
+{
+	/// 新建了 SceneBufferAsset 资产和 Scene Actor 蓝图
+	Created,
+	/// 资产已存在且源文件发生了变化，原地重新导入，保留已有的 Scene Actor 蓝图
+	Reimported,
+	/// 资产已存在且源文件没有变化，跳过
+	Skipped,
+	/// 导入失败
+	Failed,
+};
+
+/// 导入时剪枝的统计结果
+struct GAUSSIANSPLATTINGXIMPORTER_API FScenePruneReport
+{
+	/// 源文件中的高斯数量
+	int64 OriginalCount = 0;
+	/// 不在裁剪包围盒内而被移除的数量
+	int64 RemovedByCrop = 0;
+	/// 不透明度过低而被移除的数量
+	int64 RemovedByOpacity = 0;
+	/// 缩放过小而被移除的数量
+	int64 RemovedByScale = 0;
+	/// 作为离群点被移除的数量
+	int64 RemovedByDensity = 0;
+	/// 移除的高斯在 SceneBufferAsset 中占用的字节数
+	int64 BytesSaved = 0;
+
+	int64 GetRemovedCount() const
+	{
+		return RemovedByCrop + RemovedByOpacity + RemovedByScale + RemovedByDensity;
+	}
+
+	void Log() const;
+};
+
+/// 只读取文件头得到的场景信息，用于在导入之前预览，数值和资产注册表中的标签一致
+struct GAUSSIANSPLATTINGXIMPORTER_API FSceneFileSummary
+{
+	/// 剪枝之前的高斯数量
+	int64 GaussianCount = 0;
+	int32 SHDegree = 0;
+	int64 FileSize = 0;
+	/// 导入后 GPU 数据占用的字节数，不考虑剪枝
+	int64 GPUBytes = 0;
+	/// 是否是分块量化的压缩 PLY
+	bool bCompressed = false;
+
+	FString ToString() const;
+};
+
 /// 场景管理器，负责导入场景数据并创建相应的资产和 Actor
 class GAUSSIANSPLATTINGXIMPORTER_API FSceneManager
 {
 public:
-	/// 从指定的文件路径导入 3DGS 场景数据，支持 PLY 格式
+	/// 从指定的文件路径导入 3DGS 场景数据，导入时会按插件设置中的 ImportPruneOptions 剪枝，支持以下格式：
+	///       - .ply：训练器输出的全精度 PLY，或 SuperSplat / PlayCanvas 导出的分块量化压缩 PLY
+	///       - .splat：antimatter15 格式，每个高斯 32 字节，只有 0 阶球谐系数
+	///       - .spz：Niantic 格式，gzip 压缩的定点量化数据
 	/// @note PLY 文件包含：
 	///       - 顶点位置（x, y, z）
 	///       - 顶点缩放（scale_0, scale_1, scale_2）
@@ -15,22 +78,110 @@ public:
 	///       - 球谐函数系数（f_dc_0, f_dc_1, f_dc_2, f_rest_0, f_rest_1, ...）
 	/// @param FilePath 要导入的文件路径
 	/// @param OnProgress 进度回调函数，参数为当前进度（0.0 到 1.0）
-	static void ImportScene(const FString& FilePath, TFunction<void(float)> OnProgress = {});
+	/// @param bSkipUnchanged 如果资产已经存在并且源文件没有变化，则跳过导入
+	/// @return 导入结果
+	static ESceneImportResult ImportScene(const FString& FilePath, TFunction<void(float)> OnProgress = {},
+	                                      bool bSkipUnchanged = false);
+
+	/// 批量重新导入，源文件没有变化的资产会被跳过，已经存在的资产会原地更新
+	/// @param FilePaths 要导入的文件路径列表
+	/// @param OnProgress 进度回调函数，参数为整体进度（0.0 到 1.0）
+	/// @return 每个文件的导入结果，顺序与 FilePaths 一致
+	static TArray<ESceneImportResult> ReimportScenes(const TArray<FString>& FilePaths,
+	                                                  TFunction<void(float)> OnProgress = {});
+
+	/// 使用资产中记录的源文件路径重新导入，源文件没有变化时跳过
+	static ESceneImportResult ReimportAsset(USceneBufferAsset& SceneBufferAsset, TFunction<void(float)> OnProgress = {});
+
+	/// 只把场景文件读到已有的 SceneBufferAsset 中，激活属性并划分 Chunk，不创建包也不保存
+	/// @note 不访问其他 UObject，可以在工作线程上调用，Scene 需要在 GT 上创建并保持引用
+	static bool LoadSceneData(const FString& FilePath, USceneBufferAsset& Scene);
+
+	/// 只读取文件头，不解码任何高斯，支持 .ply 和 .splat
+	/// @note .spz 的头部在 gzip 压缩的数据中，需要解压整个文件，所以不支持
+	static bool ScanSceneFile(const FString& FilePath, FSceneFileSummary& OutSummary);
 
 private:
-	/// 从 PLY 文件导入场景数据并创建 SceneBufferAsset 资产
-	/// @param FilePath 要导入的 PLY 文件路径
+	/// 从场景文件导入场景数据，创建或原地更新 SceneBufferAsset 资产
+	/// @param FilePath 要导入的场景文件路径
 	/// @param OnProgress 进度回调函数，参数为导入阶段的进度（0.0 到 1.0）
-	/// @return 创建的 SceneBufferAsset 资产的引用，如果导入失败则返回空字符串
-	static FString ImportPlyFile(const FString& FilePath, TFunction<void(float)> OnProgress = {});
+	/// @param bSkipUnchanged 如果资产已经存在并且源文件没有变化，则跳过导入
+	/// @param OutResult 导入结果
+	/// @param ExistingAsset 要原地更新的资产，为空时根据文件名查找 /Game/GaussianSplattingX/<Name>
+	/// @return SceneBufferAsset 资产的引用，如果导入失败则返回空字符串
+	static FString ImportSceneFile(const FString& FilePath, TFunction<void(float)> OnProgress, bool bSkipUnchanged,
+	                               ESceneImportResult& OutResult, USceneBufferAsset* ExistingAsset = nullptr);
+
+	/// 获取源文件对应的 SceneBufferAsset 包名，例如 /Game/GaussianSplattingX/<Name>
+	static FString GetScenePackageName(const FString& FilePath);
+
+	/// 根据扩展名选择对应的读取函数，将场景文件的数据填充到 SceneBufferAsset 中
+	/// @param FilePath 要读取的场景文件路径
+	/// @param Scene 要填充数据的 SceneBufferAsset 资产引用
+	/// @param PruneOptions 剪枝选项
+	/// @param OutPruneReport 剪枝的统计结果
+	/// @param OnProgress 进度回调函数，参数为读取阶段的进度（0.0 到 1.0）
+	/// @return 如果读取成功则返回 true，否则返回 false
+	static bool ReadSceneFile(const FString& FilePath, USceneBufferAsset& Scene, const FScenePruneOptions& PruneOptions,
+	                          FScenePruneReport& OutPruneReport, TFunction<void(float)> OnProgress);
 
-	/// 读取 PLY 文件并将数据填充到 SceneBufferAsset 中
+	/// 读取 PLY 文件并将数据填充到 SceneBufferAsset 中，包含 chunk 元素的压缩 PLY 会转交给 ReadCompressedPlyFile
+	/// @note 全精度 PLY 在确定数组大小之前剪枝，只解码保留下来的高斯
 	/// @param FilePath 要读取的 PLY 文件路径
 	/// @param Scene 要填充数据的 SceneBufferAsset 资产引用
+	/// @param PruneOptions 剪枝选项
+	/// @param OutPruneReport 剪枝的统计结果
 	/// @param OnProgress 进度回调函数，参数为读取阶段的进度（0.0 到 1.0）
 	/// @return 如果读取成功则返回 true，否则返回 false
-	static bool ReadPlyFile(const FString& FilePath, USceneBufferAsset& Scene, TFunction<void(float)> OnProgress);
+	static bool ReadPlyFile(const FString& FilePath, USceneBufferAsset& Scene, const FScenePruneOptions& PruneOptions,
+	                        FScenePruneReport& OutPruneReport, TFunction<void(float)> OnProgress);
+
+	// =============================== 剪枝 ===============================
+	// note: 实现在 SceneManagerPruning.cpp
+
+	/// 并行计算剪枝后需要保留的高斯
+	/// @param Count 高斯数量
+	/// @param Options 剪枝选项
+	/// @param SHCoefficientsCount 每个高斯的球谐系数数量，用来计算节省的内存
+	/// @param GetPosition 获取第 i 个高斯的位置
+	/// @param GetOpacity 获取第 i 个高斯激活后的不透明度
+	/// @param GetScale 获取第 i 个高斯激活后的缩放
+	/// @param OutKeptIndices 保留下来的高斯的下标，按升序排列
+	/// @return 剪枝的统计结果
+	static FScenePruneReport SelectGaussians(int64 Count, const FScenePruneOptions& Options, int64 SHCoefficientsCount,
+	                                         TFunctionRef<FVector(int64)> GetPosition,
+	                                         TFunctionRef<double(int64)> GetOpacity,
+	                                         TFunctionRef<FVector(int64)> GetScale,
+	                                         TArray<uint32>& OutKeptIndices);
+
+	/// 对已经解码的场景剪枝，原地压缩所有数组，用于无法在解码前剪枝的紧凑格式
+	/// 剪枝前会先激活场景的属性
+	static void PruneScene(USceneBufferAsset& Scene, const FScenePruneOptions& Options,
+	                       FScenePruneReport& OutPruneReport);
+
+	/// 按批次在多个工作线程上并行处理 [0, Count) 的高斯
+	static void ParallelForGaussians(int64 Count, TFunctionRef<void(int64 Index)> Body);
+
+	// =============================== 紧凑格式 ===============================
+	// note: 实现在 SceneManagerCompactFormats.cpp，解码都在多个工作线程上并行执行，结果和全精度 PLY 的约定一致：
+	//       缩放是 log 空间，不透明度是 sigmoid 之前的 logit，球谐系数按 [高斯][系数] 展开，RGB 存在 FVector 中
+
+	/// 解码分块量化的压缩 PLY，每 256 个高斯共享一个 chunk 的最小值/最大值
+	/// @param File 已经解析过头部的 PLY 文件
+	/// @param FileStream PLY 文件流，位置在头部之后
+	static bool ReadCompressedPlyFile(tinyply::PlyFile& File, std::istream& FileStream, USceneBufferAsset& Scene,
+	                                  const TFunction<void(float)>& OnProgress);
+
+	/// 读取 antimatter15 的 .splat 文件，每个高斯包含位置、线性缩放、RGBA 颜色和量化的旋转
+	static bool ReadSplatFile(const FString& FilePath, USceneBufferAsset& Scene, TFunction<void(float)> OnProgress);
+
+	/// 读取 Niantic 的 .spz 文件（版本 1 到 3），gzip 解压后按属性分块解码
+	static bool ReadSpzFile(const FString& FilePath, USceneBufferAsset& Scene, TFunction<void(float)> OnProgress);
+
+	/// 按 PLY 中 rot_0..rot_3 的顺序构造旋转，所有格式的读取都通过这里保证存储约定一致
+	static FQuat MakePlyRotation(float Rot0, float Rot1, float Rot2, float Rot3);
 
 	/// 创建一个新的 Scene Actor 蓝图，引用指定的 SceneBufferAsset 资产
+	/// @note 如果蓝图已经存在则保留它，不会重新编译和保存
 	static void CreateActorInContentBrowser(const FString& SceneBufferAssetPath);
 };
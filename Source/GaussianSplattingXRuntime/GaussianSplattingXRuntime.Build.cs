@@ -1,4 +1,5 @@
-﻿using UnrealBuildTool;
+﻿using System.IO;
+using UnrealBuildTool;
 
 public class GaussianSplattingXRuntime : ModuleRules
 {
@@ -14,22 +15,31 @@ public class GaussianSplattingXRuntime : ModuleRules
 				"VectorVM",
 				"RenderCore",
 				"Projects",
-				"RHI"
+				"RHI",
+				"DeveloperSettings",
+				"GaussianSplattingXShaders"
 			]
 		);
 
 		PrivateDependencyModuleNames.AddRange(
 			[
 				"CoreUObject",
-				"Engine"
+				"Engine",
+				"Renderer"
 			]
 		);
 
+		// Renderer 的私有头文件只有两处使用：
+		// 1. SceneTileRenderer.cpp 中视图扩展的 PrePostProcessPass 需要 FPostProcessingInputs 的定义
+		// 2. SceneTilePrevFrameHZB.cpp 读取上一帧的 HZB 做遮挡剔除，按引擎版本启用
+		PrivateIncludePaths.Add(Path.Combine(GetModuleDirectory("Renderer"), "Private"));
+
 		if (Target.bBuildEditor)
 		{
 			PrivateDependencyModuleNames.AddRange([
 				"UnrealEd",
-				"NiagaraEditor"
+				"NiagaraEditor",
+				"TargetPlatform"
 			]);
 		}
 	}
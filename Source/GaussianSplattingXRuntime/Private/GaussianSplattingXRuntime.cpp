@@ -1,7 +1,9 @@
 ﻿#include "GaussianSplattingXRuntime.h"
 
+#include "SceneFlythroughTest.h"
 #include "SceneNiagaraRendererProperties.h"
-#include "Interfaces/IPluginManager.h"
+#include "SceneStreamingManager.h"
+#include "SceneTileRenderer.h"
 
 #if WITH_EDITOR
 #include "NiagaraEditorModule.h"
@@ -11,10 +13,8 @@
 
 void FGaussianSplattingXRuntimeModule::StartupModule()
 {
-	// map the shader dir so we can use it in the data interface
-	const FString PluginShaderDir = FPaths::Combine(
-		IPluginManager::Get().FindPlugin(TEXT("GaussianSplattingX"))->GetBaseDir(), TEXT("Shaders"));
-	AddShaderSourceDirectoryMapping(TEXT("/Plugin/GaussianSplattingX"), PluginShaderDir);
+	// 按相机距离流送场景资产的 Chunk
+	FSceneStreamingManager::Startup();
 
 	// 初始化 Niagara 渲染器属性的 CDO 属性
 	USceneNiagaraRendererProperties::InitCDOPropertiesAfterModuleStartup();
@@ -36,6 +36,9 @@ void FGaussianSplattingXRuntimeModule::StartupModule()
 
 void FGaussianSplattingXRuntimeModule::ShutdownModule()
 {
+	FSceneFlythroughTest::Shutdown();
+	FSceneTileRenderer::Shutdown();
+	FSceneStreamingManager::Shutdown();
 }
 
 #undef LOCTEXT_NAMESPACE
@@ -0,0 +1,6 @@
+﻿#include "GaussianSplattingXSettings.h"
+
+FName UGaussianSplattingXSettings::GetCategoryName() const
+{
+	return TEXT("Plugins");
+}
@@ -1,5 +1,9 @@
 ﻿#include "SceneActor.h"
 #include "NiagaraSystem.h"
+#include "SceneAggregatorSubsystem.h"
+#include "SceneBufferAsset.h"
+#include "SceneBufferRenderResource.h"
+#include "SceneTileRenderer.h"
 
 ASceneActor::ASceneActor()
 {
@@ -7,19 +11,89 @@ ASceneActor::ASceneActor()
 
 	// 设置为根组件，这个 Actor 的位置、旋转、缩放 == NiagaraComp 的变换
 	RootComponent = NiagaraComp;
+
+	// 只有 TileCompute 后端需要每帧提交
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = true;
 }
 
 void ASceneActor::OnConstruction(const FTransform& Transform)
 {
-	if (NiagaraComp && SceneNiagaraParameter)
+	if (NiagaraComp && GetActiveNiagaraParameter())
 	{
-		// 加载 Niagara System 资源
-		NiagaraComp->SetAsset(
-			LoadObject<UNiagaraSystem>(
+		// 加载 Niagara System 资源，设置了静态粒子模式的 System 时使用它
+		UNiagaraSystem* System = StaticParticleSystem.LoadSynchronous();
+		if (!System)
+		{
+			System = LoadObject<UNiagaraSystem>(
 				nullptr, TEXT(
-					"/Script/Niagara.NiagaraSystem'/GaussianSplattingX/FX_GaussianSplattingX.FX_GaussianSplattingX'")));
-		NiagaraComp->SetVariableObject(TEXT("User.SceneNiagaraParameter"), SceneNiagaraParameter.Get());
+					"/Script/Niagara.NiagaraSystem'/GaussianSplattingX/FX_GaussianSplattingX.FX_GaussianSplattingX'"));
+		}
+		NiagaraComp->SetAsset(System);
+		NiagaraComp->SetVariableObject(TEXT("User.SceneNiagaraParameter"), GetActiveNiagaraParameter());
+	}
+
+	// 使用 TileCompute 后端时 Niagara System 不运行
+	if (NiagaraComp)
+	{
+		const bool bUseNiagara = RenderBackend == ESceneRenderBackend::Niagara;
+		NiagaraComp->SetAutoActivate(bUseNiagara);
+		if (!bUseNiagara)
+		{
+			NiagaraComp->DeactivateImmediate();
+		}
+		else if (!NiagaraComp->IsActive())
+		{
+			NiagaraComp->Activate();
+		}
+	}
+	TileSceneBufferAsset = nullptr;
+}
+
+void ASceneActor::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (USceneAggregatorSubsystem* Aggregator = GetWorld()->GetSubsystem<USceneAggregatorSubsystem>())
+	{
+		Aggregator->RegisterSceneActor(this);
+	}
+}
+
+void ASceneActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (USceneAggregatorSubsystem* Aggregator = GetWorld()->GetSubsystem<USceneAggregatorSubsystem>())
+	{
+		Aggregator->UnregisterSceneActor(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ASceneActor::Tick(const float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	const USceneNiagaraParameter* Parameter = GetActiveNiagaraParameter();
+	if (RenderBackend != ESceneRenderBackend::TileCompute || !Parameter || IsHidden())
+	{
+		return;
 	}
+
+	if (!TileSceneBufferAsset)
+	{
+		TileSceneBufferAsset = TSoftObjectPtr<USceneBufferAsset>(Parameter->SceneBufferAssetPath).LoadSynchronous();
+	}
+	if (!TileSceneBufferAsset)
+	{
+		return;
+	}
+
+	// 和 Niagara Data Interface 一样向流送管理器报告使用情况
+	const TSharedPtr<FSceneBufferRenderResource, ESPMode::ThreadSafe> Resource = TileSceneBufferAsset->
+		GetRenderResource();
+	Resource->ReportInstance_GameThread(GetActorTransform());
+	FSceneTileRenderer::AddInstance_GameThread(Resource, GetActorTransform());
 }
 
 #if WITH_EDITOR
@@ -31,6 +105,49 @@ void ASceneActor::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedE
 		       "PostEditChangeProperty - Updating Niagara Component with new SceneNiagaraParameter, SceneNiagaraParameter is nullptr: %d"
 	       ), SceneNiagaraParameter == nullptr);
 
-	NiagaraComp->SetVariableObject(TEXT("User.SceneNiagaraParameter"), SceneNiagaraParameter.Get());
+	NiagaraComp->SetVariableObject(TEXT("User.SceneNiagaraParameter"), GetActiveNiagaraParameter());
 }
 #endif
+
+void ASceneActor::SetLiveSceneBufferAsset(USceneBufferAsset* Asset)
+{
+	if (Asset)
+	{
+		if (!LiveNiagaraParameter)
+		{
+			LiveNiagaraParameter = NewObject<USceneNiagaraParameter>(this, NAME_None, RF_Transient);
+		}
+		LiveNiagaraParameter->SceneBufferAssetPath = FSoftObjectPath(Asset);
+	}
+	else
+	{
+		LiveNiagaraParameter = nullptr;
+	}
+
+	// Data Interface 只在初始化实例时读取资产路径，所以切换资产后需要重新初始化
+	if (NiagaraComp)
+	{
+		if (!NiagaraComp->GetAsset())
+		{
+			OnConstruction(GetActorTransform());
+		}
+		NiagaraComp->SetVariableObject(TEXT("User.SceneNiagaraParameter"), GetActiveNiagaraParameter());
+		if (NiagaraComp->IsActive())
+		{
+			NiagaraComp->ReinitializeSystem();
+		}
+	}
+	TileSceneBufferAsset = nullptr;
+}
+
+USceneBufferAsset* ASceneActor::GetLiveSceneBufferAsset() const
+{
+	return LiveNiagaraParameter
+		       ? Cast<USceneBufferAsset>(LiveNiagaraParameter->SceneBufferAssetPath.ResolveObject())
+		       : nullptr;
+}
+
+USceneNiagaraParameter* ASceneActor::GetActiveNiagaraParameter() const
+{
+	return LiveNiagaraParameter ? LiveNiagaraParameter.Get() : SceneNiagaraParameter.Get();
+}
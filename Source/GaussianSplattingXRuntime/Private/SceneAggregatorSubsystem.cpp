@@ -0,0 +1,619 @@
+﻿#include "SceneAggregatorSubsystem.h"
+
+#include "GaussianSplattingXSettings.h"
+#include "GaussianSplattingXStats.h"
+#include "NiagaraComponent.h"
+#include "SceneActor.h"
+#include "SceneBufferAsset.h"
+#include "SceneBufferRenderResource.h"
+#include "SceneNiagaraParameter.h"
+#include "SceneStreamingManager.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+#include "Misc/ScopeRWLock.h"
+
+DECLARE_CYCLE_STAT(TEXT("Aggregator Tick"), STAT_GaussianSplattingX_AggregatorTick, STATGROUP_GaussianSplattingX);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Aggregate Draws"), STAT_GaussianSplattingX_AggregateDraws,
+                           STATGROUP_GaussianSplattingX);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Aggregated Actors"), STAT_GaussianSplattingX_AggregatedActors,
+                           STATGROUP_GaussianSplattingX);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Aggregated Resident Gaussians"), STAT_GaussianSplattingX_AggregatedResidentGaussians,
+                           STATGROUP_GaussianSplattingX);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pending Aggregates"), STAT_GaussianSplattingX_PendingAggregates,
+                           STATGROUP_GaussianSplattingX);
+
+namespace
+{
+	/// 连续这么多帧没有移动的 Actor 才会被合并，避免移动中的 Actor 每帧都重新合并
+	constexpr uint64 SettleFrames = 30;
+
+	/// 离开所有视图超过这么多帧的 Actor 退出合并
+	constexpr uint64 HiddenFrames = 60;
+
+#if STATS
+	/// 每个成员一个动态的计数器，按 Actor 的名字显示在 stat GaussianSplattingX 中，只在 GT 访问
+	/// @note 退出合并的 Actor 保持最后的值，直到 stat 重置
+	FName GetMemberStatName(const ASceneActor* SceneActor)
+	{
+		static TMap<FName, FName> MemberStatNames;
+		if (const FName* StatName = MemberStatNames.Find(SceneActor->GetFName()))
+		{
+			return *StatName;
+		}
+		const TStatId StatId = FDynamicStats::CreateStatIdInt64<FStatGroup_STATGROUP_GaussianSplattingX>(
+			FString::Printf(TEXT("Aggregated Resident Gaussians: %s"), *SceneActor->GetActorNameOrLabel()));
+		return MemberStatNames.Add(SceneActor->GetFName(), StatId.GetName());
+	}
+#endif
+
+	/// Actor 使用的资产，还没有被 Niagara Data Interface 加载时返回空
+	USceneBufferAsset* GetSceneBufferAsset(const ASceneActor* SceneActor)
+	{
+		if (!SceneActor->SceneNiagaraParameter)
+		{
+			return nullptr;
+		}
+		return Cast<USceneBufferAsset>(SceneActor->SceneNiagaraParameter->SceneBufferAssetPath.ResolveObject());
+	}
+
+	/// Actor 空间下所有 Chunk 的包围盒
+	FBox GetLocalBounds(const USceneBufferAsset& Asset)
+	{
+		FBox Bounds(ForceInit);
+		for (const FSceneChunk& Chunk : Asset.Chunks)
+		{
+			Bounds += Chunk.Bounds;
+		}
+		return Bounds;
+	}
+
+	bool IsAggregationCandidate(const ASceneActor* SceneActor)
+	{
+		if (!IsValid(SceneActor) || !SceneActor->bAllowAggregation || !SceneActor->NiagaraComp ||
+			SceneActor->RenderBackend != ESceneRenderBackend::Niagara)
+		{
+			return false;
+		}
+		const USceneBufferAsset* Asset = GetSceneBufferAsset(SceneActor);
+		return Asset && !Asset->Chunks.IsEmpty();
+	}
+
+	/// 还没有渲染过任何视图时认为都可见
+	bool IsInAnyView(const TArray<FSceneStreamingView>& Views, const FBox& Bounds)
+	{
+		return Views.IsEmpty() || Views.ContainsByPredicate([&Bounds](const FSceneStreamingView& View)
+		{
+			return View.Frustum.IntersectBox(Bounds.GetCenter(), Bounds.GetExtent());
+		});
+	}
+
+	/// 成员的数量、顺序、变换和 RenderResource 都和这一组相同
+	template <typename TAggregate>
+	bool MatchesGroup(const TAggregate& Aggregate, const TArray<ASceneActor*>& Group)
+	{
+		if (Aggregate.Members.Num() != Group.Num())
+		{
+			return false;
+		}
+		for (int32 Member = 0; Member < Group.Num(); ++Member)
+		{
+			if (Aggregate.Members[Member].Get() != Group[Member] ||
+				!Aggregate.MemberTransforms[Member].Equals(Group[Member]->GetActorTransform()) ||
+				Aggregate.MemberResources[Member].Pin() != GetSceneBufferAsset(Group[Member])->GetRenderResource())
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/// 所有成员都没有变化并且仍在这一组中，这一组的新合并结果完成之前可以继续绘制
+	bool IsStillValidIn(const FSceneAggregate& Aggregate, const TArray<ASceneActor*>& Group)
+	{
+		for (int32 Member = 0; Member < Aggregate.Members.Num(); ++Member)
+		{
+			ASceneActor* SceneActor = Aggregate.Members[Member].Get();
+			if (!Group.Contains(SceneActor) ||
+				!Aggregate.MemberTransforms[Member].Equals(SceneActor->GetActorTransform()) ||
+				Aggregate.MemberResources[Member].Pin() != GetSceneBufferAsset(SceneActor)->GetRenderResource())
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	int32 FindRoot(TArray<int32>& Parents, int32 Index)
+	{
+		while (Parents[Index] != Index)
+		{
+			Parents[Index] = Parents[Parents[Index]];
+			Index = Parents[Index];
+		}
+		return Index;
+	}
+
+	void DumpAggregates(const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (const USceneAggregatorSubsystem* Aggregator = World ? World->GetSubsystem<USceneAggregatorSubsystem>() : nullptr)
+		{
+			Aggregator->DumpAggregates(Ar);
+		}
+		else
+		{
+			Ar.Logf(TEXT("Scene aggregation is not running in this world."));
+		}
+	}
+
+	FAutoConsoleCommandWithWorldArgsAndOutputDevice DumpAggregatesCommand(
+		TEXT("GaussianSplattingX.DumpAggregates"),
+		TEXT("List every aggregated group of overlapping scene actors with each actor's total and resident Gaussians."),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateStatic(&DumpAggregates));
+}
+
+void USceneAggregatorSubsystem::RegisterSceneActor(ASceneActor* SceneActor)
+{
+	FTrackedActor& TrackedActor = SceneActors.AddDefaulted_GetRef();
+	TrackedActor.SceneActor = SceneActor;
+	TrackedActor.LastTransform = SceneActor->GetActorTransform();
+	TrackedActor.LastMovedFrame = GFrameCounter;
+}
+
+void USceneAggregatorSubsystem::UnregisterSceneActor(ASceneActor* SceneActor)
+{
+	SceneActors.RemoveAll([SceneActor](const FTrackedActor& TrackedActor)
+	{
+		return TrackedActor.SceneActor.Get() == SceneActor;
+	});
+}
+
+void USceneAggregatorSubsystem::DumpAggregates(FOutputDevice& Ar) const
+{
+	Ar.Logf(TEXT("%d scene aggregate(s)"), Aggregates.Num());
+	for (int32 AggregateIndex = 0; AggregateIndex < Aggregates.Num(); ++AggregateIndex)
+	{
+		const FSceneAggregate& Aggregate = Aggregates[AggregateIndex];
+		const int32 TotalGaussians = Aggregate.Asset ? Aggregate.Asset->GaussianCount : 0;
+		Ar.Logf(TEXT("  Aggregate %d: %d actors, %d Gaussians, %d chunks"), AggregateIndex, Aggregate.Members.Num(),
+		        TotalGaussians, Aggregate.Asset ? Aggregate.Asset->Chunks.Num() : 0);
+		for (int32 Member = 0; Member < Aggregate.Members.Num(); ++Member)
+		{
+			const ASceneActor* SceneActor = Aggregate.Members[Member].Get();
+			Ar.Logf(TEXT("    %s: %d Gaussians (%.1f%%), %d resident"),
+			        SceneActor ? *SceneActor->GetActorNameOrLabel() : TEXT("<destroyed>"),
+			        Aggregate.MemberGaussians[Member],
+			        100.0 * Aggregate.MemberGaussians[Member] / FMath::Max(TotalGaussians, 1),
+			        Aggregate.MemberResidentGaussians[Member]);
+		}
+	}
+}
+
+void USceneAggregatorSubsystem::Deinitialize()
+{
+	// 工作线程还在写 Staging，等它结束之后才能释放
+	for (FPendingAggregate& Pending : PendingAggregates)
+	{
+		Pending.Future.Wait();
+	}
+	PendingAggregates.Reset();
+
+	// 成员资产可能还在其他 World 中使用，例如 PIE 结束后的编辑器 World
+	UpdateSuspendedResources({});
+
+	// 世界正在销毁，成员和临时 Actor 都会一起被销毁，不需要恢复
+	Aggregates.Reset();
+	SceneActors.Reset();
+
+	Super::Deinitialize();
+}
+
+void USceneAggregatorSubsystem::Tick(const float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_GaussianSplattingX_AggregatorTick);
+
+	SceneActors.RemoveAll([](const FTrackedActor& TrackedActor)
+	{
+		return !TrackedActor.SceneActor.IsValid();
+	});
+
+	// 视图外的 Actor 不合并，离开视图一段时间之后才退出，避免相机转动时反复重新合并
+	const TArray<FSceneStreamingView>& Views = FSceneStreamingManager::Get().GetViews();
+	for (FTrackedActor& TrackedActor : SceneActors)
+	{
+		const ASceneActor* SceneActor = TrackedActor.SceneActor.Get();
+		const FTransform& Transform = SceneActor->GetActorTransform();
+		if (!TrackedActor.LastTransform.Equals(Transform))
+		{
+			TrackedActor.LastTransform = Transform;
+			TrackedActor.LastMovedFrame = GFrameCounter;
+		}
+
+		TrackedActor.WorldBounds.Init();
+		if (IsAggregationCandidate(SceneActor))
+		{
+			TrackedActor.WorldBounds = GetLocalBounds(*GetSceneBufferAsset(SceneActor)).TransformBy(Transform);
+			if (IsInAnyView(Views, TrackedActor.WorldBounds))
+			{
+				TrackedActor.LastVisibleFrame = GFrameCounter;
+			}
+		}
+	}
+
+	TArray<TArray<ASceneActor*>> Groups;
+	if (GetDefault<UGaussianSplattingXSettings>()->bEnableAggregation)
+	{
+		Groups = FindOverlappingGroups();
+	}
+
+	// 后台合并完成后加入，合并期间成员发生变化的结果直接丢弃
+	for (int32 i = PendingAggregates.Num() - 1; i >= 0; --i)
+	{
+		FPendingAggregate& Pending = PendingAggregates[i];
+		if (!Pending.Future.IsReady())
+		{
+			continue;
+		}
+		if (Groups.ContainsByPredicate([&Pending](const TArray<ASceneActor*>& Group)
+		{
+			return MatchesGroup(Pending, Group);
+		}))
+		{
+			Aggregates.Add(FinishAggregate(Pending));
+		}
+		PendingAggregates.RemoveAtSwap(i);
+	}
+
+	// 成员和变换都没有变化的组保留之前的合并结果，其他组在后台重新合并，完成之前旧的合并结果继续绘制
+	TArray<FSceneAggregate> NewAggregates;
+	for (const TArray<ASceneActor*>& Group : Groups)
+	{
+		const int32 Existing = Aggregates.IndexOfByPredicate([&Group](const FSceneAggregate& Aggregate)
+		{
+			return MatchesGroup(Aggregate, Group);
+		});
+		if (Existing != INDEX_NONE)
+		{
+			NewAggregates.Add(MoveTemp(Aggregates[Existing]));
+			Aggregates.RemoveAtSwap(Existing);
+			continue;
+		}
+
+		if (!PendingAggregates.ContainsByPredicate([&Group](const FPendingAggregate& Pending)
+		{
+			return MatchesGroup(Pending, Group);
+		}))
+		{
+			StartAggregate(Group);
+		}
+		for (int32 i = Aggregates.Num() - 1; i >= 0; --i)
+		{
+			if (IsStillValidIn(Aggregates[i], Group))
+			{
+				NewAggregates.Add(MoveTemp(Aggregates[i]));
+				Aggregates.RemoveAtSwap(i);
+			}
+		}
+	}
+
+	TSet<const ASceneActor*> AggregatedActors;
+	for (const FSceneAggregate& Aggregate : NewAggregates)
+	{
+		for (const TWeakObjectPtr<ASceneActor>& Member : Aggregate.Members)
+		{
+			AggregatedActors.Add(Member.Get());
+		}
+	}
+	for (FSceneAggregate& Aggregate : Aggregates)
+	{
+		DissolveAggregate(Aggregate, AggregatedActors);
+	}
+	Aggregates = MoveTemp(NewAggregates);
+	UpdateSuspendedResources(AggregatedActors);
+
+	int32 ResidentGaussians = 0;
+	for (FSceneAggregate& Aggregate : Aggregates)
+	{
+		// 成员的 Niagara System 可能被重新激活，例如组件重新注册之后
+		for (const TWeakObjectPtr<ASceneActor>& Member : Aggregate.Members)
+		{
+			if (Member.IsValid() && Member->NiagaraComp->IsActive())
+			{
+				Member->NiagaraComp->DeactivateImmediate();
+			}
+		}
+
+		UpdateContribution(Aggregate);
+		for (int32 Member = 0; Member < Aggregate.Members.Num(); ++Member)
+		{
+			ResidentGaussians += Aggregate.MemberResidentGaussians[Member];
+#if STATS
+			if (const ASceneActor* SceneActor = Aggregate.Members[Member].Get())
+			{
+				SET_DWORD_STAT_FName(GetMemberStatName(SceneActor), Aggregate.MemberResidentGaussians[Member]);
+			}
+#endif
+		}
+	}
+
+	SET_DWORD_STAT(STAT_GaussianSplattingX_AggregateDraws, Aggregates.Num());
+	SET_DWORD_STAT(STAT_GaussianSplattingX_AggregatedActors, AggregatedActors.Num());
+	SET_DWORD_STAT(STAT_GaussianSplattingX_AggregatedResidentGaussians, ResidentGaussians);
+	SET_DWORD_STAT(STAT_GaussianSplattingX_PendingAggregates, PendingAggregates.Num());
+}
+
+TStatId USceneAggregatorSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USceneAggregatorSubsystem, STATGROUP_GaussianSplattingX);
+}
+
+bool USceneAggregatorSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TArray<TArray<ASceneActor*>> USceneAggregatorSubsystem::FindOverlappingGroups() const
+{
+	TArray<ASceneActor*> Candidates;
+	TArray<FBox> Bounds;
+	for (const FTrackedActor& TrackedActor : SceneActors)
+	{
+		if (TrackedActor.WorldBounds.IsValid && GFrameCounter - TrackedActor.LastMovedFrame >= SettleFrames &&
+			GFrameCounter - TrackedActor.LastVisibleFrame <= HiddenFrames)
+		{
+			Candidates.Add(TrackedActor.SceneActor.Get());
+			Bounds.Add(TrackedActor.WorldBounds);
+		}
+	}
+
+	// 用并查集合并所有包围盒相交的 Actor，场景中的 Actor 数量很少，直接两两比较
+	TArray<int32> Parents;
+	Parents.SetNumUninitialized(Candidates.Num());
+	for (int32 i = 0; i < Candidates.Num(); ++i)
+	{
+		Parents[i] = i;
+	}
+	for (int32 i = 0; i < Candidates.Num(); ++i)
+	{
+		for (int32 j = i + 1; j < Candidates.Num(); ++j)
+		{
+			if (Bounds[i].Intersect(Bounds[j]))
+			{
+				Parents[FindRoot(Parents, i)] = FindRoot(Parents, j);
+			}
+		}
+	}
+
+	TMap<int32, TArray<ASceneActor*>> GroupsByRoot;
+	for (int32 i = 0; i < Candidates.Num(); ++i)
+	{
+		GroupsByRoot.FindOrAdd(FindRoot(Parents, i)).Add(Candidates[i]);
+	}
+
+	TArray<TArray<ASceneActor*>> Groups;
+	for (TPair<int32, TArray<ASceneActor*>>& Group : GroupsByRoot)
+	{
+		if (Group.Value.Num() >= 2)
+		{
+			Groups.Add(MoveTemp(Group.Value));
+		}
+	}
+	return Groups;
+}
+
+void USceneAggregatorSubsystem::StartAggregate(const TArray<ASceneActor*>& Members)
+{
+	FPendingAggregate& Pending = PendingAggregates.AddDefaulted_GetRef();
+	TArray<TSharedPtr<FSceneBufferRenderResource, ESPMode::ThreadSafe>> Resources;
+	for (ASceneActor* SceneActor : Members)
+	{
+		Pending.Members.Add(SceneActor);
+		Pending.MemberTransforms.Add(SceneActor->GetActorTransform());
+		Pending.MemberResources.Add(Resources.Add_GetRef(GetSceneBufferAsset(SceneActor)->GetRenderResource()));
+	}
+
+	Pending.Staging.Reset(NewObject<USceneBufferAsset>(GetTransientPackage(),
+	                                                   MakeUniqueObjectName(GetTransientPackage(),
+	                                                                        USceneBufferAsset::StaticClass(),
+	                                                                        TEXT("SceneAggregate")), RF_Transient));
+	Pending.Future = Async(EAsyncExecution::ThreadPool,
+	                       [Resources = MoveTemp(Resources), Transforms = Pending.MemberTransforms,
+		                       Asset = Pending.Staging.Get()]()
+	                       {
+		                       return BuildAggregate(Resources, Transforms, *Asset);
+	                       });
+}
+
+USceneAggregatorSubsystem::FBuildResult USceneAggregatorSubsystem::BuildAggregate(
+	const TArray<TSharedPtr<FSceneBufferRenderResource, ESPMode::ThreadSafe>>& Resources,
+	const TArray<FTransform>& Transforms, USceneBufferAsset& Asset)
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	// SH 阶数不同的成员按最高阶合并，缺少的系数为 0
+	TArray<int64> MemberStarts;
+	int64 TotalCount = 0;
+	for (const TSharedPtr<FSceneBufferRenderResource, ESPMode::ThreadSafe>& Resource : Resources)
+	{
+		MemberStarts.Add(TotalCount);
+		TotalCount += Resource->GetGaussianCount();
+		Asset.SHCoefficientsCount = FMath::Max(Asset.SHCoefficientsCount, Resource->GetSHCoefficientsCount());
+	}
+	Asset.SHDim = Asset.SHCoefficientsCount > 0
+		              ? FMath::RoundToInt(FMath::Sqrt(static_cast<float>(Asset.SHCoefficientsCount))) - 1
+		              : 0;
+	Asset.bAttributesActivated = true;
+	Asset.SetGaussianCount(TotalCount);
+
+	// 把每个成员的高斯变换到世界空间，合并资产由位于原点的 Actor 绘制
+	// 非均匀缩放的 Actor 只能近似，缩放直接按高斯自身的轴相乘
+	TArray<int32> Sources;
+	Sources.SetNumUninitialized(TotalCount);
+	for (int32 Member = 0; Member < Resources.Num(); ++Member)
+	{
+		const FSceneBufferRenderResource& Resource = *Resources[Member];
+		FReadScopeLock PayloadLock(Resource.GetPayloadLock());
+		const FSceneGPUPayload& Payload = Resource.GetPayload();
+		const FTransform& Transform = Transforms[Member];
+		const int64 Start = MemberStarts[Member];
+		const int64 MemberSHCount = Payload.SHCoefficientsCount;
+		ParallelFor(Payload.GaussianCount, [&](const int32 i)
+		{
+			const FVector4f& PositionOpacity = Payload.PositionOpacity[i];
+			const FVector4f& Scale = Payload.Scale[i];
+			const FVector4f& Rotation = Payload.Rotation[i];
+			Asset.GaussianPositions[Start + i] = Transform.TransformPosition(
+				FVector(PositionOpacity.X, PositionOpacity.Y, PositionOpacity.Z));
+			Asset.GaussianOpacities[Start + i] = PositionOpacity.W;
+			Asset.GaussianScales[Start + i] = FVector(Scale.X, Scale.Y, Scale.Z) * Transform.GetScale3D();
+			Asset.GaussianRotations[Start + i] = Transform.GetRotation() * FQuat(
+				Rotation.X, Rotation.Y, Rotation.Z, Rotation.W);
+			for (int64 j = 0; j < MemberSHCount; ++j)
+			{
+				const FVector4f& SH = Payload.SHCoefficients[i * MemberSHCount + j];
+				Asset.GaussianSHCoefficients[(Start + i) * Asset.SHCoefficientsCount + j] = FVector(SH.X, SH.Y, SH.Z);
+			}
+			Sources[Start + i] = Member;
+		});
+	}
+
+	// 所有成员一起按 Morton 顺序排列，重叠区域的高斯会落在同一个 Chunk 中
+	FBuildResult Result;
+	TArray<uint32> Order;
+	Asset.BuildChunks(&Order);
+	Result.ChunkMemberCounts.SetNumZeroed(Asset.Chunks.Num() * Resources.Num());
+	for (int32 i = 0; i < Order.Num(); ++i)
+	{
+		++Result.ChunkMemberCounts[i / FSceneChunk::MaxGaussians * Resources.Num() + Sources[Order[i]]];
+	}
+
+	Result.Payload.Pack(Asset);
+	Result.Seconds = FPlatformTime::Seconds() - StartTime;
+	return Result;
+}
+
+FSceneAggregate USceneAggregatorSubsystem::FinishAggregate(FPendingAggregate& Pending)
+{
+	FBuildResult Result = Pending.Future.Consume();
+
+	FSceneAggregate Aggregate;
+	Aggregate.Members = MoveTemp(Pending.Members);
+	Aggregate.MemberTransforms = MoveTemp(Pending.MemberTransforms);
+	Aggregate.MemberResources = MoveTemp(Pending.MemberResources);
+	Aggregate.ChunkMemberCounts = MoveTemp(Result.ChunkMemberCounts);
+	Aggregate.Asset = Pending.Staging.Get();
+	Pending.Staging.Reset();
+
+	const int32 NumMembers = Aggregate.Members.Num();
+	Aggregate.MemberGaussians.SetNumZeroed(NumMembers);
+	Aggregate.MemberResidentGaussians.SetNumZeroed(NumMembers);
+	for (int32 Member = 0; Member < NumMembers; ++Member)
+	{
+		for (int32 Chunk = 0; Chunk < Aggregate.Asset->Chunks.Num(); ++Chunk)
+		{
+			Aggregate.MemberGaussians[Member] += Aggregate.ChunkMemberCounts[Chunk * NumMembers + Member];
+		}
+	}
+
+	// 开启流送时和其他资产一样按预算逐帧加载，打包数据交给 RenderResource 之后双精度数组只会重复占用内存
+	Aggregate.Asset->UpdateRenderResource(MoveTemp(Result.Payload));
+	Aggregate.Asset->DiscardUnpackedData();
+
+	Aggregate.Parameter = NewObject<USceneNiagaraParameter>(this);
+	Aggregate.Parameter->SceneBufferAssetPath = FSoftObjectPath(Aggregate.Asset);
+
+	ASceneActor* DrawActor = GetWorld()->SpawnActorDeferred<ASceneActor>(
+		ASceneActor::StaticClass(), FTransform::Identity, nullptr, nullptr,
+		ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+	DrawActor->SceneNiagaraParameter = Aggregate.Parameter;
+	DrawActor->bAllowAggregation = false;
+	DrawActor->FinishSpawning(FTransform::Identity);
+	Aggregate.DrawActor = DrawActor;
+
+	for (const TWeakObjectPtr<ASceneActor>& Member : Aggregate.Members)
+	{
+		Member->NiagaraComp->DeactivateImmediate();
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Aggregated %d overlapping scene actors (%u Gaussians, %d chunks) in %.2f ms."),
+	       NumMembers, Aggregate.Asset->GaussianCount, Aggregate.Asset->Chunks.Num(), Result.Seconds * 1000.0);
+	return Aggregate;
+}
+
+void USceneAggregatorSubsystem::DissolveAggregate(FSceneAggregate& Aggregate,
+                                                  const TSet<const ASceneActor*>& StillAggregated)
+{
+	for (const TWeakObjectPtr<ASceneActor>& Member : Aggregate.Members)
+	{
+		if (Member.IsValid() && !StillAggregated.Contains(Member.Get()))
+		{
+			Member->NiagaraComp->Activate(true);
+		}
+	}
+	if (IsValid(Aggregate.DrawActor))
+	{
+		Aggregate.DrawActor->Destroy();
+	}
+	Aggregate = FSceneAggregate();
+}
+
+void USceneAggregatorSubsystem::UpdateSuspendedResources(const TSet<const ASceneActor*>& AggregatedActors)
+{
+	TSet<const USceneBufferAsset*> UsedByOthers;
+	for (const FTrackedActor& TrackedActor : SceneActors)
+	{
+		const ASceneActor* SceneActor = TrackedActor.SceneActor.Get();
+		if (SceneActor && !AggregatedActors.Contains(SceneActor))
+		{
+			UsedByOthers.Add(GetSceneBufferAsset(SceneActor));
+		}
+	}
+
+	TArray<TSharedPtr<FSceneBufferRenderResource, ESPMode::ThreadSafe>> NewSuspendedResources;
+	for (const ASceneActor* SceneActor : AggregatedActors)
+	{
+		USceneBufferAsset* Asset = GetSceneBufferAsset(SceneActor);
+		if (!UsedByOthers.Contains(Asset))
+		{
+			NewSuspendedResources.AddUnique(Asset->GetRenderResource());
+		}
+	}
+
+	FSceneStreamingManager& StreamingManager = FSceneStreamingManager::Get();
+	for (const TWeakPtr<FSceneBufferRenderResource, ESPMode::ThreadSafe>& Suspended : SuspendedResources)
+	{
+		const TSharedPtr<FSceneBufferRenderResource, ESPMode::ThreadSafe> Resource = Suspended.Pin();
+		if (Resource && !NewSuspendedResources.Contains(Resource))
+		{
+			StreamingManager.SetResourceSuspended(Resource.Get(), false);
+		}
+	}
+	SuspendedResources.Reset();
+	for (const TSharedPtr<FSceneBufferRenderResource, ESPMode::ThreadSafe>& Resource : NewSuspendedResources)
+	{
+		StreamingManager.SetResourceSuspended(Resource.Get(), true);
+		SuspendedResources.Add(Resource);
+	}
+}
+
+void USceneAggregatorSubsystem::UpdateContribution(FSceneAggregate& Aggregate)
+{
+	const int32 NumMembers = Aggregate.Members.Num();
+	for (int32& Resident : Aggregate.MemberResidentGaussians)
+	{
+		Resident = 0;
+	}
+
+	const TSharedPtr<FSceneBufferRenderResource, ESPMode::ThreadSafe> Resource = Aggregate.Asset->GetRenderResource();
+	for (const int32 Chunk : Resource->GetResidency_GameThread().SlotChunks)
+	{
+		if (Chunk == INDEX_NONE)
+		{
+			continue;
+		}
+		for (int32 Member = 0; Member < NumMembers; ++Member)
+		{
+			Aggregate.MemberResidentGaussians[Member] += Aggregate.ChunkMemberCounts[Chunk * NumMembers + Member];
+		}
+	}
+}
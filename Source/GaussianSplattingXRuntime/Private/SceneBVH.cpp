@@ -0,0 +1,307 @@
+﻿#include "SceneBVH.h"
+
+#include "SceneBufferAsset.h"
+#include "Algo/Sort.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+	/// 射线和包围盒的 slab 测试，返回进入距离，不相交时返回 false
+	bool IntersectRay(const FVector3f& Min, const FVector3f& Max, const FVector& Origin, const FVector& InvDirection,
+	                  const double MaxDistance, double& OutEnter)
+	{
+		const FVector T0 = (FVector(Min) - Origin) * InvDirection;
+		const FVector T1 = (FVector(Max) - Origin) * InvDirection;
+		const double Enter = FMath::Max3(FMath::Min(T0.X, T1.X), FMath::Min(T0.Y, T1.Y), FMath::Min(T0.Z, T1.Z));
+		const double Exit = FMath::Min3(FMath::Max(T0.X, T1.X), FMath::Max(T0.Y, T1.Y), FMath::Max(T0.Z, T1.Z));
+		OutEnter = Enter;
+		return Exit >= FMath::Max(Enter, 0.0) && Enter <= MaxDistance;
+	}
+
+	double DistanceSquared(const FVector3f& Min, const FVector3f& Max, const FVector& Point)
+	{
+		const FVector Closest = Point.BoundToBox(FVector(Min), FVector(Max));
+		return FVector::DistSquared(Closest, Point);
+	}
+}
+
+FVector FSceneBVH::GetGaussianExtent(const FQuat& Rotation, const FVector& Scale)
+{
+	// 等于 SigmaExtent * sqrt(Σ_j (R_ij * s_j)^2)
+	const FVector X = Rotation.GetAxisX() * Scale.X;
+	const FVector Y = Rotation.GetAxisY() * Scale.Y;
+	const FVector Z = Rotation.GetAxisZ() * Scale.Z;
+	return SigmaExtent * FVector(
+		FMath::Sqrt(X.X * X.X + Y.X * Y.X + Z.X * Z.X),
+		FMath::Sqrt(X.Y * X.Y + Y.Y * Y.Y + Z.Y * Z.Y),
+		FMath::Sqrt(X.Z * X.Z + Y.Z * Y.Z + Z.Z * Z.Z));
+}
+
+FSceneBVH::FSceneBVH(const USceneBufferAsset& InScene)
+	: GaussianCount(InScene.GaussianCount)
+{
+	const int32 Count = GaussianCount;
+	if (Count == 0)
+	{
+		return;
+	}
+
+	Positions.SetNumUninitialized(Count);
+	Scales.SetNumUninitialized(Count);
+	Rotations.SetNumUninitialized(Count);
+	Opacities.SetNumUninitialized(Count);
+	FMemory::Memcpy(Opacities.GetData(), InScene.GaussianOpacities.GetData(), Count * sizeof(float));
+
+	// 叶子：相邻 LeafSize 个高斯椭球的包围盒，同时拷贝叶子中的高斯数据
+	TArray<FNode>& Leaves = Levels.AddDefaulted_GetRef();
+	Leaves.SetNumUninitialized(FMath::DivideAndRoundUp(Count, LeafSize));
+	ParallelFor(Leaves.Num(), [this, &InScene, Count, &Leaves](const int32 LeafIndex)
+	{
+		FBox Bounds(ForceInit);
+		const int32 First = LeafIndex * LeafSize;
+		const int32 Last = FMath::Min(First + LeafSize, Count);
+		for (int32 i = First; i < Last; ++i)
+		{
+			const FVector& Position = InScene.GaussianPositions[i];
+			const FVector Extent = GetGaussianExtent(InScene.GaussianRotations[i], InScene.GaussianScales[i]);
+			Bounds += FBox(Position - Extent, Position + Extent);
+
+			Positions[i] = FVector3f(Position);
+			Scales[i] = FVector3f(InScene.GaussianScales[i]);
+			Rotations[i] = FQuat4f(InScene.GaussianRotations[i]);
+		}
+		Leaves[LeafIndex] = {FVector3f(Bounds.Min), FVector3f(Bounds.Max)};
+	});
+
+	// 逐层两两合并，直到只剩根节点
+	while (Levels.Last().Num() > 1)
+	{
+		const int32 ChildLevel = Levels.Num() - 1;
+		TArray<FNode>& Parents = Levels.AddDefaulted_GetRef();
+		const TArray<FNode>& Children = Levels[ChildLevel];
+		Parents.SetNumUninitialized(FMath::DivideAndRoundUp(Children.Num(), 2));
+		ParallelFor(Parents.Num(), [&Parents, &Children](const int32 NodeIndex)
+		{
+			FNode Node = Children[NodeIndex * 2];
+			if (NodeIndex * 2 + 1 < Children.Num())
+			{
+				const FNode& Right = Children[NodeIndex * 2 + 1];
+				Node.Min = Node.Min.ComponentMin(Right.Min);
+				Node.Max = Node.Max.ComponentMax(Right.Max);
+			}
+			Parents[NodeIndex] = Node;
+		});
+	}
+}
+
+template <typename NodeFuncType, typename LeafFuncType>
+void FSceneBVH::Traverse(NodeFuncType&& NodeFunc, LeafFuncType&& LeafFunc) const
+{
+	if (Levels.IsEmpty())
+	{
+		return;
+	}
+
+	TArray<TPair<int32, int32>, TInlineAllocator<64>> Stack;
+	Stack.Emplace(Levels.Num() - 1, 0);
+	while (!Stack.IsEmpty())
+	{
+		const TPair<int32, int32> Entry = Stack.Pop(EAllowShrinking::No);
+		const FNode& Node = Levels[Entry.Key][Entry.Value];
+		if (!NodeFunc(Node.Min, Node.Max))
+		{
+			continue;
+		}
+
+		if (Entry.Key == 0)
+		{
+			const int32 First = Entry.Value * LeafSize;
+			LeafFunc(First, FMath::Min(First + LeafSize, GaussianCount));
+			continue;
+		}
+
+		const int32 ChildLevel = Entry.Key - 1;
+		for (int32 Child = Entry.Value * 2; Child < FMath::Min(Entry.Value * 2 + 2, Levels[ChildLevel].Num()); ++Child)
+		{
+			Stack.Emplace(ChildLevel, Child);
+		}
+	}
+}
+
+FSceneRaycastHit FSceneBVH::Raycast(const FVector& Start, const FVector& End, const float OpacityThreshold) const
+{
+	FSceneRaycastHit Hit;
+	const double MaxDistance = FVector::Dist(Start, End);
+	if (MaxDistance <= UE_DOUBLE_SMALL_NUMBER)
+	{
+		return Hit;
+	}
+	const FVector Direction = (End - Start) / MaxDistance;
+	const FVector InvDirection = Direction.Reciprocal();
+
+	struct FRayHit
+	{
+		double Distance;
+		float Alpha;
+		int32 Index;
+	};
+	TArray<FRayHit> RayHits;
+
+	Traverse([&](const FVector3f& Min, const FVector3f& Max)
+	         {
+		         double Enter;
+		         return IntersectRay(Min, Max, Start, InvDirection, MaxDistance, Enter);
+	         },
+	         [&](const int32 First, const int32 Last)
+	         {
+		         for (int32 i = First; i < Last; ++i)
+		         {
+			         // 在高斯的局部空间中椭球是单位球，射线上马氏距离最小的点就是不透明度最大的点
+			         const FQuat Rotation(Rotations[i]);
+			         const FVector InvScale = FVector(Scales[i]).ComponentMax(FVector(UE_DOUBLE_SMALL_NUMBER)).Reciprocal();
+			         const FVector LocalOrigin = Rotation.UnrotateVector(Start - FVector(Positions[i])) * InvScale;
+			         const FVector LocalDirection = Rotation.UnrotateVector(Direction) * InvScale;
+
+			         const double T = -FVector::DotProduct(LocalOrigin, LocalDirection) / LocalDirection.SizeSquared();
+			         if (T < 0.0 || T > MaxDistance)
+			         {
+				         continue;
+			         }
+			         const double Mahalanobis = (LocalOrigin + LocalDirection * T).SizeSquared();
+			         const float Alpha = FMath::Min(0.99f, Opacities[i] * FMath::Exp(-0.5 * Mahalanobis));
+			         if (Alpha >= 1.0f / 255.0f)
+			         {
+				         RayHits.Add({T, Alpha, i});
+			         }
+		         }
+	         });
+
+	Algo::SortBy(RayHits, &FRayHit::Distance);
+
+	// 和渲染时一样从前到后混合
+	float Transmittance = 1.0f;
+	for (const FRayHit& RayHit : RayHits)
+	{
+		Transmittance *= 1.0f - RayHit.Alpha;
+		if (1.0f - Transmittance < OpacityThreshold)
+		{
+			continue;
+		}
+
+		const int32 i = RayHit.Index;
+		Hit.bHit = true;
+		Hit.Distance = RayHit.Distance;
+		Hit.Location = Start + Direction * RayHit.Distance;
+		Hit.GaussianIndex = i;
+		Hit.Opacity = 1.0f - Transmittance;
+
+		// 马氏距离的梯度方向 R S^-2 R^T (p - c)
+		const FVector InvScale = FVector(Scales[i]).ComponentMax(FVector(UE_DOUBLE_SMALL_NUMBER)).Reciprocal();
+		const FQuat Rotation(Rotations[i]);
+		const FVector Local = Rotation.UnrotateVector(Hit.Location - FVector(Positions[i])) * InvScale * InvScale;
+		Hit.Normal = Rotation.RotateVector(Local).GetSafeNormal(UE_DOUBLE_SMALL_NUMBER, -Direction);
+		if (FVector::DotProduct(Hit.Normal, Direction) > 0.0)
+		{
+			Hit.Normal = -Hit.Normal;
+		}
+		return Hit;
+	}
+
+	Hit.Opacity = 1.0f - Transmittance;
+	return Hit;
+}
+
+void FSceneBVH::RaycastBatch(const TConstArrayView<FVector> Starts, const TConstArrayView<FVector> Ends,
+                             const float OpacityThreshold, TArray<FSceneRaycastHit>& OutHits) const
+{
+	check(Starts.Num() == Ends.Num());
+	OutHits.SetNum(Starts.Num());
+	ParallelFor(Starts.Num(), [&](const int32 i)
+	{
+		OutHits[i] = Raycast(Starts[i], Ends[i], OpacityThreshold);
+	}, EParallelForFlags::Unbalanced);
+}
+
+int32 FSceneBVH::FindNearest(const FVector& Location, const double MaxDistance, double& OutDistance,
+                             const FTransform& Transform) const
+{
+	int32 NearestIndex = INDEX_NONE;
+	double NearestSquared = FMath::Square(MaxDistance);
+
+	// 变换后的距离不小于资产空间中的距离乘以最小的轴缩放，所以节点在资产空间中的距离乘以最小缩放就是变换后距离的下界
+	const FVector LocalLocation = Transform.InverseTransformPosition(Location);
+	const double MinScaleSquared = FMath::Square(Transform.GetMinimumAxisScale());
+
+	// 距离下界大于当前最近距离的节点不需要访问
+	Traverse([&](const FVector3f& Min, const FVector3f& Max)
+	         {
+		         return DistanceSquared(Min, Max, LocalLocation) * MinScaleSquared <= NearestSquared;
+	         },
+	         [&](const int32 First, const int32 Last)
+	         {
+		         for (int32 i = First; i < Last; ++i)
+		         {
+			         const double Squared = FVector::DistSquared(Transform.TransformPosition(FVector(Positions[i])),
+			                                                     Location);
+			         if (Squared <= NearestSquared)
+			         {
+				         NearestSquared = Squared;
+				         NearestIndex = i;
+			         }
+		         }
+	         });
+
+	OutDistance = NearestIndex != INDEX_NONE ? FMath::Sqrt(NearestSquared) : 0.0;
+	return NearestIndex;
+}
+
+void FSceneBVH::OverlapBox(const FBox& Box, TArray<int32>& OutIndices) const
+{
+	const FVector3f BoxMin(Box.Min);
+	const FVector3f BoxMax(Box.Max);
+	Traverse([&](const FVector3f& Min, const FVector3f& Max)
+	         {
+		         return Min.X <= BoxMax.X && Max.X >= BoxMin.X && Min.Y <= BoxMax.Y && Max.Y >= BoxMin.Y &&
+			         Min.Z <= BoxMax.Z && Max.Z >= BoxMin.Z;
+	         },
+	         [&](const int32 First, const int32 Last)
+	         {
+		         for (int32 i = First; i < Last; ++i)
+		         {
+			         if (Box.IsInsideOrOn(FVector(Positions[i])))
+			         {
+				         OutIndices.Add(i);
+			         }
+		         }
+	         });
+}
+
+void FSceneBVH::OverlapSphere(const FVector& Center, const double Radius, TArray<int32>& OutIndices) const
+{
+	const double RadiusSquared = FMath::Square(Radius);
+	Traverse([&](const FVector3f& Min, const FVector3f& Max)
+	         {
+		         return DistanceSquared(Min, Max, Center) <= RadiusSquared;
+	         },
+	         [&](const int32 First, const int32 Last)
+	         {
+		         for (int32 i = First; i < Last; ++i)
+		         {
+			         if (FVector::DistSquared(FVector(Positions[i]), Center) <= RadiusSquared)
+			         {
+				         OutIndices.Add(i);
+			         }
+		         }
+	         });
+}
+
+SIZE_T FSceneBVH::GetAllocatedSize() const
+{
+	SIZE_T Size = Levels.GetAllocatedSize() + Positions.GetAllocatedSize() + Scales.GetAllocatedSize() +
+		Rotations.GetAllocatedSize() + Opacities.GetAllocatedSize();
+	for (const TArray<FNode>& Level : Levels)
+	{
+		Size += Level.GetAllocatedSize();
+	}
+	return Size;
+}
@@ -0,0 +1,168 @@
+﻿#include "SceneBudgetController.h"
+
+#include "GaussianSplattingXStats.h"
+#include "RHI.h"
+
+#include <atomic>
+
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Budget Quality"), STAT_GaussianSplattingX_BudgetQuality, STATGROUP_GaussianSplattingX);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Budget Frame Time (ms)"), STAT_GaussianSplattingX_BudgetFrameTime,
+                           STATGROUP_GaussianSplattingX);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Budget Splat Time (ms)"), STAT_GaussianSplattingX_BudgetSplatTime,
+                           STATGROUP_GaussianSplattingX);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Budget Resident Chunk Scale"), STAT_GaussianSplattingX_BudgetChunkScale,
+                           STATGROUP_GaussianSplattingX);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Budget Min Opacity"), STAT_GaussianSplattingX_BudgetMinOpacity,
+                           STATGROUP_GaussianSplattingX);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Budget SH Coefficients"), STAT_GaussianSplattingX_BudgetSHCoefficients,
+                           STATGROUP_GaussianSplattingX);
+
+namespace
+{
+	TAutoConsoleVariable<bool> CVarBudgetEnable(
+		TEXT("GaussianSplattingX.Budget.Enable"),
+		false,
+		TEXT("Adjust the Gaussian splat budget every frame to hold GaussianSplattingX.Budget.TargetFrameTimeMs."),
+		ECVF_Default);
+
+	TAutoConsoleVariable<float> CVarBudgetTargetFrameTimeMs(
+		TEXT("GaussianSplattingX.Budget.TargetFrameTimeMs"),
+		16.6f,
+		TEXT("GPU frame time the budget controller tries to hold, e.g. 16.6 for 60 Hz or 11.1 for 90 Hz."),
+		ECVF_Default);
+
+	TAutoConsoleVariable<float> CVarBudgetHysteresis(
+		TEXT("GaussianSplattingX.Budget.Hysteresis"),
+		0.1f,
+		TEXT("Relative dead band around the target in which the budget is left unchanged."),
+		ECVF_Default);
+
+	TAutoConsoleVariable<int32> CVarBudgetRecoverFrames(
+		TEXT("GaussianSplattingX.Budget.RecoverFrames"),
+		30,
+		TEXT("Frames the frame time has to stay below the band before the quality is raised again."),
+		ECVF_Default);
+
+	TAutoConsoleVariable<float> CVarBudgetMinQuality(
+		TEXT("GaussianSplattingX.Budget.MinQuality"),
+		0.25f,
+		TEXT("Lowest quality the controller may drop to, in (0, 1]."),
+		ECVF_Default);
+
+	TAutoConsoleVariable<float> CVarBudgetMaxOpacityCull(
+		TEXT("GaussianSplattingX.Budget.MaxOpacityCull"),
+		0.2f,
+		TEXT("Opacity cull threshold used at quality 0, scaled linearly towards 0 at quality 1."),
+		ECVF_Default);
+
+	TAutoConsoleVariable<float> CVarBudgetForceQuality(
+		TEXT("GaussianSplattingX.Budget.ForceQuality"),
+		-1.0f,
+		TEXT("Override the quality in [0, 1] instead of measuring the frame time. Negative values disable the override."),
+		ECVF_Default);
+
+	/// 帧时间的指数平滑系数，画质变化后大约 1 / FrameTimeSmoothing 帧才完全反映到平滑后的测量中
+	constexpr float FrameTimeSmoothing = 0.1f;
+
+	/// 每帧最多降低的画质，以及恢复时每帧最多提高的画质
+	constexpr float MaxDecreasePerFrame = 0.05f;
+	constexpr float MaxIncreasePerFrame = 0.01f;
+
+	/// 超过这么多帧没有报告绘制高斯的耗时时不再使用
+	constexpr uint32 SplatTimeTimeoutFrames = 30;
+
+	/// RT 上最近一次报告的绘制高斯的耗时，和报告时的帧号，还没有报告时耗时为负数
+	std::atomic<float> ReportedSplatTimeMs = -1.0f;
+	std::atomic<uint32> ReportedSplatTimeFrame = 0;
+}
+
+FSceneSplatBudget FSceneBudgetController::Budget;
+float FSceneBudgetController::SmoothedFrameTimeMs = 0.0f;
+float FSceneBudgetController::SmoothedSplatTimeMs = 0.0f;
+int32 FSceneBudgetController::FramesBelowTarget = 0;
+
+void FSceneBudgetController::Update()
+{
+	check(IsInGameThread());
+
+	// 目标是整帧的 GPU 时间，不支持时退回到渲染线程时间
+	const uint32 GPUCycles = RHIGetGPUFrameCycles();
+	const float FrameTimeMs = FPlatformTime::ToMilliseconds(GPUCycles > 0 ? GPUCycles : GRenderThreadTime);
+	SmoothedFrameTimeMs = SmoothedFrameTimeMs > 0.0f
+		                      ? FMath::Lerp(SmoothedFrameTimeMs, FrameTimeMs, FrameTimeSmoothing)
+		                      : FrameTimeMs;
+
+	// 画质只能改变绘制高斯的耗时，Niagara 后端没有单独的测量，只能假设整帧都随画质变化
+	const float ReportedMs = ReportedSplatTimeMs.load(std::memory_order_relaxed);
+	const bool bSplatTimeValid = ReportedMs >= 0.0f &&
+		GFrameNumber - ReportedSplatTimeFrame.load(std::memory_order_relaxed) <= SplatTimeTimeoutFrames;
+	const float SplatTimeMs = bSplatTimeValid ? ReportedMs : FrameTimeMs;
+	SmoothedSplatTimeMs = SmoothedSplatTimeMs > 0.0f
+		                      ? FMath::Lerp(SmoothedSplatTimeMs, SplatTimeMs, FrameTimeSmoothing)
+		                      : SplatTimeMs;
+
+	const float ForceQuality = CVarBudgetForceQuality.GetValueOnGameThread();
+	if (ForceQuality >= 0.0f)
+	{
+		Budget.Quality = FMath::Min(ForceQuality, 1.0f);
+		FramesBelowTarget = 0;
+	}
+	else if (!CVarBudgetEnable.GetValueOnGameThread())
+	{
+		Budget.Quality = 1.0f;
+		FramesBelowTarget = 0;
+	}
+	else
+	{
+		const float TargetMs = FMath::Max(CVarBudgetTargetFrameTimeMs.GetValueOnGameThread(), 1.0f);
+		const float Hysteresis = FMath::Clamp(CVarBudgetHysteresis.GetValueOnGameThread(), 0.0f, 0.5f);
+		const float MinQuality = FMath::Clamp(CVarBudgetMinQuality.GetValueOnGameThread(), 0.01f, 1.0f);
+
+		// 绘制高斯的耗时和画质成正比时，回到目标需要的画质变化是 Quality * 误差 / 绘制耗时
+		// 每帧只走其中平滑系数的一部分，和测量的平滑速度一致，否则在测量追上之前会一直朝同一方向调整
+		const float ErrorMs = SmoothedFrameTimeMs - TargetMs;
+		const float Step = FrameTimeSmoothing * Budget.Quality * ErrorMs / FMath::Max(SmoothedSplatTimeMs, 0.1f);
+		if (SmoothedFrameTimeMs > TargetMs * (1.0f + Hysteresis))
+		{
+			Budget.Quality -= FMath::Min(Step, MaxDecreasePerFrame);
+			FramesBelowTarget = 0;
+		}
+		else if (SmoothedFrameTimeMs < TargetMs * (1.0f - Hysteresis))
+		{
+			if (++FramesBelowTarget >= CVarBudgetRecoverFrames.GetValueOnGameThread())
+			{
+				Budget.Quality += FMath::Min(-Step, MaxIncreasePerFrame);
+			}
+		}
+		else
+		{
+			FramesBelowTarget = 0;
+		}
+		Budget.Quality = FMath::Clamp(Budget.Quality, MinQuality, 1.0f);
+	}
+
+	// 画质在三个方面同时生效：先丢弃优先级低的 Chunk，再剔除半透明的高斯，最后降低 SH 阶数
+	Budget.ResidentChunkScale = Budget.Quality;
+	Budget.MinOpacity = (1.0f - Budget.Quality) * CVarBudgetMaxOpacityCull.GetValueOnGameThread();
+	const int32 MaxSHDegree = FMath::Clamp(FMath::FloorToInt(Budget.Quality * 4.0f), 0, 3);
+	Budget.MaxSHCoefficientsCount = FMath::Square(MaxSHDegree + 1);
+
+	SET_FLOAT_STAT(STAT_GaussianSplattingX_BudgetQuality, Budget.Quality);
+	SET_FLOAT_STAT(STAT_GaussianSplattingX_BudgetFrameTime, SmoothedFrameTimeMs);
+	SET_FLOAT_STAT(STAT_GaussianSplattingX_BudgetSplatTime, SmoothedSplatTimeMs);
+	SET_FLOAT_STAT(STAT_GaussianSplattingX_BudgetChunkScale, Budget.ResidentChunkScale);
+	SET_FLOAT_STAT(STAT_GaussianSplattingX_BudgetMinOpacity, Budget.MinOpacity);
+	SET_DWORD_STAT(STAT_GaussianSplattingX_BudgetSHCoefficients, Budget.MaxSHCoefficientsCount);
+}
+
+const FSceneSplatBudget& FSceneBudgetController::GetBudget()
+{
+	return Budget;
+}
+
+void FSceneBudgetController::ReportSplatGPUTime_RenderThread(const float TimeMs)
+{
+	check(IsInRenderingThread());
+	ReportedSplatTimeMs.store(TimeMs, std::memory_order_relaxed);
+	ReportedSplatTimeFrame.store(GFrameNumberRenderThread, std::memory_order_relaxed);
+}
@@ -1,7 +1,270 @@
 ﻿#include "SceneBufferAsset.h"
 
+#include "GaussianSplattingXSettings.h"
+#include "SceneBufferAssetImportData.h"
+#include "SceneBufferRenderResource.h"
+#include "SceneBVH.h"
+#include "SceneStreamingManager.h"
+#include "Algo/Sort.h"
+#include "Async/ParallelFor.h"
+#include "Misc/ScopeRWLock.h"
 #include "Serialization/ArchiveCrc32.h"
 
+#if WITH_EDITOR
+#include "DeviceProfiles/DeviceProfile.h"
+#include "DeviceProfiles/DeviceProfileManager.h"
+#include "Interfaces/ITargetPlatform.h"
+#endif
+
+namespace
+{
+	/// 每个并行任务处理的高斯数量，是 4 的倍数，保证每批都可以按 4 个一组做向量化计算
+	constexpr int64 ActivationBatchSize = 4096;
+
+	/// 把 21 位整数的每一位间隔两位展开，用于计算 3D Morton 码
+	uint64 SpreadBits(uint64 Value)
+	{
+		Value &= 0x1fffff;
+		Value = (Value | Value << 32) & 0x1f00000000ffff;
+		Value = (Value | Value << 16) & 0x1f0000ff0000ff;
+		Value = (Value | Value << 8) & 0x100f00f00f00f00f;
+		Value = (Value | Value << 4) & 0x10c30c30c30c30c3;
+		Value = (Value | Value << 2) & 0x1249249249249249;
+		return Value;
+	}
+
+	/// 把 TArray 按 Order 重新排列，每个元素占 Stride 个连续的 T
+	template <typename T>
+	void Permute(TArray<T>& Array, const TArray<uint32>& Order, const int64 Stride = 1)
+	{
+		TArray<T> Result;
+		Result.SetNumUninitialized(Array.Num());
+		ParallelFor(Order.Num(), [&](const int32 i)
+		{
+			FMemory::Memcpy(&Result[i * Stride], &Array[Order[i] * Stride], sizeof(T) * Stride);
+		}, EParallelForFlags::Unbalanced);
+		Array = MoveTemp(Result);
+	}
+
+	/// sigmoid(x) = 1 / (1 + exp(-x))，每次处理 4 个 float
+	void ActivateOpacities(float* Opacities, const int64 Count)
+	{
+		int64 i = 0;
+		for (; i + 4 <= Count; i += 4)
+		{
+			const VectorRegister4Float Logit = VectorLoad(Opacities + i);
+			const VectorRegister4Float Denominator = VectorAdd(VectorOne(), VectorExp(VectorNegate(Logit)));
+			VectorStore(VectorReciprocal(Denominator), Opacities + i);
+		}
+		for (; i < Count; ++i)
+		{
+			Opacities[i] = 1.0f / (1.0f + FMath::Exp(-Opacities[i]));
+		}
+	}
+
+	/// 烘焙时保留的最高 SH 阶数，在目标平台的设备描述中设置，例如移动平台只保留 0 阶的基础颜色
+	TAutoConsoleVariable<int32> CVarCookMaxSHDegree(
+		TEXT("GaussianSplattingX.Cook.MaxSHDegree"),
+		3,
+		TEXT("Highest spherical harmonics degree kept in cooked scene assets (0-3). ")
+		TEXT("Set per platform in the device profiles, e.g. +CVars=GaussianSplattingX.Cook.MaxSHDegree=1"),
+		ECVF_ReadOnly);
+
+#if WITH_EDITOR
+	/// 目标平台烘焙时使用的设备描述中的 SH 阶数，没有设置时使用控制台变量的默认值
+	int32 GetCookMaxSHCoefficientsCount(const ITargetPlatform* TargetPlatform)
+	{
+		int32 MaxSHDegree = CVarCookMaxSHDegree.GetValueOnAnyThread();
+		if (TargetPlatform)
+		{
+			if (const UDeviceProfile* DeviceProfile = UDeviceProfileManager::Get().FindProfile(
+				TargetPlatform->CookingDeviceProfileName(), false))
+			{
+				DeviceProfile->GetConsolidatedCVarValue(TEXT("GaussianSplattingX.Cook.MaxSHDegree"), MaxSHDegree);
+			}
+		}
+		return FMath::Square(FMath::Clamp(MaxSHDegree, 0, 3) + 1);
+	}
+#endif
+}
+
+const FName USceneBufferAsset::GaussianCountTag(TEXT("GaussianCount"));
+const FName USceneBufferAsset::SHDegreeTag(TEXT("SHDegree"));
+const FName USceneBufferAsset::BoundsTag(TEXT("Bounds"));
+const FName USceneBufferAsset::GPUMemoryTag(TEXT("GPUMemory"));
+const FName USceneBufferAsset::SourceFileHashTag(TEXT("SourceFileHash"));
+
+void USceneBufferAsset::PostInitProperties()
+{
+#if WITH_EDITORONLY_DATA
+	if (!HasAnyFlags(RF_ClassDefaultObject | RF_NeedLoad))
+	{
+		AssetImportData = NewObject<USceneBufferAssetImportData>(this, TEXT("AssetImportData"));
+	}
+#endif
+	Super::PostInitProperties();
+}
+
+void USceneBufferAsset::Serialize(FArchive& Ar)
+{
+#if WITH_EDITOR
+	if (Ar.IsCooking() && Ar.IsSaving() && !HasAnyFlags(RF_ClassDefaultObject))
+	{
+		// 烘焙时按目标平台打包 GPU 数据，包中只保存打包后的数组，双精度数组在保存属性时临时移走
+		const double StartTime = FPlatformTime::Seconds();
+		FSceneGPUPayload Payload;
+		Payload.Pack(*this, GetCookMaxSHCoefficientsCount(Ar.CookingTarget()));
+
+		const uint32 SourceSHDim = SHDim;
+		const uint32 SourceSHCoefficientsCount = SHCoefficientsCount;
+		TArray<FVector> Positions = MoveTemp(GaussianPositions);
+		TArray<FVector> Scales = MoveTemp(GaussianScales);
+		TArray<FQuat> Rotations = MoveTemp(GaussianRotations);
+		TArray<float> Opacities = MoveTemp(GaussianOpacities);
+		TArray<FVector> SHCoefficients = MoveTemp(GaussianSHCoefficients);
+		if (Payload.SHCoefficientsCount < SHCoefficientsCount)
+		{
+			SHCoefficientsCount = Payload.SHCoefficientsCount;
+			SHDim = FMath::RoundToInt(FMath::Sqrt(static_cast<float>(SHCoefficientsCount))) - 1;
+		}
+
+		Super::Serialize(Ar);
+		Payload.Serialize(Ar);
+
+		SHDim = SourceSHDim;
+		SHCoefficientsCount = SourceSHCoefficientsCount;
+		GaussianPositions = MoveTemp(Positions);
+		GaussianScales = MoveTemp(Scales);
+		GaussianRotations = MoveTemp(Rotations);
+		GaussianOpacities = MoveTemp(Opacities);
+		GaussianSHCoefficients = MoveTemp(SHCoefficients);
+
+		UE_LOG(LogTemp, Log, TEXT("Cooked %u Gaussians of %s for %s with %u SH coefficients (%.2f MB) in %.2f ms."),
+		       GaussianCount, *GetName(), *Ar.CookingTarget()->PlatformName(), Payload.SHCoefficientsCount,
+		       Payload.GetAllocatedSize() / (1024.0 * 1024.0), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+		return;
+	}
+#endif
+
+	Super::Serialize(Ar);
+
+	// 只有烘焙的包中才有打包好的数据
+	if (Ar.IsLoading() && FPlatformProperties::RequiresCookedData() && !HasAnyFlags(RF_ClassDefaultObject))
+	{
+		CookedPayload = MakeShared<FSceneGPUPayload, ESPMode::ThreadSafe>();
+		CookedPayload->Serialize(Ar);
+	}
+}
+
+void USceneBufferAsset::PostLoad()
+{
+	Super::PostLoad();
+
+	// 烘焙的包中没有双精度数组，GPU 直接使用打包好的数据，只有查询、编辑和合并时才需要恢复
+	bNeedsUnpack = CookedPayload && GaussianPositions.IsEmpty() && GaussianCount > 0;
+
+	if (!bAttributesActivated)
+	{
+		// 旧版本把 PLY 中 w 在前的 rot_0..rot_3 直接传给了 FQuat 的 x,y,z,w，这里先恢复正确的分量顺序
+		for (FQuat& Rotation : GaussianRotations)
+		{
+			Rotation = FQuat(Rotation.Y, Rotation.Z, Rotation.W, Rotation.X);
+		}
+		ActivateAttributes();
+		UE_LOG(LogTemp, Log, TEXT("Converted legacy raw Gaussian attributes of %s, resave the asset to skip this step."),
+		       *GetName());
+	}
+
+	if (Chunks.IsEmpty() && GaussianCount > 0)
+	{
+		UnpackCookedPayload();
+		BuildChunks();
+		UE_LOG(LogTemp, Log, TEXT("Built %d streaming chunks for %s, resave the asset to skip this step."),
+		       Chunks.Num(), *GetName());
+	}
+	else if (!Chunks.IsEmpty() && !Chunks[0].SplatBounds.IsValid)
+	{
+		// 旧版本的 Chunk 只有高斯中心的包围盒
+		UnpackCookedPayload();
+		ParallelFor(Chunks.Num(), [this](const int32 ChunkIndex)
+		{
+			UpdateChunkSplatBounds(ChunkIndex);
+		});
+		UE_LOG(LogTemp, Log, TEXT("Computed chunk splat bounds for %s, resave the asset to skip this step."),
+		       *GetName());
+	}
+
+	if (GetDefault<UGaussianSplattingXSettings>()->bBuildSpatialIndexOnLoad && GaussianCount > 0)
+	{
+		GetBVH();
+	}
+}
+
+void USceneBufferAsset::BeginDestroy()
+{
+	ReleaseRenderResource();
+	Super::BeginDestroy();
+}
+
+void USceneBufferAsset::GetAssetRegistryTags(FAssetRegistryTagsContext Context) const
+{
+	// 浏览内容时只读取这些标签，不加载高斯数据
+	Context.AddTag(FAssetRegistryTag(GaussianCountTag, LexToString(GaussianCount), FAssetRegistryTag::TT_Numerical));
+	Context.AddTag(FAssetRegistryTag(SHDegreeTag, LexToString(SHDim), FAssetRegistryTag::TT_Numerical));
+	Context.AddTag(FAssetRegistryTag(GPUMemoryTag,
+	                                 LexToString(GaussianCount * GetGPUBytesPerGaussian(SHCoefficientsCount)),
+	                                 FAssetRegistryTag::TT_Numerical, FAssetRegistryTag::TD_Memory));
+	if (const FBox Bounds = GetBounds(); Bounds.IsValid)
+	{
+		Context.AddTag(FAssetRegistryTag(BoundsTag, Bounds.ToString(), FAssetRegistryTag::TT_Alphabetical));
+	}
+
+#if WITH_EDITORONLY_DATA
+	if (AssetImportData)
+	{
+		Context.AddTag(FAssetRegistryTag(SourceFileTagName(), AssetImportData->GetSourceData().ToJson(),
+		                                 FAssetRegistryTag::TT_Hidden));
+		const TArray<FAssetImportInfo::FSourceFile>& SourceFiles = AssetImportData->GetSourceData().SourceFiles;
+		if (!SourceFiles.IsEmpty() && SourceFiles[0].FileHash.IsValid())
+		{
+			Context.AddTag(FAssetRegistryTag(SourceFileHashTag, LexToString(SourceFiles[0].FileHash),
+			                                 FAssetRegistryTag::TT_Alphabetical));
+		}
+	}
+#endif
+
+	Super::GetAssetRegistryTags(Context);
+}
+
+#if WITH_EDITOR
+void USceneBufferAsset::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	// 重新导入后数据整体发生了变化
+	ResetBVH();
+	if (RenderResource)
+	{
+		UpdateRenderResource();
+	}
+}
+#endif
+
+int64 USceneBufferAsset::GetGPUBytesPerGaussian(const uint32 InSHCoefficientsCount)
+{
+	return static_cast<int64>(sizeof(FVector4f)) * (3 + InSHCoefficientsCount);
+}
+
+FBox USceneBufferAsset::GetBounds() const
+{
+	FBox Bounds(ForceInit);
+	for (const FSceneChunk& Chunk : Chunks)
+	{
+		Bounds += Chunk.Bounds;
+	}
+	return Bounds;
+}
+
 void USceneBufferAsset::SetGaussianCount(const size_t NewGaussianCount)
 {
 	GaussianCount = NewGaussianCount;
@@ -11,3 +274,422 @@ void USceneBufferAsset::SetGaussianCount(const size_t NewGaussianCount)
 	GaussianOpacities.SetNum(NewGaussianCount);
 	GaussianSHCoefficients.SetNumZeroed(NewGaussianCount * SHCoefficientsCount);
 }
+
+void USceneBufferAsset::UnpackCookedPayload()
+{
+	if (!bNeedsUnpack)
+	{
+		return;
+	}
+	bNeedsUnpack = false;
+
+	// 第一次创建 RenderResource 之后打包数据已经移到 RenderResource 中
+	const double StartTime = FPlatformTime::Seconds();
+	if (CookedPayload)
+	{
+		CookedPayload->Unpack(*this);
+	}
+	else if (RenderResource)
+	{
+		FReadScopeLock Lock(RenderResource->GetPayloadLock());
+		RenderResource->GetPayload().Unpack(*this);
+	}
+	UE_LOG(LogTemp, Log, TEXT("Unpacked %u cooked Gaussians of %s in %.2f ms."), GaussianCount, *GetName(),
+	       (FPlatformTime::Seconds() - StartTime) * 1000.0);
+}
+
+void USceneBufferAsset::DiscardUnpackedData()
+{
+	check(IsInGameThread() && RenderResource);
+	GaussianPositions.Empty();
+	GaussianScales.Empty();
+	GaussianRotations.Empty();
+	GaussianOpacities.Empty();
+	GaussianSHCoefficients.Empty();
+	bNeedsUnpack = GaussianCount > 0;
+}
+
+void USceneBufferAsset::ActivateAttributes()
+{
+	if (bAttributesActivated)
+	{
+		return;
+	}
+
+	const int64 Count = GaussianCount;
+	check(GaussianOpacities.Num() >= Count && GaussianScales.Num() >= Count && GaussianRotations.Num() >= Count);
+
+	// 按批次并行，每批内部是连续内存上的紧凑循环
+	const int32 NumBatches = static_cast<int32>((Count + ActivationBatchSize - 1) / ActivationBatchSize);
+	ParallelFor(NumBatches, [this, Count](const int32 BatchIndex)
+	{
+		const int64 Begin = BatchIndex * ActivationBatchSize;
+		const int64 End = FMath::Min(Begin + ActivationBatchSize, Count);
+
+		ActivateOpacities(GaussianOpacities.GetData() + Begin, End - Begin);
+
+		double* Scales = &GaussianScales[Begin].X;
+		for (int64 i = 0; i < (End - Begin) * 3; ++i)
+		{
+			Scales[i] = FMath::Exp(Scales[i]);
+		}
+
+		for (int64 i = Begin; i < End; ++i)
+		{
+			GaussianRotations[i] = GaussianRotations[i].GetNormalized();
+		}
+	});
+
+	bAttributesActivated = true;
+}
+
+TSharedPtr<FSceneBufferRenderResource, ESPMode::ThreadSafe> USceneBufferAsset::GetRenderResource()
+{
+	check(IsInGameThread());
+	if (!RenderResource)
+	{
+		UpdateRenderResource();
+	}
+	return RenderResource;
+}
+
+void USceneBufferAsset::UpdateRenderResource()
+{
+	check(IsInGameThread());
+	if (!CookedPayload)
+	{
+		// 重新打包需要双精度数组，打包数据在释放 RenderResource 之前恢复
+		UnpackCookedPayload();
+	}
+	ReleaseRenderResource();
+	ResetBVH();
+	DirtyRanges.Reset();
+
+	// 流送以 Chunk 为单位，没有经过导入流程的资产在这里补上
+	if (Chunks.IsEmpty() && GaussianCount > 0)
+	{
+		BuildChunks();
+	}
+
+	FSceneGPUPayload Payload;
+	if (CookedPayload)
+	{
+		// 烘焙时已经按目标平台打包好，只在第一次创建时使用，之后的数据以资产中的数组为准
+		Payload = MoveTemp(*CookedPayload);
+		CookedPayload.Reset();
+	}
+	else
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		Payload.Pack(*this);
+		UE_LOG(LogTemp, Log, TEXT("Packed %u Gaussians of %s for GPU upload (%.2f MB) in %.2f ms."), GaussianCount,
+		       *GetName(), Payload.GetAllocatedSize() / (1024.0 * 1024.0),
+		       (FPlatformTime::Seconds() - StartTime) * 1000.0);
+	}
+	CreateRenderResource(MoveTemp(Payload));
+}
+
+void USceneBufferAsset::UpdateRenderResource(FSceneGPUPayload&& Payload)
+{
+	check(IsInGameThread());
+	check(Payload.GaussianCount == GaussianCount && Chunks.Num() == FMath::DivideAndRoundUp<int32>(GaussianCount,
+		FSceneChunk::MaxGaussians));
+	ReleaseRenderResource();
+	ResetBVH();
+	DirtyRanges.Reset();
+	CookedPayload.Reset();
+	CreateRenderResource(MoveTemp(Payload));
+}
+
+void USceneBufferAsset::CreateRenderResource(FSceneGPUPayload&& Payload)
+{
+	// 开启流送时池一开始是空的，由流送管理器按预算分配 Slot 并加载 Chunk
+	// 关闭流送时池可以容纳所有 Chunk，渐进加载时仍由流送管理器按重要性逐帧上传，否则一次性上传
+	const UGaussianSplattingXSettings* Settings = GetDefault<UGaussianSplattingXSettings>();
+	const bool bStreaming = Settings->bEnableStreaming;
+	const bool bInitiallyResident = !bStreaming && !Settings->bProgressiveLoading;
+	RenderResource = MakeShared<FSceneBufferRenderResource, ESPMode::ThreadSafe>(
+		MoveTemp(Payload), Chunks, bStreaming ? 0 : Chunks.Num(), bInitiallyResident);
+	BeginInitResource(RenderResource.Get());
+	FSceneStreamingManager::Get().RegisterResource(RenderResource);
+}
+
+void USceneBufferAsset::ReleaseRenderResource()
+{
+	if (!RenderResource)
+	{
+		return;
+	}
+
+	ENQUEUE_RENDER_COMMAND(ReleaseSceneBufferRenderResource)(
+		[Resource = MoveTemp(RenderResource)](FRHICommandListImmediate& RHICmdList)
+		{
+			Resource->ReleaseResource();
+		});
+	RenderResource.Reset();
+}
+
+void USceneBufferAsset::SetGaussianPosition(const int32 Index, const FVector& Position)
+{
+	UnpackCookedPayload();
+	GaussianPositions[Index] = Position;
+	MarkGaussiansDirty(Index, 1, ESceneGaussianAttributes::PositionOpacity);
+}
+
+void USceneBufferAsset::SetGaussianOpacity(const int32 Index, const float Opacity)
+{
+	UnpackCookedPayload();
+	GaussianOpacities[Index] = FMath::Clamp(Opacity, 0.0f, 1.0f);
+	MarkGaussiansDirty(Index, 1, ESceneGaussianAttributes::PositionOpacity);
+}
+
+void USceneBufferAsset::SetGaussianScale(const int32 Index, const FVector& Scale)
+{
+	UnpackCookedPayload();
+	GaussianScales[Index] = Scale;
+	MarkGaussiansDirty(Index, 1, ESceneGaussianAttributes::Scale);
+}
+
+void USceneBufferAsset::SetGaussianRotation(const int32 Index, const FQuat& Rotation)
+{
+	UnpackCookedPayload();
+	GaussianRotations[Index] = Rotation.GetNormalized();
+	MarkGaussiansDirty(Index, 1, ESceneGaussianAttributes::Rotation);
+}
+
+void USceneBufferAsset::SetGaussianSHCoefficients(const int32 Index, const TConstArrayView<FVector> Coefficients)
+{
+	UnpackCookedPayload();
+	check(Coefficients.Num() == static_cast<int32>(SHCoefficientsCount));
+	FMemory::Memcpy(&GaussianSHCoefficients[static_cast<int64>(Index) * SHCoefficientsCount], Coefficients.GetData(),
+	                Coefficients.Num() * sizeof(FVector));
+	MarkGaussiansDirty(Index, 1, ESceneGaussianAttributes::SHCoefficients);
+}
+
+void USceneBufferAsset::MarkGaussiansDirty(const int32 Start, const int32 Count, const ESceneGaussianAttributes Attributes)
+{
+	check(Start >= 0 && Start + Count <= static_cast<int32>(GaussianCount));
+	if (Count <= 0 || Attributes == ESceneGaussianAttributes::None)
+	{
+		return;
+	}
+
+	// 编辑工具通常按顺序修改相邻的高斯，这里先和上一个范围合并，减少提交时需要排序的范围数量
+	if (!DirtyRanges.IsEmpty())
+	{
+		FDirtyRange& Last = DirtyRanges.Last();
+		if (Last.Attributes == Attributes && Start <= Last.End && Start + Count >= Last.Start)
+		{
+			Last.Start = FMath::Min(Last.Start, Start);
+			Last.End = FMath::Max(Last.End, Start + Count);
+			return;
+		}
+	}
+	DirtyRanges.Add({Start, Start + Count, Attributes});
+}
+
+void USceneBufferAsset::CommitGaussianEdits()
+{
+	check(IsInGameThread());
+	UnpackCookedPayload();
+	if (DirtyRanges.IsEmpty())
+	{
+		return;
+	}
+
+	ESceneGaussianAttributes AllAttributes = ESceneGaussianAttributes::None;
+	for (const FDirtyRange& Range : DirtyRanges)
+	{
+		AllAttributes |= Range.Attributes;
+	}
+	constexpr ESceneGaussianAttributes BoundsAttributes = ESceneGaussianAttributes::PositionOpacity |
+		ESceneGaussianAttributes::Scale | ESceneGaussianAttributes::Rotation;
+	if (EnumHasAnyFlags(AllAttributes, BoundsAttributes))
+	{
+		ResetBVH();
+
+		// Chunk 的 SplatBounds 必须包含编辑后的高斯，否则遮挡剔除可能错误地剔除整个 Chunk
+		TArray<int32> DirtyChunks;
+		for (const FDirtyRange& Range : DirtyRanges)
+		{
+			if (EnumHasAnyFlags(Range.Attributes, BoundsAttributes) && !Chunks.IsEmpty())
+			{
+				for (int32 ChunkIndex = Range.Start / FSceneChunk::MaxGaussians;
+				     ChunkIndex <= (Range.End - 1) / FSceneChunk::MaxGaussians; ++ChunkIndex)
+				{
+					DirtyChunks.AddUnique(ChunkIndex);
+				}
+			}
+		}
+		ParallelFor(DirtyChunks.Num(), [this, &DirtyChunks](const int32 i)
+		{
+			UpdateChunkSplatBounds(DirtyChunks[i]);
+		});
+	}
+
+	// 还没有上传过的资产在第一次 GetRenderResource 时整体打包，烘焙的数据已经过时
+	if (!RenderResource)
+	{
+		DirtyRanges.Reset();
+		CookedPayload.Reset();
+		return;
+	}
+
+	// 每个属性分别合并重叠的范围，再按 Chunk 切分，每段对应 Slot 中的一段连续内存
+	const TArray<int32>& ChunkSlots = RenderResource->GetResidency_GameThread().ChunkSlots;
+	TArray<FSceneGaussianUpdate> Updates;
+	for (const ESceneGaussianAttributes Attribute : {
+		     ESceneGaussianAttributes::PositionOpacity, ESceneGaussianAttributes::Scale,
+		     ESceneGaussianAttributes::Rotation, ESceneGaussianAttributes::SHCoefficients
+	     })
+	{
+		TArray<FDirtyRange> Ranges;
+		for (const FDirtyRange& Range : DirtyRanges)
+		{
+			if (EnumHasAnyFlags(Range.Attributes, Attribute))
+			{
+				Ranges.Add(Range);
+			}
+		}
+		Algo::SortBy(Ranges, &FDirtyRange::Start);
+
+		for (int32 i = 0; i < Ranges.Num();)
+		{
+			const int32 Start = Ranges[i].Start;
+			int32 End = Ranges[i].End;
+			for (++i; i < Ranges.Num() && Ranges[i].Start <= End; ++i)
+			{
+				End = FMath::Max(End, Ranges[i].End);
+			}
+
+			for (int32 ChunkStart = Start; ChunkStart < End;)
+			{
+				const int32 ChunkIndex = ChunkStart / FSceneChunk::MaxGaussians;
+				const int32 ChunkEnd = FMath::Min(End, (ChunkIndex + 1) * FSceneChunk::MaxGaussians);
+				FSceneGaussianUpdate& Update = Updates.AddDefaulted_GetRef();
+				Update.Start = ChunkStart;
+				Update.Count = ChunkEnd - ChunkStart;
+				Update.Attributes = Attribute;
+				Update.Slot = ChunkSlots.IsValidIndex(ChunkIndex) ? ChunkSlots[ChunkIndex] : INDEX_NONE;
+				if (EnumHasAnyFlags(Attribute, BoundsAttributes))
+				{
+					Update.SplatBounds = Chunks[ChunkIndex].SplatBounds;
+				}
+				ChunkStart = ChunkEnd;
+			}
+		}
+	}
+	DirtyRanges.Reset();
+
+	ParallelFor(Updates.Num(), [this, &Updates](const int32 i)
+	{
+		FSceneGaussianUpdate& Update = Updates[i];
+		Update.Data.PackRange(*this, Update.Start, Update.Count, Update.Attributes);
+	});
+
+	// 流送管理器的上传命令也按 GT 上的驻留状态排队，所以 RT 执行到这里时 Slot 仍然有效
+	ENQUEUE_RENDER_COMMAND(UpdateSceneGaussians)(
+		[Resource = RenderResource, Updates = MoveTemp(Updates)](FRHICommandListImmediate& RHICmdList) mutable
+		{
+			if (Resource->IsInitialized())
+			{
+				Resource->UpdateGaussians_RenderThread(RHICmdList, Updates);
+			}
+		});
+}
+
+TSharedPtr<const FSceneBVH, ESPMode::ThreadSafe> USceneBufferAsset::GetBVH()
+{
+	FScopeLock Lock(&BVHCriticalSection);
+	if (!BVH && GaussianCount > 0)
+	{
+		UnpackCookedPayload();
+		const double StartTime = FPlatformTime::Seconds();
+		BVH = MakeShared<const FSceneBVH, ESPMode::ThreadSafe>(*this);
+		UE_LOG(LogTemp, Log, TEXT("Built BVH of %s (%.2f MB) in %.2f ms."), *GetName(),
+		       BVH->GetAllocatedSize() / (1024.0 * 1024.0), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+	}
+	return BVH;
+}
+
+void USceneBufferAsset::ResetBVH()
+{
+	FScopeLock Lock(&BVHCriticalSection);
+	BVH.Reset();
+}
+
+void USceneBufferAsset::BuildChunks(TArray<uint32>* OutOrder)
+{
+	const int32 Count = GaussianCount;
+	Chunks.Reset();
+	if (Count == 0)
+	{
+		return;
+	}
+
+	// 按 Morton 码排序，空间上相邻的高斯在数组中也相邻
+	FBox Bounds(GaussianPositions.GetData(), Count);
+	const FVector Extent = (Bounds.Max - Bounds.Min).ComponentMax(FVector(UE_DOUBLE_SMALL_NUMBER));
+	TArray<uint64> Keys;
+	Keys.SetNumUninitialized(Count);
+	ParallelFor(Count, [&](const int32 i)
+	{
+		const FVector Normalized = (GaussianPositions[i] - Bounds.Min) / Extent;
+		const uint64 X = FMath::Clamp<uint64>(Normalized.X * 0x1fffff, 0, 0x1fffff);
+		const uint64 Y = FMath::Clamp<uint64>(Normalized.Y * 0x1fffff, 0, 0x1fffff);
+		const uint64 Z = FMath::Clamp<uint64>(Normalized.Z * 0x1fffff, 0, 0x1fffff);
+		Keys[i] = SpreadBits(X) | SpreadBits(Y) << 1 | SpreadBits(Z) << 2;
+	});
+
+	TArray<uint32> Order;
+	Order.SetNumUninitialized(Count);
+	for (int32 i = 0; i < Count; ++i)
+	{
+		Order[i] = i;
+	}
+	Algo::Sort(Order, [&Keys](const uint32 A, const uint32 B)
+	{
+		return Keys[A] < Keys[B];
+	});
+
+	Permute(GaussianPositions, Order);
+	Permute(GaussianScales, Order);
+	Permute(GaussianRotations, Order);
+	Permute(GaussianOpacities, Order);
+	Permute(GaussianSHCoefficients, Order, SHCoefficientsCount);
+	if (OutOrder)
+	{
+		*OutOrder = Order;
+	}
+
+	// 划分为固定大小的 Chunk，并统计包围盒和重要性
+	const int32 NumChunks = FMath::DivideAndRoundUp(Count, FSceneChunk::MaxGaussians);
+	Chunks.SetNum(NumChunks);
+	ParallelFor(NumChunks, [this, Count](const int32 ChunkIndex)
+	{
+		FSceneChunk& Chunk = Chunks[ChunkIndex];
+		Chunk.Start = ChunkIndex * FSceneChunk::MaxGaussians;
+		Chunk.Count = FMath::Min(FSceneChunk::MaxGaussians, Count - Chunk.Start);
+		Chunk.Bounds = FBox(&GaussianPositions[Chunk.Start], Chunk.Count);
+		UpdateChunkSplatBounds(ChunkIndex);
+
+		double Importance = 0.0;
+		for (int32 i = Chunk.Start; i < Chunk.Start + Chunk.Count; ++i)
+		{
+			Importance += GaussianOpacities[i] * FMath::Square(GaussianScales[i].GetMax());
+		}
+		Chunk.Importance = Importance;
+	});
+}
+
+void USceneBufferAsset::UpdateChunkSplatBounds(const int32 ChunkIndex)
+{
+	FSceneChunk& Chunk = Chunks[ChunkIndex];
+	FBox SplatBounds(ForceInit);
+	for (int32 i = Chunk.Start; i < Chunk.Start + Chunk.Count; ++i)
+	{
+		const FVector Extent = FSceneBVH::GetGaussianExtent(GaussianRotations[i], GaussianScales[i]);
+		SplatBounds += FBox(GaussianPositions[i] - Extent, GaussianPositions[i] + Extent);
+	}
+	Chunk.SplatBounds = SplatBounds;
+}
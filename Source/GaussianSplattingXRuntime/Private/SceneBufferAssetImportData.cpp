@@ -0,0 +1,47 @@
+﻿#include "SceneBufferAssetImportData.h"
+
+#include "HAL/FileManager.h"
+
+#if WITH_EDITORONLY_DATA
+void USceneBufferAssetImportData::UpdateSourceFile(const FString& AbsoluteFilename, const FMD5Hash& Hash)
+{
+	FMD5Hash FileHash = Hash;
+	if (!FileHash.IsValid())
+	{
+		FileHash = FMD5Hash::HashFile(*AbsoluteFilename);
+	}
+
+	Update(AbsoluteFilename, &FileHash);
+	SourceFileSize = IFileManager::Get().FileSize(*AbsoluteFilename);
+}
+
+bool USceneBufferAssetImportData::IsSourceFileUnchanged(const FString& AbsoluteFilename, FMD5Hash& OutHash) const
+{
+	if (SourceData.SourceFiles.Num() != 1)
+	{
+		return false;
+	}
+	const FAssetImportInfo::FSourceFile& SourceFile = SourceData.SourceFiles[0];
+
+	// 路径不同说明是另一个文件，只是名字相同
+	const FString RecordedFilename = FPaths::ConvertRelativePathToFull(ResolveImportFilename(SourceFile.RelativeFilename));
+	if (!FPaths::IsSamePath(RecordedFilename, AbsoluteFilename))
+	{
+		return false;
+	}
+
+	const int64 FileSize = IFileManager::Get().FileSize(*AbsoluteFilename);
+	if (FileSize < 0 || FileSize != SourceFileSize)
+	{
+		return false;
+	}
+
+	if (IFileManager::Get().GetTimeStamp(*AbsoluteFilename) == SourceFile.Timestamp)
+	{
+		return true;
+	}
+
+	OutHash = FMD5Hash::HashFile(*AbsoluteFilename);
+	return OutHash.IsValid() && OutHash == SourceFile.FileHash;
+}
+#endif
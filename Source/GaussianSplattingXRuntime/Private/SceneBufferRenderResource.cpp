@@ -0,0 +1,644 @@
+﻿#include "SceneBufferRenderResource.h"
+
+#include "Async/ParallelFor.h"
+#include "Misc/ScopeRWLock.h"
+#include "RenderGraphBuilder.h"
+#include "RenderGraphUtils.h"
+#include "RenderingThread.h"
+#include "SceneBufferAsset.h"
+
+namespace
+{
+	/// 每个并行任务打包的高斯数量
+	constexpr int64 PackBatchSize = 4096;
+
+	/// 在一次锁定中把打包好的数据整块拷贝到 Buffer 的开头
+	void InitializeBuffer(FRHICommandListBase& RHICmdList, const FSceneGaussianBuffer& Buffer, const TArray<FVector4f>& Data)
+	{
+		if (Data.IsEmpty() || !Buffer.Buffer)
+		{
+			return;
+		}
+
+		check(Data.Num() * sizeof(FVector4f) <= Buffer.NumBytes);
+		const uint32 Size = Data.Num() * sizeof(FVector4f);
+		void* MappedData = RHICmdList.LockBuffer(Buffer.Buffer, 0, Size, RLM_WriteOnly);
+		FMemory::Memcpy(MappedData, Data.GetData(), Size);
+		RHICmdList.UnlockBuffer(Buffer.Buffer);
+	}
+
+	/// 把 Source 中从 SourceIndex 开始的 Count 个元素上传到 Buffer 的 DestIndex 处，只锁定这段范围
+	void UploadRange(FRHICommandListBase& RHICmdList, const FSceneGaussianBuffer& Buffer, const TArray<FVector4f>& Source,
+	                 const int64 SourceIndex, const int64 DestIndex, const int64 Count)
+	{
+		if (!Buffer.Buffer || Count == 0)
+		{
+			return;
+		}
+		const uint32 Size = Count * sizeof(FVector4f);
+		void* MappedData = RHICmdList.LockBuffer(Buffer.Buffer, DestIndex * sizeof(FVector4f), Size, RLM_WriteOnly);
+		FMemory::Memcpy(MappedData, &Source[SourceIndex], Size);
+		RHICmdList.UnlockBuffer(Buffer.Buffer);
+	}
+
+	/// 旧的打包方式：每个元素调用一次 TFunction，只用于性能对比
+	template <typename TBufferElementType>
+	void FillPerElement(TArray<TBufferElementType>& MappedData, const int64 BufferElementCount,
+	                    TFunction<void(size_t Index, TBufferElementType& MappedData)> FillFunction)
+	{
+		MappedData.SetNumUninitialized(BufferElementCount);
+		for (int64 i = 0; i < BufferElementCount; ++i)
+		{
+			FillFunction(i, MappedData[i]);
+		}
+	}
+
+	/// GaussianSplattingX.BenchmarkBufferPacking <SceneBufferAsset 路径> [迭代次数]
+	void BenchmarkBufferPacking(const TArray<FString>& Args)
+	{
+		if (Args.IsEmpty())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Usage: GaussianSplattingX.BenchmarkBufferPacking <SceneBufferAssetPath> [Iterations]"));
+			return;
+		}
+
+		USceneBufferAsset* Scene = LoadObject<USceneBufferAsset>(nullptr, *Args[0]);
+		if (!Scene)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Failed to load SceneBufferAsset: %s"), *Args[0]);
+			return;
+		}
+		Scene->UnpackCookedPayload();
+		const int32 Iterations = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 5;
+
+		// 逐元素回调，和原来 InitializeBuffer 的写法一致，只是写到 CPU 内存中，不包含 GPU 上传的耗时
+		double PerElementSeconds = 0.0;
+		for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+		{
+			TArray<FVector4f> PositionOpacity, Scale, SHCoefficients;
+			TArray<FQuat4f> Rotation;
+
+			const double StartTime = FPlatformTime::Seconds();
+			FillPerElement<FVector4f>(PositionOpacity, Scene->GaussianCount,
+			                          [Scene](const size_t Index, FVector4f& MappedData)
+			                          {
+				                          const FVector& Position = Scene->GaussianPositions[Index];
+				                          MappedData = FVector4f(Position.X, Position.Y, Position.Z,
+				                                                 Scene->GaussianOpacities[Index]);
+			                          });
+			FillPerElement<FVector4f>(SHCoefficients,
+			                          static_cast<int64>(Scene->GaussianCount) * Scene->SHCoefficientsCount,
+			                          [Scene](const size_t Index, FVector4f& MappedData)
+			                          {
+				                          const FVector& SH = Scene->GaussianSHCoefficients[Index];
+				                          MappedData = FVector4f(SH.X, SH.Y, SH.Z, 1.0f);
+			                          });
+			FillPerElement<FQuat4f>(Rotation, Scene->GaussianCount,
+			                        [Scene](const size_t Index, FQuat4f& MappedData)
+			                        {
+				                        MappedData = FQuat4f(Scene->GaussianRotations[Index]);
+			                        });
+			FillPerElement<FVector4f>(Scale, Scene->GaussianCount,
+			                          [Scene](const size_t Index, FVector4f& MappedData)
+			                          {
+				                          const FVector& GaussianScale = Scene->GaussianScales[Index];
+				                          MappedData = FVector4f(GaussianScale.X, GaussianScale.Y, GaussianScale.Z, 1.0f);
+			                          });
+			PerElementSeconds += FPlatformTime::Seconds() - StartTime;
+		}
+
+		// 打包之后在 RT 上创建 Buffer 并整块上传，和资产第一次创建 RenderResource 时的路径一致
+		// 上传的耗时包括分配 Buffer 和锁定拷贝，不包括 GPU 上异步执行的拷贝
+		double PackSeconds = 0.0;
+		double UploadSeconds = 0.0;
+		SIZE_T PayloadSize = 0;
+		for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+		{
+			FSceneGPUPayload Payload;
+
+			const double StartTime = FPlatformTime::Seconds();
+			Payload.Pack(*Scene);
+			PackSeconds += FPlatformTime::Seconds() - StartTime;
+			PayloadSize = Payload.GetAllocatedSize();
+
+			if (Scene->Chunks.IsEmpty())
+			{
+				continue;
+			}
+			TSharedPtr<FSceneBufferRenderResource, ESPMode::ThreadSafe> Resource = MakeShared<
+				FSceneBufferRenderResource, ESPMode::ThreadSafe>(MoveTemp(Payload), Scene->Chunks, Scene->Chunks.Num(),
+				                                                 true);
+			ENQUEUE_RENDER_COMMAND(BenchmarkSceneBufferUpload)(
+				[Resource, &UploadSeconds](FRHICommandListImmediate& RHICmdList)
+				{
+					const double UploadStartTime = FPlatformTime::Seconds();
+					Resource->InitResource(RHICmdList);
+					UploadSeconds += FPlatformTime::Seconds() - UploadStartTime;
+					Resource->ReleaseResource();
+				});
+			FlushRenderingCommands();
+		}
+
+		PerElementSeconds /= Iterations;
+		PackSeconds /= Iterations;
+		UploadSeconds /= Iterations;
+		const double PayloadMB = PayloadSize / (1024.0 * 1024.0);
+		UE_LOG(LogTemp, Display,
+		       TEXT("Buffer packing for %s (%u Gaussians, %.2f MB, %d iterations): per-element %.2f ms (%.0f MB/s), parallel bulk %.2f ms (%.0f MB/s), %.1fx faster"),
+		       *Scene->GetName(), Scene->GaussianCount, PayloadMB, Iterations,
+		       PerElementSeconds * 1000.0, PayloadMB / FMath::Max(PerElementSeconds, UE_DOUBLE_SMALL_NUMBER),
+		       PackSeconds * 1000.0, PayloadMB / FMath::Max(PackSeconds, UE_DOUBLE_SMALL_NUMBER),
+		       PerElementSeconds / FMath::Max(PackSeconds, UE_DOUBLE_SMALL_NUMBER));
+		UE_LOG(LogTemp, Display,
+		       TEXT("Buffer upload for %s: create and upload on the render thread %.2f ms (%.0f MB/s), pack + upload %.2f ms"),
+		       *Scene->GetName(), UploadSeconds * 1000.0,
+		       PayloadMB / FMath::Max(UploadSeconds, UE_DOUBLE_SMALL_NUMBER), (PackSeconds + UploadSeconds) * 1000.0);
+	}
+
+	FAutoConsoleCommand BenchmarkBufferPackingCommand(
+		TEXT("GaussianSplattingX.BenchmarkBufferPacking"),
+		TEXT("Compare the per-element callback buffer packing with the parallel bulk packing, then time creating the ")
+		TEXT("GPU buffers and uploading the packed payload on the render thread. ")
+		TEXT("Usage: GaussianSplattingX.BenchmarkBufferPacking <SceneBufferAssetPath> [Iterations]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkBufferPacking));
+}
+
+// =============================== FSceneGPUPayload ===============================
+
+void FSceneGPUPayload::Pack(const USceneBufferAsset& Scene, const int32 MaxSHCoefficientsCount)
+{
+	GaussianCount = Scene.GaussianCount;
+	SHCoefficientsCount = FMath::Min<uint32>(Scene.SHCoefficientsCount, FMath::Max(MaxSHCoefficientsCount, 0));
+
+	const int64 Count = GaussianCount;
+	const int64 SHCount = SHCoefficientsCount;
+	const int64 SourceSHCount = Scene.SHCoefficientsCount;
+	PositionOpacity.SetNumUninitialized(Count);
+	Scale.SetNumUninitialized(Count);
+	Rotation.SetNumUninitialized(Count);
+	SHCoefficients.SetNumUninitialized(Count * SHCount);
+
+	// 每批处理连续的一段高斯，循环体只有类型转换，没有间接调用
+	const int32 NumBatches = static_cast<int32>((Count + PackBatchSize - 1) / PackBatchSize);
+	ParallelFor(NumBatches, [&](const int32 BatchIndex)
+	{
+		const int64 Begin = BatchIndex * PackBatchSize;
+		const int64 End = FMath::Min(Begin + PackBatchSize, Count);
+
+		const FVector* SourcePositions = Scene.GaussianPositions.GetData();
+		const float* SourceOpacities = Scene.GaussianOpacities.GetData();
+		FVector4f* DestPositionOpacity = PositionOpacity.GetData();
+		for (int64 i = Begin; i < End; ++i)
+		{
+			DestPositionOpacity[i] = FVector4f(SourcePositions[i].X, SourcePositions[i].Y, SourcePositions[i].Z,
+			                                   SourceOpacities[i]);
+		}
+
+		const FVector* SourceScales = Scene.GaussianScales.GetData();
+		FVector4f* DestScale = Scale.GetData();
+		for (int64 i = Begin; i < End; ++i)
+		{
+			DestScale[i] = FVector4f(SourceScales[i].X, SourceScales[i].Y, SourceScales[i].Z, 1.0f);
+		}
+
+		const FQuat* SourceRotations = Scene.GaussianRotations.GetData();
+		FVector4f* DestRotation = Rotation.GetData();
+		for (int64 i = Begin; i < End; ++i)
+		{
+			DestRotation[i] = FVector4f(SourceRotations[i].X, SourceRotations[i].Y, SourceRotations[i].Z,
+			                            SourceRotations[i].W);
+		}
+
+		const FVector* SourceSH = Scene.GaussianSHCoefficients.GetData();
+		FVector4f* DestSH = SHCoefficients.GetData();
+		if (SHCount == SourceSHCount)
+		{
+			for (int64 i = Begin * SHCount; i < End * SHCount; ++i)
+			{
+				DestSH[i] = FVector4f(SourceSH[i].X, SourceSH[i].Y, SourceSH[i].Z, 1.0f);
+			}
+		}
+		else
+		{
+			// 只保留每个高斯的低阶系数
+			for (int64 i = Begin; i < End; ++i)
+			{
+				for (int64 j = 0; j < SHCount; ++j)
+				{
+					const FVector& SH = SourceSH[i * SourceSHCount + j];
+					DestSH[i * SHCount + j] = FVector4f(SH.X, SH.Y, SH.Z, 1.0f);
+				}
+			}
+		}
+	});
+}
+
+void FSceneGPUPayload::Unpack(USceneBufferAsset& Scene) const
+{
+	Scene.SHCoefficientsCount = SHCoefficientsCount;
+	Scene.SetGaussianCount(GaussianCount);
+
+	const int64 Count = GaussianCount;
+	const int64 SHCount = SHCoefficientsCount;
+	const int32 NumBatches = static_cast<int32>((Count + PackBatchSize - 1) / PackBatchSize);
+	ParallelFor(NumBatches, [&](const int32 BatchIndex)
+	{
+		const int64 Begin = BatchIndex * PackBatchSize;
+		const int64 End = FMath::Min(Begin + PackBatchSize, Count);
+		for (int64 i = Begin; i < End; ++i)
+		{
+			const FVector4f& Source = PositionOpacity[i];
+			Scene.GaussianPositions[i] = FVector(Source.X, Source.Y, Source.Z);
+			Scene.GaussianOpacities[i] = Source.W;
+			Scene.GaussianScales[i] = FVector(Scale[i].X, Scale[i].Y, Scale[i].Z);
+			Scene.GaussianRotations[i] = FQuat(Rotation[i].X, Rotation[i].Y, Rotation[i].Z, Rotation[i].W);
+		}
+		for (int64 i = Begin * SHCount; i < End * SHCount; ++i)
+		{
+			Scene.GaussianSHCoefficients[i] = FVector(SHCoefficients[i].X, SHCoefficients[i].Y, SHCoefficients[i].Z);
+		}
+	});
+}
+
+void FSceneGPUPayload::PackRange(const USceneBufferAsset& Scene, const int32 Start, const int32 Count,
+                                 const ESceneGaussianAttributes Attributes)
+{
+	check(Start >= 0 && Start + Count <= static_cast<int32>(Scene.GaussianCount));
+	GaussianCount = Count;
+	SHCoefficientsCount = Scene.SHCoefficientsCount;
+
+	if (EnumHasAnyFlags(Attributes, ESceneGaussianAttributes::PositionOpacity))
+	{
+		PositionOpacity.SetNumUninitialized(Count);
+		for (int32 i = 0; i < Count; ++i)
+		{
+			const FVector& Position = Scene.GaussianPositions[Start + i];
+			PositionOpacity[i] = FVector4f(Position.X, Position.Y, Position.Z, Scene.GaussianOpacities[Start + i]);
+		}
+	}
+
+	if (EnumHasAnyFlags(Attributes, ESceneGaussianAttributes::Scale))
+	{
+		Scale.SetNumUninitialized(Count);
+		for (int32 i = 0; i < Count; ++i)
+		{
+			const FVector& GaussianScale = Scene.GaussianScales[Start + i];
+			Scale[i] = FVector4f(GaussianScale.X, GaussianScale.Y, GaussianScale.Z, 1.0f);
+		}
+	}
+
+	if (EnumHasAnyFlags(Attributes, ESceneGaussianAttributes::Rotation))
+	{
+		Rotation.SetNumUninitialized(Count);
+		for (int32 i = 0; i < Count; ++i)
+		{
+			const FQuat& GaussianRotation = Scene.GaussianRotations[Start + i];
+			Rotation[i] = FVector4f(GaussianRotation.X, GaussianRotation.Y, GaussianRotation.Z, GaussianRotation.W);
+		}
+	}
+
+	if (EnumHasAnyFlags(Attributes, ESceneGaussianAttributes::SHCoefficients))
+	{
+		const int64 SHCount = SHCoefficientsCount;
+		SHCoefficients.SetNumUninitialized(Count * SHCount);
+		const FVector* SourceSH = &Scene.GaussianSHCoefficients[Start * SHCount];
+		for (int64 i = 0; i < Count * SHCount; ++i)
+		{
+			SHCoefficients[i] = FVector4f(SourceSH[i].X, SourceSH[i].Y, SourceSH[i].Z, 1.0f);
+		}
+	}
+}
+
+SIZE_T FSceneGPUPayload::GetAllocatedSize() const
+{
+	return PositionOpacity.GetAllocatedSize() + Scale.GetAllocatedSize() + Rotation.GetAllocatedSize() +
+		SHCoefficients.GetAllocatedSize();
+}
+
+void FSceneGPUPayload::Serialize(FArchive& Ar)
+{
+	Ar << GaussianCount;
+	Ar << SHCoefficientsCount;
+	PositionOpacity.BulkSerialize(Ar);
+	Scale.BulkSerialize(Ar);
+	Rotation.BulkSerialize(Ar);
+	SHCoefficients.BulkSerialize(Ar);
+}
+
+// =============================== FSceneGaussianBuffer ===============================
+
+void FSceneGaussianBuffer::Initialize(FRHICommandListBase& RHICmdList, const TCHAR* Name, const uint32 BytesPerElement,
+                                      const uint32 NumElements, const EPixelFormat InFormat)
+{
+	// 池中的 Buffer 由 RDG 跟踪资源状态，注册到图中之后不需要手动转换
+	PooledBuffer = AllocatePooledBuffer(FRDGBufferDesc::CreateBufferDesc(BytesPerElement, NumElements), Name);
+	Buffer = PooledBuffer->GetRHI();
+	SRV = RHICmdList.CreateShaderResourceView(
+		Buffer, FRHIViewDesc::CreateBufferSRV().SetType(FRHIViewDesc::EBufferType::Typed).SetFormat(InFormat));
+	NumBytes = BytesPerElement * NumElements;
+	Format = InFormat;
+}
+
+void FSceneGaussianBuffer::Release()
+{
+	SRV.SafeRelease();
+	Buffer.SafeRelease();
+	PooledBuffer.SafeRelease();
+	NumBytes = 0;
+}
+
+FRDGBufferSRVRef FSceneGaussianBuffer::Register(FRDGBuilder& GraphBuilder) const
+{
+	if (!PooledBuffer)
+	{
+		return nullptr;
+	}
+	return GraphBuilder.CreateSRV(GraphBuilder.RegisterExternalBuffer(PooledBuffer), Format);
+}
+
+// =============================== FSceneBufferRenderResource ===============================
+
+FSceneBufferRenderResource::FSceneBufferRenderResource(FSceneGPUPayload&& InPayload,
+                                                       const TArray<FSceneChunk>& InChunks, const int32 InSlotCount,
+                                                       const bool bInInitiallyResident)
+	: Payload(MoveTemp(InPayload))
+	  , Chunks(InChunks)
+	  , GaussianCount(Payload.GaussianCount)
+	  , SHCoefficientsCount(Payload.SHCoefficientsCount)
+	  , SlotCount(InSlotCount)
+	  , bInitiallyResident(bInInitiallyResident)
+	  , DataVersion(AllocateDataVersion())
+{
+	check(!bInitiallyResident || SlotCount == Chunks.Num());
+
+	Residency.SlotChunks.Init(INDEX_NONE, SlotCount);
+	Residency.ChunkSlots.Init(INDEX_NONE, Chunks.Num());
+	if (bInitiallyResident)
+	{
+		for (int32 ChunkIndex = 0; ChunkIndex < Chunks.Num(); ++ChunkIndex)
+		{
+			Residency.SlotChunks[ChunkIndex] = ChunkIndex;
+			Residency.ChunkSlots[ChunkIndex] = ChunkIndex;
+		}
+	}
+}
+
+void FSceneBufferRenderResource::InitRHI(FRHICommandListBase& RHICmdList)
+{
+	CreateBuffers(RHICmdList);
+
+	if (bInitiallyResident)
+	{
+		// 所有 Chunk 按顺序放在对应的 Slot 中，和打包数据的布局完全一致，每个 Buffer 一次拷贝完成
+		InitializeBuffer(RHICmdList, PositionOpacityBuffer, Payload.PositionOpacity);
+		InitializeBuffer(RHICmdList, ScaleBuffer, Payload.Scale);
+		InitializeBuffer(RHICmdList, RotationBuffer, Payload.Rotation);
+		InitializeBuffer(RHICmdList, SHCoefficientsBuffer, Payload.SHCoefficients);
+
+		TArray<uint32> ResidentSlots;
+		for (int32 Slot = 0; Slot < SlotCount; ++Slot)
+		{
+			ResidentSlots.Add(Slot);
+			UploadSlotBounds_RenderThread(RHICmdList, Slot, Slot);
+		}
+		UpdateSlotTable_RenderThread(RHICmdList, ResidentSlots, GaussianCount);
+	}
+}
+
+void FSceneBufferRenderResource::ReleaseRHI()
+{
+	PositionOpacityBuffer.Release();
+	ScaleBuffer.Release();
+	RotationBuffer.Release();
+	SHCoefficientsBuffer.Release();
+	SlotTableBuffer.Release();
+	SlotBoundsBuffer.Release();
+	ResidentGaussianCount = 0;
+}
+
+FString FSceneBufferRenderResource::GetFriendlyName() const
+{
+	return TEXT("FSceneBufferRenderResource");
+}
+
+int64 FSceneBufferRenderResource::GetSlotBytes() const
+{
+	return static_cast<int64>(FSceneChunk::MaxGaussians) * sizeof(FVector4f) * (3 + SHCoefficientsCount) +
+		sizeof(uint32) + sizeof(FVector4f) * 2;
+}
+
+uint32 FSceneBufferRenderResource::AllocateDataVersion()
+{
+	static std::atomic<uint32> NextDataVersion = 1;
+	return NextDataVersion.fetch_add(1, std::memory_order_relaxed);
+}
+
+void FSceneBufferRenderResource::ResizePool_RenderThread(FRHICommandListImmediate& RHICmdList,
+                                                          const int32 NewSlotCount, const TArray<int32>& SlotRemap)
+{
+	check(IsInRenderingThread() && SlotRemap.Num() == NewSlotCount);
+
+	// 旧的 Buffer 在拷贝完成之前不能释放
+	const FSceneGaussianBuffer OldPositionOpacityBuffer = PositionOpacityBuffer;
+	const FSceneGaussianBuffer OldScaleBuffer = ScaleBuffer;
+	const FSceneGaussianBuffer OldRotationBuffer = RotationBuffer;
+	const FSceneGaussianBuffer OldSHCoefficientsBuffer = SHCoefficientsBuffer;
+	const FSceneGaussianBuffer OldSlotBoundsBuffer = SlotBoundsBuffer;
+
+	ReleaseRHI();
+	SlotCount = NewSlotCount;
+	bInitiallyResident = false;
+	CreateBuffers(RHICmdList);
+	DataVersion = AllocateDataVersion();
+
+	if (SlotCount == 0 || !OldPositionOpacityBuffer.PooledBuffer)
+	{
+		return;
+	}
+
+	FRDGBuilder GraphBuilder(RHICmdList);
+	const auto CopySlots = [&GraphBuilder, &SlotRemap](const FSceneGaussianBuffer& Source,
+	                                                   const FSceneGaussianBuffer& Dest, const uint64 BytesPerSlot)
+	{
+		if (!Source.PooledBuffer || !Dest.PooledBuffer || BytesPerSlot == 0)
+		{
+			return;
+		}
+		const FRDGBufferRef SourceBuffer = GraphBuilder.RegisterExternalBuffer(Source.PooledBuffer);
+		const FRDGBufferRef DestBuffer = GraphBuilder.RegisterExternalBuffer(Dest.PooledBuffer);
+
+		// 新旧 Slot 都连续的一段合并成一次拷贝
+		for (int32 Slot = 0; Slot < SlotRemap.Num();)
+		{
+			const int32 OldSlot = SlotRemap[Slot];
+			int32 Count = 1;
+			if (OldSlot == INDEX_NONE)
+			{
+				++Slot;
+				continue;
+			}
+			while (Slot + Count < SlotRemap.Num() && SlotRemap[Slot + Count] == OldSlot + Count)
+			{
+				++Count;
+			}
+			AddCopyBufferPass(GraphBuilder, DestBuffer, Slot * BytesPerSlot, SourceBuffer, OldSlot * BytesPerSlot,
+			                  Count * BytesPerSlot);
+			Slot += Count;
+		}
+
+		// Niagara 在图外直接绑定 SRV
+		GraphBuilder.SetBufferAccessFinal(DestBuffer, ERHIAccess::SRVMask);
+	};
+
+	const uint64 BytesPerSlot = static_cast<uint64>(FSceneChunk::MaxGaussians) * sizeof(FVector4f);
+	CopySlots(OldPositionOpacityBuffer, PositionOpacityBuffer, BytesPerSlot);
+	CopySlots(OldScaleBuffer, ScaleBuffer, BytesPerSlot);
+	CopySlots(OldRotationBuffer, RotationBuffer, BytesPerSlot);
+	CopySlots(OldSHCoefficientsBuffer, SHCoefficientsBuffer, BytesPerSlot * SHCoefficientsCount);
+	CopySlots(OldSlotBoundsBuffer, SlotBoundsBuffer, sizeof(FVector4f) * 2);
+	GraphBuilder.Execute();
+}
+
+void FSceneBufferRenderResource::UploadChunk_RenderThread(FRHICommandListBase& RHICmdList, const int32 ChunkIndex,
+                                                          const int32 Slot)
+{
+	check(IsInRenderingThread() && Slot < SlotCount);
+	const FSceneChunk& Chunk = Chunks[ChunkIndex];
+
+	const int64 SlotStart = static_cast<int64>(Slot) * FSceneChunk::MaxGaussians;
+	UploadRange(RHICmdList, PositionOpacityBuffer, Payload.PositionOpacity, Chunk.Start, SlotStart, Chunk.Count);
+	UploadRange(RHICmdList, ScaleBuffer, Payload.Scale, Chunk.Start, SlotStart, Chunk.Count);
+	UploadRange(RHICmdList, RotationBuffer, Payload.Rotation, Chunk.Start, SlotStart, Chunk.Count);
+	UploadRange(RHICmdList, SHCoefficientsBuffer, Payload.SHCoefficients, Chunk.Start * SHCoefficientsCount,
+	            SlotStart * SHCoefficientsCount, Chunk.Count * SHCoefficientsCount);
+	UploadSlotBounds_RenderThread(RHICmdList, ChunkIndex, Slot);
+}
+
+void FSceneBufferRenderResource::UpdateGaussians_RenderThread(FRHICommandListBase& RHICmdList,
+                                                              TArray<FSceneGaussianUpdate>& Updates)
+{
+	check(IsInRenderingThread());
+	const int64 SHCount = SHCoefficientsCount;
+
+	// 先更新 CPU 上的数据，之后流送这个 Chunk 时上传的就是编辑后的数据，VM 在读锁中读取，不会读到一半更新的数据
+	{
+		const auto CopyToPayload = [](TArray<FVector4f>& Dest, const TArray<FVector4f>& Source, const int64 DestIndex)
+		{
+			if (!Source.IsEmpty())
+			{
+				FMemory::Memcpy(&Dest[DestIndex], Source.GetData(), Source.Num() * sizeof(FVector4f));
+			}
+		};
+		FWriteScopeLock Lock(PayloadLock);
+		for (const FSceneGaussianUpdate& Update : Updates)
+		{
+			check(Update.Start + Update.Count <= static_cast<int32>(GaussianCount));
+			CopyToPayload(Payload.PositionOpacity, Update.Data.PositionOpacity, Update.Start);
+			CopyToPayload(Payload.Scale, Update.Data.Scale, Update.Start);
+			CopyToPayload(Payload.Rotation, Update.Data.Rotation, Update.Start);
+			CopyToPayload(Payload.SHCoefficients, Update.Data.SHCoefficients, Update.Start * SHCount);
+		}
+	}
+
+	for (const FSceneGaussianUpdate& Update : Updates)
+	{
+		const FSceneGPUPayload& Data = Update.Data;
+		const int32 ChunkIndex = Update.Start / FSceneChunk::MaxGaussians;
+		if (Update.SplatBounds.IsValid)
+		{
+			Chunks[ChunkIndex].SplatBounds = Update.SplatBounds;
+		}
+
+		// 只有提交时驻留的 Chunk 需要上传，Slot 在提交之后被重新分配时流送会上传 Payload 中的新数据
+		if (Update.Slot == INDEX_NONE || Update.Slot >= SlotCount)
+		{
+			continue;
+		}
+		if (Update.SplatBounds.IsValid)
+		{
+			UploadSlotBounds_RenderThread(RHICmdList, ChunkIndex, Update.Slot);
+		}
+		const int32 ChunkStart = ChunkIndex * FSceneChunk::MaxGaussians;
+		const int64 DestIndex = static_cast<int64>(Update.Slot) * FSceneChunk::MaxGaussians + Update.Start - ChunkStart;
+		UploadRange(RHICmdList, PositionOpacityBuffer, Data.PositionOpacity, 0, DestIndex, Data.PositionOpacity.Num());
+		UploadRange(RHICmdList, ScaleBuffer, Data.Scale, 0, DestIndex, Data.Scale.Num());
+		UploadRange(RHICmdList, RotationBuffer, Data.Rotation, 0, DestIndex, Data.Rotation.Num());
+		UploadRange(RHICmdList, SHCoefficientsBuffer, Data.SHCoefficients, 0, DestIndex * SHCount,
+		            Data.SHCoefficients.Num());
+	}
+	DataVersion = AllocateDataVersion();
+}
+
+void FSceneBufferRenderResource::UpdateSlotTable_RenderThread(FRHICommandListBase& RHICmdList,
+                                                              const TArray<uint32>& ResidentSlots,
+                                                              const uint32 InResidentGaussianCount)
+{
+	check(IsInRenderingThread() && ResidentSlots.Num() <= SlotCount);
+	if (!SlotTableBuffer.Buffer)
+	{
+		ResidentGaussianCount = 0;
+		return;
+	}
+
+	uint32* MappedData = static_cast<uint32*>(
+		RHICmdList.LockBuffer(SlotTableBuffer.Buffer, 0, SlotTableBuffer.NumBytes, RLM_WriteOnly));
+	FMemory::Memcpy(MappedData, ResidentSlots.GetData(), ResidentSlots.Num() * sizeof(uint32));
+	FMemory::Memzero(MappedData + ResidentSlots.Num(), (SlotCount - ResidentSlots.Num()) * sizeof(uint32));
+	RHICmdList.UnlockBuffer(SlotTableBuffer.Buffer);
+
+	ResidentGaussianCount = InResidentGaussianCount;
+	DataVersion = AllocateDataVersion();
+}
+
+FSceneBufferRenderResource::FResidency& FSceneBufferRenderResource::GetResidency_GameThread()
+{
+	check(IsInGameThread());
+	return Residency;
+}
+
+void FSceneBufferRenderResource::ReportInstance_GameThread(const FTransform& InstanceTransform)
+{
+	check(IsInGameThread());
+	Residency.InstanceTransforms.Add(InstanceTransform);
+}
+
+void FSceneBufferRenderResource::CreateBuffers(FRHICommandListBase& RHICmdList)
+{
+	ResidentGaussianCount = 0;
+	if (SlotCount == 0)
+	{
+		return;
+	}
+
+	const uint32 Capacity = SlotCount * FSceneChunk::MaxGaussians;
+	const auto CreateBuffer = [&RHICmdList](FSceneGaussianBuffer& Buffer, const TCHAR* BufferName,
+	                                        const uint32 NumElements)
+	{
+		Buffer.Initialize(RHICmdList, BufferName, sizeof(FVector4f), NumElements, PF_A32B32G32R32F);
+	};
+	CreateBuffer(PositionOpacityBuffer, TEXT("GaussianPositionOpacityBuffer"), Capacity);
+	CreateBuffer(ScaleBuffer, TEXT("GaussianScaleBuffer"), Capacity);
+	CreateBuffer(RotationBuffer, TEXT("GaussianRotationBuffer"), Capacity);
+	CreateBuffer(SHCoefficientsBuffer, TEXT("GaussianSHCoefficientsBuffer"), Capacity * SHCoefficientsCount);
+	SlotTableBuffer.Initialize(RHICmdList, TEXT("GaussianSlotTableBuffer"), sizeof(uint32), SlotCount, PF_R32_UINT);
+	CreateBuffer(SlotBoundsBuffer, TEXT("GaussianSlotBoundsBuffer"), SlotCount * 2);
+}
+
+void FSceneBufferRenderResource::UploadSlotBounds_RenderThread(FRHICommandListBase& RHICmdList, const int32 ChunkIndex,
+                                                               const int32 Slot) const
+{
+	if (!SlotBoundsBuffer.Buffer)
+	{
+		return;
+	}
+
+	// 无效的包围盒写成最小值大于最大值，Shader 中不剔除
+	const FBox& SplatBounds = Chunks[ChunkIndex].SplatBounds;
+	const TArray<FVector4f> Bounds = SplatBounds.IsValid
+		                                 ? TArray<FVector4f>{
+			                                 FVector4f(FVector3f(SplatBounds.Min), 0.0f),
+			                                 FVector4f(FVector3f(SplatBounds.Max), 0.0f)
+		                                 }
+		                                 : TArray<FVector4f>{FVector4f(1.0f), FVector4f(-1.0f)};
+	UploadRange(RHICmdList, SlotBoundsBuffer, Bounds, 0, static_cast<int64>(Slot) * 2, 2);
+}
@@ -0,0 +1,352 @@
+﻿#include "SceneFlythroughTest.h"
+
+#include "EngineUtils.h"
+#include "RHI.h"
+#include "SceneBudgetController.h"
+#include "SceneStreamingManager.h"
+#include "Camera/CameraActor.h"
+#include "Components/SplineComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Misc/App.h"
+#include "Misc/FileHelper.h"
+
+namespace
+{
+	TUniquePtr<FSceneFlythroughTest> FlythroughTest;
+
+	TAutoConsoleVariable<float> CVarFlythroughWarmupSeconds(
+		TEXT("GaussianSplattingX.Flythrough.WarmupSeconds"),
+		2.0f,
+		TEXT("Seconds the camera waits at the start of the spline before recording, so streaming and shader compilation settle."),
+		ECVF_Default);
+
+	TAutoConsoleVariable<float> CVarFlythroughRegressionThreshold(
+		TEXT("GaussianSplattingX.Flythrough.RegressionThreshold"),
+		0.1f,
+		TEXT("Relative increase over the baseline median or P95 that counts as a regression."),
+		ECVF_Default);
+
+	/// 小于这个值的时间差不算回退，避免很短的帧时间因为抖动被误报
+	constexpr float MinRegressionMs = 0.25f;
+
+	constexpr float BytesPerMB = 1024.0f * 1024.0f;
+
+	/// 参与比较的列，时间列同时比较中位数和 P95，内存列比较峰值
+	struct FCompareColumn
+	{
+		const TCHAR* Name;
+		bool bTime;
+	};
+
+	constexpr FCompareColumn CompareColumns[] = {
+		{TEXT("FrameMs"), true},
+		{TEXT("GameThreadMs"), true},
+		{TEXT("RenderThreadMs"), true},
+		{TEXT("GPUMs"), true},
+		{TEXT("PoolMB"), false},
+		{TEXT("UsedPhysicalMB"), false},
+	};
+
+	/// 读取 CSV 中的一列，找不到列时返回 false
+	bool ReadCsvColumn(const TArray<FString>& Lines, const TCHAR* Name, TArray<float>& OutValues)
+	{
+		if (Lines.IsEmpty())
+		{
+			return false;
+		}
+		TArray<FString> Header;
+		Lines[0].ParseIntoArray(Header, TEXT(","));
+		const int32 Column = Header.IndexOfByKey(FString(Name));
+		if (Column == INDEX_NONE)
+		{
+			return false;
+		}
+
+		TArray<FString> Cells;
+		for (int32 Line = 1; Line < Lines.Num(); ++Line)
+		{
+			Lines[Line].ParseIntoArray(Cells, TEXT(","));
+			if (Cells.IsValidIndex(Column))
+			{
+				OutValues.Add(FCString::Atof(*Cells[Column]));
+			}
+		}
+		return !OutValues.IsEmpty();
+	}
+
+	/// 排序后取百分位，Values 会被修改
+	float Percentile(TArray<float>& Values, const float Fraction)
+	{
+		if (Values.IsEmpty())
+		{
+			return 0.0f;
+		}
+		Values.Sort();
+		return Values[FMath::Clamp(FMath::FloorToInt32(Fraction * Values.Num()), 0, Values.Num() - 1)];
+	}
+
+	float Peak(const TArray<float>& Values)
+	{
+		return Values.IsEmpty() ? 0.0f : FMath::Max(Values);
+	}
+
+	void StartFlythrough(const TArray<FString>& Args, UWorld* World)
+	{
+		if (Args.Num() < 3)
+		{
+			UE_LOG(LogTemp, Warning,
+			       TEXT("Usage: GaussianSplattingX.Flythrough <SplineActor> <DurationSeconds> <OutputCsv> [BaselineCsv]"));
+			return;
+		}
+		FSceneFlythroughTest::Start(World, Args[0], FCString::Atof(*Args[1]), Args[2],
+		                            Args.IsValidIndex(3) ? Args[3] : FString());
+	}
+
+	FAutoConsoleCommandWithWorldAndArgs FlythroughCommand(
+		TEXT("GaussianSplattingX.Flythrough"),
+		TEXT("Move the view along a spline actor and record per-frame timings, visible Gaussians and memory to a CSV. ")
+		TEXT("When a baseline CSV is given, medians and P95s are compared against it and regressions are logged as errors. ")
+		TEXT("Usage: GaussianSplattingX.Flythrough <SplineActor> <DurationSeconds> <OutputCsv> [BaselineCsv]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&StartFlythrough));
+}
+
+const TCHAR* FSceneFlythroughTest::CsvHeader =
+	TEXT("Frame,Time,FrameMs,GameThreadMs,RenderThreadMs,GPUMs,VisibleGaussians,PoolMB,UsedPhysicalMB,BudgetQuality");
+
+bool FSceneFlythroughTest::Start(UWorld* World, const FString& SplineActorName, const float DurationSeconds,
+                                 const FString& OutputPath, const FString& BaselinePath)
+{
+	check(IsInGameThread());
+	if (IsRunning())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("A flythrough is already running."));
+		return false;
+	}
+	if (!World || DurationSeconds <= 0.0f || OutputPath.IsEmpty())
+	{
+		UE_LOG(LogTemp, Error, TEXT("Flythrough needs a world, a positive duration and an output path."));
+		return false;
+	}
+
+	USplineComponent* Spline = nullptr;
+	for (TActorIterator<AActor> It(World); It && !Spline; ++It)
+	{
+		if (It->GetName() == SplineActorName || It->GetActorNameOrLabel() == SplineActorName ||
+			It->ActorHasTag(FName(SplineActorName)))
+		{
+			Spline = It->FindComponentByClass<USplineComponent>();
+		}
+	}
+	if (!Spline)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Flythrough could not find an actor named %s with a spline component."),
+		       *SplineActorName);
+		return false;
+	}
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.ObjectFlags = RF_Transient;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	ACameraActor* Camera = World->SpawnActor<ACameraActor>(SpawnParameters);
+	APlayerController* PlayerController = World->GetFirstPlayerController();
+	if (!Camera || !PlayerController)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Flythrough needs a game world with a player controller."));
+		if (Camera)
+		{
+			Camera->Destroy();
+		}
+		return false;
+	}
+
+	FlythroughTest = MakeUnique<FSceneFlythroughTest>();
+	FSceneFlythroughTest& Test = *FlythroughTest;
+	Test.World = World;
+	Test.Spline = Spline;
+	Test.Camera = Camera;
+	Test.PreviousViewTarget = PlayerController->GetViewTarget();
+	Test.DurationSeconds = DurationSeconds;
+	Test.OutputPath = OutputPath;
+	Test.BaselinePath = BaselinePath;
+	Test.Samples.Reserve(FMath::CeilToInt32(DurationSeconds * 120.0f));
+	Test.bRunning = true;
+
+	Test.MoveCamera(0.0f);
+	PlayerController->SetViewTarget(Camera);
+
+	UE_LOG(LogTemp, Display, TEXT("Flythrough along %s for %.1f s, writing %s"), *SplineActorName, DurationSeconds,
+	       *OutputPath);
+	return true;
+}
+
+bool FSceneFlythroughTest::IsRunning()
+{
+	return FlythroughTest && FlythroughTest->bRunning;
+}
+
+void FSceneFlythroughTest::Shutdown()
+{
+	FlythroughTest.Reset();
+}
+
+void FSceneFlythroughTest::MoveCamera(const float Distance) const
+{
+	const USplineComponent* SplineComponent = Spline.Get();
+	ACameraActor* CameraActor = Camera.Get();
+	if (SplineComponent && CameraActor)
+	{
+		CameraActor->SetActorLocationAndRotation(
+			SplineComponent->GetLocationAtDistanceAlongSpline(Distance, ESplineCoordinateSpace::World),
+			SplineComponent->GetRotationAtDistanceAlongSpline(Distance, ESplineCoordinateSpace::World));
+	}
+}
+
+void FSceneFlythroughTest::Tick(float DeltaTime)
+{
+	// 关卡切换或 Actor 被销毁时提前结束，已经记录的数据仍然写出
+	if (!World.IsValid() || !Spline.IsValid() || !Camera.IsValid())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Flythrough was interrupted after %d frames."), Samples.Num());
+		Finish();
+		return;
+	}
+
+	// 用不受时间膨胀影响的真实帧时间推进，保证每次运行的路径一致
+	ElapsedSeconds += FApp::GetDeltaTime();
+	const double RecordSeconds = ElapsedSeconds - FMath::Max(CVarFlythroughWarmupSeconds.GetValueOnGameThread(), 0.0f);
+	if (RecordSeconds < 0.0)
+	{
+		return;
+	}
+
+	const float Alpha = static_cast<float>(FMath::Min(RecordSeconds / DurationSeconds, 1.0));
+	MoveCamera(Alpha * Spline->GetSplineLength());
+
+	// 记录的是上一帧的耗时，和 stat unit 一致
+	const uint32 GPUCycles = RHIGetGPUFrameCycles();
+	FSample& Sample = Samples.AddDefaulted_GetRef();
+	Sample.Frame = Samples.Num() - 1;
+	Sample.Time = RecordSeconds;
+	Sample.FrameMs = static_cast<float>(FApp::GetDeltaTime() * 1000.0);
+	Sample.GameThreadMs = FPlatformTime::ToMilliseconds(GGameThreadTime);
+	Sample.RenderThreadMs = FPlatformTime::ToMilliseconds(GRenderThreadTime);
+	Sample.GPUMs = FPlatformTime::ToMilliseconds(GPUCycles);
+	Sample.VisibleGaussians = FSceneStreamingManager::Get().GetVisibleGaussianCount();
+	Sample.PoolMB = FSceneStreamingManager::Get().GetPoolBytes() / BytesPerMB;
+	Sample.UsedPhysicalMB = FPlatformMemory::GetStats().UsedPhysical / BytesPerMB;
+	Sample.BudgetQuality = FSceneBudgetController::GetBudget().Quality;
+
+	if (Alpha >= 1.0f)
+	{
+		Finish();
+	}
+}
+
+TStatId FSceneFlythroughTest::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(FSceneFlythroughTest, STATGROUP_Tickables);
+}
+
+void FSceneFlythroughTest::Finish()
+{
+	bRunning = false;
+
+	APlayerController* PlayerController = World.IsValid() ? World->GetFirstPlayerController() : nullptr;
+	if (PlayerController && PreviousViewTarget.IsValid())
+	{
+		PlayerController->SetViewTarget(PreviousViewTarget.Get());
+	}
+	if (Camera.IsValid())
+	{
+		Camera->Destroy();
+	}
+
+	bool bPassed = WriteCsv();
+	if (bPassed && !BaselinePath.IsEmpty())
+	{
+		bPassed = CompareWithBaseline();
+	}
+	UE_LOG(LogTemp, Display, TEXT("Flythrough finished with %d frames: %s"), Samples.Num(),
+	       bPassed ? TEXT("passed") : TEXT("failed"));
+
+	if (FParse::Param(FCommandLine::Get(), TEXT("FlythroughExit")))
+	{
+		FPlatformMisc::RequestExitWithStatus(false, bPassed ? 0 : 1);
+	}
+}
+
+bool FSceneFlythroughTest::WriteCsv() const
+{
+	TArray<FString> Lines;
+	Lines.Reserve(Samples.Num() + 1);
+	Lines.Add(CsvHeader);
+	for (const FSample& Sample : Samples)
+	{
+		Lines.Add(FString::Printf(TEXT("%d,%.4f,%.3f,%.3f,%.3f,%.3f,%lld,%.2f,%.2f,%.3f"), Sample.Frame, Sample.Time,
+		                          Sample.FrameMs, Sample.GameThreadMs, Sample.RenderThreadMs, Sample.GPUMs,
+		                          Sample.VisibleGaussians, Sample.PoolMB, Sample.UsedPhysicalMB, Sample.BudgetQuality));
+	}
+
+	if (!FFileHelper::SaveStringArrayToFile(Lines, *OutputPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Flythrough could not write %s"), *OutputPath);
+		return false;
+	}
+	return true;
+}
+
+bool FSceneFlythroughTest::CompareWithBaseline() const
+{
+	TArray<FString> BaselineLines;
+	if (!FFileHelper::LoadFileToStringArray(BaselineLines, *BaselinePath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Flythrough could not read the baseline %s"), *BaselinePath);
+		return false;
+	}
+
+	// 重新读取刚写出的 CSV，和基线使用同样的解析方式
+	TArray<FString> Lines;
+	FFileHelper::LoadFileToStringArray(Lines, *OutputPath);
+
+	const float Threshold = FMath::Max(CVarFlythroughRegressionThreshold.GetValueOnGameThread(), 0.0f);
+	bool bPassed = true;
+	const auto Check = [&bPassed, Threshold](const TCHAR* Name, const TCHAR* Metric, const float Value,
+	                                         const float Baseline, const float MinDifference)
+	{
+		const bool bRegressed = Value > Baseline * (1.0f + Threshold) && Value - Baseline > MinDifference;
+		if (bRegressed)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Flythrough regression: %s %s %.3f, baseline %.3f (%+.1f%%)"), Name, Metric,
+			       Value, Baseline, 100.0f * (Value / FMath::Max(Baseline, UE_SMALL_NUMBER) - 1.0f));
+		}
+		else
+		{
+			UE_LOG(LogTemp, Display, TEXT("Flythrough %s %s %.3f, baseline %.3f"), Name, Metric, Value, Baseline);
+		}
+		bPassed &= !bRegressed;
+	};
+
+	for (const FCompareColumn& Column : CompareColumns)
+	{
+		TArray<float> Values;
+		TArray<float> BaselineValues;
+		if (!ReadCsvColumn(Lines, Column.Name, Values) || !ReadCsvColumn(BaselineLines, Column.Name, BaselineValues))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Flythrough skipped %s, the column is missing"), Column.Name);
+			continue;
+		}
+
+		if (Column.bTime)
+		{
+			Check(Column.Name, TEXT("median"), Percentile(Values, 0.5f), Percentile(BaselineValues, 0.5f),
+			      MinRegressionMs);
+			Check(Column.Name, TEXT("P95"), Percentile(Values, 0.95f), Percentile(BaselineValues, 0.95f),
+			      MinRegressionMs);
+		}
+		else
+		{
+			Check(Column.Name, TEXT("peak"), Peak(Values), Peak(BaselineValues), 0.0f);
+		}
+	}
+	return bPassed;
+}
@@ -0,0 +1,75 @@
+﻿#include "SceneInstancedComponent.h"
+
+#include "NiagaraSystem.h"
+
+void USceneInstancedComponent::OnRegister()
+{
+	if (!GetAsset())
+	{
+		// 和 ASceneActor 使用同一个 Niagara System
+		SetAsset(LoadObject<UNiagaraSystem>(
+			nullptr, TEXT("/Script/Niagara.NiagaraSystem'/GaussianSplattingX/FX_GaussianSplattingX.FX_GaussianSplattingX'")));
+	}
+	SetVariableObject(TEXT("User.SceneNiagaraParameter"), SceneNiagaraParameter.Get());
+
+	Super::OnRegister();
+}
+
+#if WITH_EDITOR
+void USceneInstancedComponent::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	if (PropertyChangedEvent.GetMemberPropertyName() == GET_MEMBER_NAME_CHECKED(USceneInstancedComponent,
+		    SceneNiagaraParameter))
+	{
+		SetVariableObject(TEXT("User.SceneNiagaraParameter"), SceneNiagaraParameter.Get());
+	}
+	MarkInstancesDirty();
+}
+#endif
+
+int32 USceneInstancedComponent::AddInstance(const FTransform& InstanceTransform)
+{
+	const int32 InstanceIndex = InstanceTransforms.Add(InstanceTransform);
+	MarkInstancesDirty();
+	return InstanceIndex;
+}
+
+bool USceneInstancedComponent::RemoveInstance(const int32 InstanceIndex)
+{
+	if (!InstanceTransforms.IsValidIndex(InstanceIndex))
+	{
+		return false;
+	}
+	InstanceTransforms.RemoveAt(InstanceIndex);
+	MarkInstancesDirty();
+	return true;
+}
+
+bool USceneInstancedComponent::UpdateInstanceTransform(const int32 InstanceIndex, const FTransform& InstanceTransform)
+{
+	if (!InstanceTransforms.IsValidIndex(InstanceIndex))
+	{
+		return false;
+	}
+	InstanceTransforms[InstanceIndex] = InstanceTransform;
+	MarkInstancesDirty();
+	return true;
+}
+
+void USceneInstancedComponent::ClearInstances()
+{
+	InstanceTransforms.Reset();
+	MarkInstancesDirty();
+}
+
+int32 USceneInstancedComponent::GetInstanceCount() const
+{
+	return InstanceTransforms.Num();
+}
+
+void USceneInstancedComponent::MarkInstancesDirty()
+{
+	++InstanceTransformsVersion;
+}
@@ -1,40 +1,187 @@
 ﻿#include "SceneNiagaraDataInterface.h"
 
-#if WITH_EDITOR
-#include "LevelEditorViewport.h"
-#endif
-
 #include "SceneActor.h"
 
+#include "Misc/ScopeRWLock.h"
 #include "NiagaraCompileHashVisitor.h"
 #include "NiagaraRendererProperties.h"
 #include "NiagaraRenderer.h"
 #include "NiagaraShaderParametersBuilder.h"
 #include "NiagaraSystemInstance.h"
+#include "NiagaraWorldManager.h"
 #include "SceneBufferAsset.h"
+#include "SceneBudgetController.h"
+#include "SceneBufferRenderResource.h"
+#include "SceneInstancedComponent.h"
 
 const FName USceneNiagaraDataInterface::GetGaussianCountName = TEXT("GetGaussianCount");
 const FName USceneNiagaraDataInterface::GetGaussianDataName = TEXT("GetGaussianData");
+const FName USceneNiagaraDataInterface::GetGaussianStaticDataName = TEXT("GetGaussianStaticData");
+const FName USceneNiagaraDataInterface::GetGaussianViewColorName = TEXT("GetGaussianViewColor");
+const FName USceneNiagaraDataInterface::GetDataVersionName = TEXT("GetDataVersion");
 const FString USceneNiagaraDataInterface::GaussianShaderFile = TEXT(
 	"/Plugin/GaussianSplattingX/Private/SceneNiagaraInterface_Shader.ush");
 
+namespace
+{
+	// 和 SceneNiagaraInterface_Utils.ush 中的常量相同
+	constexpr float SH_C0 = 0.28209479177387814f;
+	constexpr float SH_C1 = 0.4886025119029199f;
+	constexpr float SH_C2[] = {
+		1.0925484305920792f,
+		-1.0925484305920792f,
+		0.31539156525252005f,
+		-1.0925484305920792f,
+		0.5462742152960396f
+	};
+	constexpr float SH_C3[] = {
+		-0.5900435899266435f,
+		2.890611442640554f,
+		-0.4570457994644658f,
+		0.3731763325901154f,
+		-0.4570457994644658f,
+		1.445305721320277f,
+		-0.5900435899266435f
+	};
+
+	/// 沿 Direction 观察一个高斯时的颜色，MaxSHCoefficientsCount 为 1 时只使用 0 阶系数，结果和视角无关
+	VectorRegister4Float EvaluateGaussianColor(const FSceneGPUPayload& Payload, const int32 Index,
+	                                           const VectorRegister4Float Direction, const int32 MaxSHCoefficientsCount)
+	{
+		alignas(16) float D[4];
+		VectorStoreAligned(Direction, D);
+		const float X = D[0], Y = D[1], Z = D[2];
+
+		// 和 SceneNiagaraInterface_Utils.ush 中的 CalculateGaussianColor 相同，每个系数的 RGB 一起计算
+		const int32 SHCount = FMath::Min<int32>(static_cast<int32>(Payload.SHCoefficientsCount), MaxSHCoefficientsCount);
+		const FVector4f* SH = &Payload.SHCoefficients[static_cast<int64>(Index) * Payload.SHCoefficientsCount];
+		const auto Accumulate = [SH](VectorRegister4Float Result, const int32 Coefficient, const float Basis)
+		{
+			return VectorMultiplyAdd(VectorSetFloat1(Basis), VectorLoad(&SH[Coefficient].X), Result);
+		};
+
+		VectorRegister4Float Result = SHCount > 0 ? Accumulate(VectorZeroFloat(), 0, SH_C0) : VectorZeroFloat();
+		if (SHCount >= 4)
+		{
+			Result = Accumulate(Result, 1, -SH_C1 * Y);
+			Result = Accumulate(Result, 2, SH_C1 * Z);
+			Result = Accumulate(Result, 3, -SH_C1 * X);
+
+			if (SHCount >= 9)
+			{
+				const float XX = X * X, YY = Y * Y, ZZ = Z * Z;
+				const float XY = X * Y, YZ = Y * Z, XZ = X * Z;
+				Result = Accumulate(Result, 4, SH_C2[0] * XY);
+				Result = Accumulate(Result, 5, SH_C2[1] * YZ);
+				Result = Accumulate(Result, 6, SH_C2[2] * (2.0f * ZZ - XX - YY));
+				Result = Accumulate(Result, 7, SH_C2[3] * XZ);
+				Result = Accumulate(Result, 8, SH_C2[4] * (XX - YY));
+
+				if (SHCount >= 16)
+				{
+					Result = Accumulate(Result, 9, SH_C3[0] * Y * (3.0f * XX - YY));
+					Result = Accumulate(Result, 10, SH_C3[1] * XY * Z);
+					Result = Accumulate(Result, 11, SH_C3[2] * Y * (4.0f * ZZ - XX - YY));
+					Result = Accumulate(Result, 12, SH_C3[3] * Z * (2.0f * ZZ - 3.0f * XX - 3.0f * YY));
+					Result = Accumulate(Result, 13, SH_C3[4] * X * (4.0f * ZZ - XX - YY));
+					Result = Accumulate(Result, 14, SH_C3[5] * Z * (XX - YY));
+					Result = Accumulate(Result, 15, SH_C3[6] * X * (XX - 3.0f * YY));
+				}
+			}
+		}
+		return VectorMin(VectorMax(Result, VectorZeroFloat()), VectorOneFloat());
+	}
+
+	/// 不需要 GPU 和 Niagara System，直接输出 VM 路径的计算结果，用来在无头模式下检查 Data Interface 的输出
+	void PrintGaussianData(const TArray<FString>& Args)
+	{
+		if (Args.IsEmpty())
+		{
+			UE_LOG(LogTemp, Warning,
+			       TEXT("Usage: GaussianSplattingX.EvaluateGaussianData <SceneBufferAssetPath> [Count] [CameraX CameraY CameraZ]"));
+			return;
+		}
+
+		USceneBufferAsset* Scene = LoadObject<USceneBufferAsset>(nullptr, *Args[0]);
+		if (!Scene)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Failed to load SceneBufferAsset %s"), *Args[0]);
+			return;
+		}
+		Scene->UnpackCookedPayload();
+
+		const int32 Count = FMath::Min<int32>(Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 16, Scene->GaussianCount);
+		FVector3f CameraPosition = FVector3f::ZeroVector;
+		if (Args.Num() > 4)
+		{
+			CameraPosition = FVector3f(FCString::Atof(*Args[2]), FCString::Atof(*Args[3]), FCString::Atof(*Args[4]));
+		}
+
+		FSceneGPUPayload Payload;
+		Payload.Pack(*Scene);
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			FVector4f Position;
+			FVector3f Color;
+			USceneNiagaraDataInterface::EvaluateGaussianData(Payload, Index, FMatrix44f::Identity,
+			                                                 FMatrix44f::Identity, CameraPosition, Position, Color);
+			UE_LOG(LogTemp, Display, TEXT("%d: Position (%.4f, %.4f, %.4f) Color (%.4f, %.4f, %.4f)"), Index,
+			       Position.X, Position.Y, Position.Z, Color.X, Color.Y, Color.Z);
+		}
+	}
+
+	FAutoConsoleCommand EvaluateGaussianDataCommand(
+		TEXT("GaussianSplattingX.EvaluateGaussianData"),
+		TEXT("Print the CPU GetGaussianData output for the first Gaussians of an asset. ")
+		TEXT("Usage: GaussianSplattingX.EvaluateGaussianData <SceneBufferAssetPath> [Count] [CameraX CameraY CameraZ]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&PrintGaussianData));
+}
+
 struct FNDIGaussianInstanceData
 {
 	TSoftObjectPtr<USceneBufferAsset> SceneBufferAsset;
 
-	FTransform CameraTransform;
+	/// 资产在 GPU 上的数据，多个实例共享
+	TSharedPtr<FSceneBufferRenderResource, ESPMode::ThreadSafe> RenderResource;
+
+	/// 只有 VM 使用，GPU 直接读取每个视图的 View Uniform Buffer
+	FVector CameraLocation = FVector::ZeroVector;
+
+	/// 这一帧的绘制预算，GT 上从 FSceneBudgetController 复制
+	float MinOpacity = 0.0f;
+	int32 MaxSHCoefficientsCount = MAX_int32;
+
 	FTransform ActorTransform;
 
+	/// 每个实例相对于组件的变换，不是 USceneInstancedComponent 时只有一个单位变换
+	TArray<FTransform> InstanceTransforms = {FTransform::Identity};
+	uint32 InstanceTransformsVersion = 0;
+
+	/// 实例变换变化时从 RenderResource 的计数器分配新版本
+	uint32 InstanceDataVersion = 0;
+
+	/// VM 使用的单精度矩阵，和 GPU 上的 InstanceTransformBuffer、ActorTransformMatrix 一致
+	TArray<FMatrix44f> InstanceMatrices = {FMatrix44f::Identity};
+	FMatrix44f ActorMatrix = FMatrix44f::Identity;
+
 	void LoadSceneBufferAsset(const FSoftObjectPath& SceneBufferAssetPath)
 	{
 		SceneBufferAsset = TSoftObjectPtr<USceneBufferAsset>(SceneBufferAssetPath);
 		SceneBufferAsset.LoadSynchronous();
+		UpdateRenderResource();
 
 		UE_LOG(LogTemp, Log,
 		       TEXT("FNDIGaussianInstanceData::LoadSceneBufferAsset - Loaded SceneBufferAsset: %s, Valid: %d"),
 		       *SceneBufferAssetPath.ToString(), SceneBufferAsset.IsValid());
 	}
 
+	/// 资产重新导入后会创建新的 RenderResource，每帧在 GT 上同步一次
+	void UpdateRenderResource()
+	{
+		USceneBufferAsset* Asset = SceneBufferAsset.Get();
+		RenderResource = Asset ? Asset->GetRenderResource() : nullptr;
+	}
+
 	const USceneBufferAsset& GetSceneBufferAsset() const
 	{
 		return *SceneBufferAsset;
@@ -50,6 +197,18 @@ struct FNDIGaussianInstanceData
 		return SceneBufferAsset.IsValid() ? SceneBufferAsset->GaussianCount : 0;
 	}
 
+	/// 所有实例的高斯总数，也就是需要的粒子数量
+	size_t GetTotalGaussianCount() const
+	{
+		return GetGaussianCount() * InstanceTransforms.Num();
+	}
+
+	/// 粒子上缓存的静态数据是否需要重新读取，SlotTable、高斯数据、RenderResource 或实例变换变化后都会变大
+	uint32 GetDataVersion() const
+	{
+		return FMath::Max(InstanceDataVersion, RenderResource ? RenderResource->GetDataVersion() : 0u);
+	}
+
 	size_t GetSHCoefficientsCount() const
 	{
 		return SceneBufferAsset.IsValid() ? SceneBufferAsset->SHCoefficientsCount : 0;
@@ -85,6 +244,7 @@ public:
 			PerInstanceData);
 		FNDIGaussianInstanceData& InstanceData = SystemInstancesToInstanceData_RT.FindOrAdd(InstanceID);
 		InstanceData = *InstanceDataFromGT;
+		UpdateInstanceTransformBuffer_RT(InstanceID, InstanceData);
 
 		// we call the destructor here to clean up the GT data. Without this we could be leaking memory.
 		InstanceDataFromGT->~FNDIGaussianInstanceData();
@@ -98,105 +258,69 @@ public:
 	void RemoveInstanceData_RT(const FNiagaraSystemInstanceID& InstanceID)
 	{
 		SystemInstancesToInstanceData_RT.Remove(InstanceID);
+		if (FInstanceTransformBuffer* InstanceTransformBuffer = InstanceTransformBuffers_RT.Find(InstanceID))
+		{
+			InstanceTransformBuffer->Buffer.Release();
+			InstanceTransformBuffers_RT.Remove(InstanceID);
+		}
 	}
 
-	void PostSRV_RT(const FNiagaraSystemInstanceID& InstanceID)
+	/// 每个实例的变换矩阵，按行存储，每个实例占 4 个 float4
+	struct FInstanceTransformBuffer
 	{
-		const FNDIGaussianInstanceData& InstanceData = GetInstanceData_RT(InstanceID);
-		const USceneBufferAsset& SceneBufferAsset = InstanceData.GetSceneBufferAsset();
+		FReadBuffer Buffer;
+		uint32 Version = MAX_uint32;
+	};
 
-		ENQUEUE_RENDER_COMMAND(FUpdateGaussianBuffer)(
-			[this, &SceneBufferAsset](FRHICommandListImmediate& RHICmdList)
-			{
-				InitializeBuffer<FVector4f>(
-					GaussianPositionOpacityBuffer, TEXT("PositionOpacityBuffer"),
-					SceneBufferAsset.GaussianCount,
-					PF_A32B32G32R32F, RHICmdList,
-					[&SceneBufferAsset](const size_t Index, FVector4f& MappedData)
-					{
-						const FVector& Position = SceneBufferAsset.GaussianPositions[Index];
-						MappedData.X = Position.X;
-						MappedData.Y = Position.Y;
-						MappedData.Z = Position.Z;
-						MappedData.W = SceneBufferAsset.GaussianOpacities[Index];
-					});
-
-				InitializeBuffer<FVector4f>(
-					GaussianSHCoefficientsBuffer, TEXT("SHCoefficientsBuffer"),
-					SceneBufferAsset.GaussianCount * SceneBufferAsset.SHCoefficientsCount,
-					PF_A32B32G32R32F, RHICmdList,
-					[&SceneBufferAsset](const size_t Index, FVector4f& MappedData)
-					{
-						const FVector& Position = SceneBufferAsset.GaussianSHCoefficients[Index];
-						MappedData.X = Position.X;
-						MappedData.Y = Position.Y;
-						MappedData.Z = Position.Z;
-						MappedData.W = 1.0f; // padding
-					});
-
-				InitializeBuffer<FQuat4f>(
-					GaussianRotationBuffer, TEXT("RotationBuffer"),
-					SceneBufferAsset.GaussianCount,
-					PF_A32B32G32R32F, RHICmdList,
-					[&SceneBufferAsset](const size_t Index, FQuat4f& MappedData)
-					{
-						MappedData = FQuat4f(SceneBufferAsset.GaussianRotations[Index]);
-					});
-
-				InitializeBuffer<FVector4f>(
-					GaussianScaleBuffer, TEXT("ScaleBuffer"),
-					SceneBufferAsset.GaussianCount,
-					PF_A32B32G32R32F, RHICmdList,
-					[&SceneBufferAsset](const size_t Index, FVector4f& MappedData)
-					{
-						const FVector& Scale = SceneBufferAsset.GaussianScales[Index];
-						MappedData.X = Scale.X;
-						MappedData.Y = Scale.Y;
-						MappedData.Z = Scale.Z;
-						MappedData.W = 1.0f;
-					});
-			});
+	const FReadBuffer* GetInstanceTransformBuffer_RT(const FNiagaraSystemInstanceID& InstanceID) const
+	{
+		const FInstanceTransformBuffer* InstanceTransformBuffer = InstanceTransformBuffers_RT.Find(InstanceID);
+		return InstanceTransformBuffer ? &InstanceTransformBuffer->Buffer : nullptr;
 	}
 
 private:
-	template <typename TBufferElementType>
-	static void InitializeBuffer(FReadBuffer& Buffer,
-	                             const TCHAR* BufferName,
-	                             const size_t BufferElementCount,
-	                             const EPixelFormat BufferFormat,
-	                             FRHICommandListImmediate& RHICmdList,
-	                             TFunction<void(size_t Index, TBufferElementType& MappedData)> FillFunction)
-	{
-		const size_t BufferSize = BufferElementCount * sizeof(TBufferElementType);
-		if (BufferSize > 0 && !Buffer.NumBytes)
+	/// 只有实例变换发生变化时才重新上传
+	void UpdateInstanceTransformBuffer_RT(const FNiagaraSystemInstanceID& InstanceID,
+	                                      const FNDIGaussianInstanceData& InstanceData)
+	{
+		FInstanceTransformBuffer& InstanceTransformBuffer = InstanceTransformBuffers_RT.FindOrAdd(InstanceID);
+		if (InstanceTransformBuffer.Version == InstanceData.InstanceTransformsVersion)
 		{
-			Buffer.Initialize(RHICmdList, BufferName, sizeof(TBufferElementType), BufferElementCount, BufferFormat,
-			                  BUF_Static);
+			return;
 		}
+		InstanceTransformBuffer.Version = InstanceData.InstanceTransformsVersion;
 
-		if (Buffer.NumBytes > 0)
+		FRHICommandListImmediate& RHICmdList = FRHICommandListExecutor::GetImmediateCommandList();
+		const int32 NumElements = InstanceData.InstanceTransforms.Num() * 4;
+		if (InstanceTransformBuffer.Buffer.NumBytes != NumElements * sizeof(FVector4f))
 		{
-			TBufferElementType* MappedData = static_cast<TBufferElementType*>(
-				RHICmdList.LockBuffer(Buffer.Buffer, 0, BufferSize, RLM_WriteOnly));
-			for (size_t i = 0; i < BufferElementCount; ++i)
+			InstanceTransformBuffer.Buffer.Release();
+			if (NumElements > 0)
 			{
-				FillFunction(i, MappedData[i]);
+				InstanceTransformBuffer.Buffer.Initialize(RHICmdList, TEXT("GaussianInstanceTransformBuffer"),
+				                                          sizeof(FVector4f), NumElements, PF_A32B32G32R32F,
+				                                          BUF_Static);
 			}
-			RHICmdList.UnlockBuffer(Buffer.Buffer);
 		}
+		if (NumElements == 0)
+		{
+			return;
+		}
+
+		FMatrix44f* MappedData = static_cast<FMatrix44f*>(RHICmdList.LockBuffer(
+			InstanceTransformBuffer.Buffer.Buffer, 0, InstanceTransformBuffer.Buffer.NumBytes, RLM_WriteOnly));
+		for (int32 i = 0; i < InstanceData.InstanceTransforms.Num(); ++i)
+		{
+			MappedData[i] = FMatrix44f(InstanceData.InstanceTransforms[i].ToMatrixWithScale());
+		}
+		RHICmdList.UnlockBuffer(InstanceTransformBuffer.Buffer.Buffer);
 	}
 
 private:
 	// ================================ 每个 Niagara System 实例的数据 ===============================
 	// note: 一定要在 InstanceData 中存储数据，不要在 Proxy 里面存，如果直接存储在 Proxy 里面，多个 Niagara System 实例会互相覆盖数据
 	TMap<FNiagaraSystemInstanceID, FNDIGaussianInstanceData> SystemInstancesToInstanceData_RT;
-
-public:
-	// =============================== Buffer ===============================
-	FReadBuffer GaussianPositionOpacityBuffer;
-	FReadBuffer GaussianSHCoefficientsBuffer;
-	FReadBuffer GaussianRotationBuffer;
-	FReadBuffer GaussianScaleBuffer;
+	TMap<FNiagaraSystemInstanceID, FInstanceTransformBuffer> InstanceTransformBuffers_RT;
 };
 
 USceneNiagaraDataInterface::USceneNiagaraDataInterface(const FObjectInitializer& ObjectInitializer)
@@ -232,15 +356,58 @@ void USceneNiagaraDataInterface::GetFunctionsInternal(TArray<FNiagaraFunctionSig
 		Sig.Name = GetGaussianDataName;
 		Sig.bMemberFunction = true;
 		Sig.bReadFunction = true;
-		Sig.bSupportsCPU = false;
+		Sig.bSupportsCPU = true;
+		Sig.bSupportsGPU = true;
+		Sig.ModuleUsageBitmask = ENiagaraScriptUsageMask::Particle;
+		Sig.AddInput(FNiagaraVariable(FNiagaraTypeDefinition(GetClass()), TEXT("Scene Niagara Data Interface")));
+		Sig.AddOutput(FNiagaraVariable(FNiagaraTypeDefinition::GetVec4Def(), TEXT("Position")));
+		Sig.AddOutput(FNiagaraVariable(FNiagaraTypeDefinition::GetIntDef(), TEXT("Index")));
+		Sig.AddOutput(FNiagaraVariable(FNiagaraTypeDefinition::GetVec3Def(), TEXT("Color")));
+		OutFunctions.Add(Sig);
+	}
+
+	// 静态粒子模式：GetGaussianStaticData 只在 DataVersion 变化时调用，结果保存在粒子属性上，
+	// 每帧只调用 GetGaussianViewColor 计算和视图相关的颜色
+	{
+		FNiagaraFunctionSignature Sig;
+		Sig.Name = GetGaussianStaticDataName;
+		Sig.bMemberFunction = true;
+		Sig.bReadFunction = true;
+		Sig.bSupportsCPU = true;
 		Sig.bSupportsGPU = true;
 		Sig.ModuleUsageBitmask = ENiagaraScriptUsageMask::Particle;
 		Sig.AddInput(FNiagaraVariable(FNiagaraTypeDefinition(GetClass()), TEXT("Scene Niagara Data Interface")));
 		Sig.AddOutput(FNiagaraVariable(FNiagaraTypeDefinition::GetVec4Def(), TEXT("Position")));
 		Sig.AddOutput(FNiagaraVariable(FNiagaraTypeDefinition::GetIntDef(), TEXT("Index")));
+		Sig.AddOutput(FNiagaraVariable(FNiagaraTypeDefinition::GetVec3Def(), TEXT("Base Color")));
+		OutFunctions.Add(Sig);
+	}
+	{
+		FNiagaraFunctionSignature Sig;
+		Sig.Name = GetGaussianViewColorName;
+		Sig.bMemberFunction = true;
+		Sig.bReadFunction = true;
+		Sig.bSupportsCPU = true;
+		Sig.bSupportsGPU = true;
+		Sig.ModuleUsageBitmask = ENiagaraScriptUsageMask::Particle;
+		Sig.AddInput(FNiagaraVariable(FNiagaraTypeDefinition(GetClass()), TEXT("Scene Niagara Data Interface")));
+		Sig.AddInput(FNiagaraVariable(FNiagaraTypeDefinition::GetIntDef(), TEXT("Index")));
+		Sig.AddInput(FNiagaraVariable(FNiagaraTypeDefinition::GetVec4Def(), TEXT("Position")));
 		Sig.AddOutput(FNiagaraVariable(FNiagaraTypeDefinition::GetVec3Def(), TEXT("Color")));
 		OutFunctions.Add(Sig);
 	}
+	{
+		FNiagaraFunctionSignature Sig;
+		Sig.Name = GetDataVersionName;
+		Sig.bMemberFunction = true;
+		Sig.bReadFunction = true;
+		Sig.bSupportsCPU = true;
+		Sig.bSupportsGPU = true;
+		Sig.ModuleUsageBitmask = ENiagaraScriptUsageMask::Particle;
+		Sig.AddInput(FNiagaraVariable(FNiagaraTypeDefinition(GetClass()), TEXT("Scene Niagara Data Interface")));
+		Sig.AddOutput(FNiagaraVariable(FNiagaraTypeDefinition::GetIntDef(), TEXT("Version")));
+		OutFunctions.Add(Sig);
+	}
 
 	UE_LOG(LogTemp, Log,
 	       TEXT("USceneNiagaraInterface::GetFunctionsInternal - Registered %d functions."),
@@ -285,6 +452,12 @@ bool USceneNiagaraDataInterface::CanExecuteOnTarget(ENiagaraSimTarget Target) co
 	return true;
 }
 
+bool USceneNiagaraDataInterface::RequiresEarlyViewData() const
+{
+	// GPU 模拟可能在 InitViews 之前执行，需要提前准备好 View Uniform Buffer
+	return true;
+}
+
 bool USceneNiagaraDataInterface::CopyToInternal(UNiagaraDataInterface* Destination) const
 {
 	if (!Super::CopyToInternal(Destination))
@@ -326,7 +499,10 @@ bool USceneNiagaraDataInterface::GetFunctionHLSL(const FNiagaraDataInterfaceGPUP
                                                  const FNiagaraDataInterfaceGeneratedFunction& FunctionInfo,
                                                  int FunctionInstanceIndex, FString& OutHLSL)
 {
-	return FunctionInfo.DefinitionName == GetGaussianDataName;
+	return FunctionInfo.DefinitionName == GetGaussianDataName ||
+		FunctionInfo.DefinitionName == GetGaussianStaticDataName ||
+		FunctionInfo.DefinitionName == GetGaussianViewColorName ||
+		FunctionInfo.DefinitionName == GetDataVersionName;
 }
 
 void USceneNiagaraDataInterface::GetParameterDefinitionHLSL(const FNiagaraDataInterfaceGPUParamInfo& ParamInfo,
@@ -335,6 +511,9 @@ void USceneNiagaraDataInterface::GetParameterDefinitionHLSL(const FNiagaraDataIn
 	const TMap<FString, FStringFormatArg> TemplateArgs = {
 		{TEXT("ParameterName"), ParamInfo.DataInterfaceHLSLSymbol},
 		{TEXT("GetGaussianDataName"), FStringFormatArg(GetGaussianDataName.ToString())},
+		{TEXT("GetGaussianStaticDataName"), FStringFormatArg(GetGaussianStaticDataName.ToString())},
+		{TEXT("GetGaussianViewColorName"), FStringFormatArg(GetGaussianViewColorName.ToString())},
+		{TEXT("GetDataVersionName"), FStringFormatArg(GetDataVersionName.ToString())},
 	};
 	AppendTemplateHLSL(OutHLSL, *GaussianShaderFile, TemplateArgs);
 }
@@ -353,26 +532,37 @@ void USceneNiagaraDataInterface::SetShaderParameters(
 
 	FShaderParameters* ShaderParameters = Context.GetParameterNestedStruct<FShaderParameters>();
 
-	// 将 SceneBufferAsset 的数据上传到 GPU Buffer
-	if (InstanceData.SceneBufferAsset.IsValid())
-	{
-		DataInterfaceProxy.PostSRV_RT(Context.GetSystemInstanceID());
-	}
-	ShaderParameters->GaussianCount = InstanceData.GetGaussianCount();
-	ShaderParameters->SHCoefficientsCount = InstanceData.GetSHCoefficientsCount();
+	// 数据在资产加载时已经上传到 GPU，这里只绑定 SRV
+	const FSceneBufferRenderResource* RenderResource = InstanceData.RenderResource.Get();
+	const bool bResourceReady = RenderResource && RenderResource->IsInitialized();
+	ShaderParameters->GaussianCount = bResourceReady ? RenderResource->GetGaussianCount() : 0;
+	ShaderParameters->ResidentGaussianCount = bResourceReady ? RenderResource->GetResidentGaussianCount_RenderThread() : 0;
+	ShaderParameters->ChunkSize = FSceneChunk::MaxGaussians;
+	ShaderParameters->SHCoefficientsCount = bResourceReady ? RenderResource->GetSHCoefficientsCount() : 0;
+	ShaderParameters->MinOpacity = InstanceData.MinOpacity;
+	ShaderParameters->MaxSHCoefficientsCount = FMath::Min(InstanceData.MaxSHCoefficientsCount,
+	                                                      ShaderParameters->SHCoefficientsCount);
 	ShaderParameters->GaussianPositionOpacityBuffer = FNiagaraRenderer::GetSrvOrDefaultFloat(
-		DataInterfaceProxy.GaussianPositionOpacityBuffer.SRV);
+		bResourceReady ? RenderResource->PositionOpacityBuffer.SRV : nullptr);
 	ShaderParameters->GaussianRotationBuffer = FNiagaraRenderer::GetSrvOrDefaultFloat(
-		DataInterfaceProxy.GaussianRotationBuffer.SRV);
+		bResourceReady ? RenderResource->RotationBuffer.SRV : nullptr);
 	ShaderParameters->GaussianSHCoefficientsBuffer = FNiagaraRenderer::GetSrvOrDefaultFloat(
-		DataInterfaceProxy.GaussianSHCoefficientsBuffer.SRV);
+		bResourceReady ? RenderResource->SHCoefficientsBuffer.SRV : nullptr);
 	ShaderParameters->GaussianScaleBuffer = FNiagaraRenderer::GetSrvOrDefaultFloat(
-		DataInterfaceProxy.GaussianScaleBuffer.SRV);
+		bResourceReady ? RenderResource->ScaleBuffer.SRV : nullptr);
+	ShaderParameters->SlotTableBuffer = FNiagaraRenderer::GetSrvOrDefaultUInt(
+		bResourceReady ? RenderResource->SlotTableBuffer.SRV : nullptr);
+
+	// 所有实例共享上面的 Buffer，只有实例变换是每个 System 独有的
+	const FReadBuffer* InstanceTransformBuffer = DataInterfaceProxy.GetInstanceTransformBuffer_RT(
+		Context.GetSystemInstanceID());
+	ShaderParameters->InstanceCount = InstanceData.InstanceTransforms.Num();
+	ShaderParameters->InstanceTransformBuffer = FNiagaraRenderer::GetSrvOrDefaultFloat4(
+		InstanceTransformBuffer ? InstanceTransformBuffer->SRV : nullptr);
 
 	ShaderParameters->ActorTransformMatrix = FMatrix44f(
 		InstanceData.ActorTransform.ToMatrixWithScale());
-	const FVector4 CameraPosition = InstanceData.CameraTransform.GetLocation();
-	ShaderParameters->CameraPosition = FVector4f(CameraPosition);
+	ShaderParameters->DataVersion = static_cast<int32>(InstanceData.GetDataVersion());
 }
 
 int USceneNiagaraDataInterface::PerInstanceDataSize() const
@@ -413,9 +603,40 @@ bool USceneNiagaraDataInterface::PerInstanceTick(void* PerInstanceData, FNiagara
 		return true;
 	}
 
-	// 得到当前 System 对象相对于相机的 Transform
-	InstanceData->CameraTransform = GetCameraTransform(SystemInstance);
+	InstanceData->UpdateRenderResource();
+
+	InstanceData->CameraLocation = GetCameraLocation(SystemInstance);
+	const FSceneSplatBudget& Budget = FSceneBudgetController::GetBudget();
+	InstanceData->MinOpacity = Budget.MinOpacity;
+	InstanceData->MaxSHCoefficientsCount = Budget.MaxSHCoefficientsCount;
 	InstanceData->ActorTransform = GetActorTransform(SystemInstance);
+	InstanceData->ActorMatrix = FMatrix44f(InstanceData->ActorTransform.ToMatrixWithScale());
+
+	// 实例化组件的变换只在修改后才重新复制
+	if (const USceneInstancedComponent* InstancedComponent = Cast<USceneInstancedComponent>(
+		SystemInstance->GetAttachComponent()))
+	{
+		if (InstanceData->InstanceTransformsVersion != InstancedComponent->GetInstanceTransformsVersion())
+		{
+			InstanceData->InstanceTransforms = InstancedComponent->InstanceTransforms;
+			InstanceData->InstanceTransformsVersion = InstancedComponent->GetInstanceTransformsVersion();
+			InstanceData->InstanceDataVersion = FSceneBufferRenderResource::AllocateDataVersion();
+			InstanceData->InstanceMatrices.Reset(InstanceData->InstanceTransforms.Num());
+			for (const FTransform& InstanceTransform : InstanceData->InstanceTransforms)
+			{
+				InstanceData->InstanceMatrices.Add(FMatrix44f(InstanceTransform.ToMatrixWithScale()));
+			}
+		}
+	}
+
+	// 告诉流送管理器这个资产正在哪里被使用
+	if (InstanceData->RenderResource)
+	{
+		for (const FTransform& InstanceTransform : InstanceData->InstanceTransforms)
+		{
+			InstanceData->RenderResource->ReportInstance_GameThread(InstanceTransform * InstanceData->ActorTransform);
+		}
+	}
 	return false;
 }
 
@@ -456,6 +677,38 @@ void USceneNiagaraDataInterface::GetVMExternalFunction(const FVMExternalFunction
 		});
 		return;
 	}
+	if (BindingInfo.Name == GetGaussianDataName)
+	{
+		OutFunc = FVMExternalFunction::CreateLambda([this](FVectorVMExternalFunctionContext& Context)
+		{
+			this->GetGaussianDataVM(Context);
+		});
+		return;
+	}
+	if (BindingInfo.Name == GetGaussianStaticDataName)
+	{
+		OutFunc = FVMExternalFunction::CreateLambda([this](FVectorVMExternalFunctionContext& Context)
+		{
+			this->GetGaussianStaticDataVM(Context);
+		});
+		return;
+	}
+	if (BindingInfo.Name == GetGaussianViewColorName)
+	{
+		OutFunc = FVMExternalFunction::CreateLambda([this](FVectorVMExternalFunctionContext& Context)
+		{
+			this->GetGaussianViewColorVM(Context);
+		});
+		return;
+	}
+	if (BindingInfo.Name == GetDataVersionName)
+	{
+		OutFunc = FVMExternalFunction::CreateLambda([this](FVectorVMExternalFunctionContext& Context)
+		{
+			this->GetDataVersionVM(Context);
+		});
+		return;
+	}
 	UE_LOG(LogTemp, Error,
 	       TEXT("USceneNiagaraInterface::GetVMExternalFunction - CPU execution is not supported for function %s"),
 	       *BindingInfo.Name.ToString());
@@ -466,63 +719,207 @@ void USceneNiagaraDataInterface::GetGaussianCountVM(FVectorVMExternalFunctionCon
 	VectorVM::FUserPtrHandler<FNDIGaussianInstanceData> InstanceData(Context);
 	FNDIOutputParam<int> OutCount(Context);
 
-	const int Count = InstanceData->GetGaussianCount();
+	const int Count = InstanceData->GetTotalGaussianCount();
 	for (size_t i = 0; i < Context.GetNumInstances(); ++i)
 	{
 		OutCount.SetAndAdvance(Count);
 	}
 }
 
-FTransform USceneNiagaraDataInterface::GetCameraTransform(const FNiagaraSystemInstance* SystemInstance) const
+void USceneNiagaraDataInterface::GetGaussianDataVM(FVectorVMExternalFunctionContext& Context) const
 {
-	const UWorld* World = SystemInstance->GetWorld();
-	if (!World)
+	VectorVM::FUserPtrHandler<FNDIGaussianInstanceData> InstanceData(Context);
+	FNDIOutputParam<FVector4f> OutPosition(Context);
+	FNDIOutputParam<int32> OutIndex(Context);
+	FNDIOutputParam<FVector3f> OutColor(Context);
+
+	// CPU 上保留了完整的打包数据，所以 VM 不受流送影响，所有高斯都可以读取
+	const FSceneBufferRenderResource* RenderResource = InstanceData->RenderResource.Get();
+	const int32 GaussianCount = RenderResource ? RenderResource->GetGaussianCount() : 0;
+	const int32 TotalCount = GaussianCount * InstanceData->InstanceMatrices.Num();
+	if (TotalCount == 0)
 	{
-		return FTransform::Identity;
+		for (int32 i = 0; i < Context.GetNumInstances(); ++i)
+		{
+			OutPosition.SetAndAdvance(FVector4f::Zero());
+			OutIndex.SetAndAdvance(INDEX_NONE);
+			OutColor.SetAndAdvance(FVector3f::ZeroVector);
+		}
+		return;
 	}
 
-	if (World->IsGameWorld())
+	FReadScopeLock Lock(RenderResource->GetPayloadLock());
+	const FSceneGPUPayload& Payload = RenderResource->GetPayload();
+	const FVector3f CameraPosition(InstanceData->CameraLocation);
+
+	// 和 GPU 一样按执行下标把粒子映射到 (实例, 高斯)
+	const int32 StartInstance = Context.GetStartInstance();
+	for (int32 i = 0; i < Context.GetNumInstances(); ++i)
 	{
-		const APlayerController* PC = World->GetFirstPlayerController();
-		if (PC && PC->PlayerCameraManager)
+		const int32 Lane = (StartInstance + i) % TotalCount;
+		const int32 Instance = Lane / GaussianCount;
+		const int32 Index = Lane % GaussianCount;
+
+		// 和 GPU 一样输出 NaN 位置剔除被预算去掉的高斯
+		if (Payload.PositionOpacity[Index].W < InstanceData->MinOpacity)
 		{
-			UE_LOG(LogTemp, Log,
-			       TEXT(
-				       "USceneNiagaraInterface::GetCameraTransform - Found PlayerCameraManager: %s"
-			       ),
-			       *PC->PlayerCameraManager->GetName());
-			const APlayerCameraManager* CameraManager = PC->PlayerCameraManager;
+			OutPosition.SetAndAdvance(FVector4f(std::numeric_limits<float>::quiet_NaN()));
+			OutIndex.SetAndAdvance(INDEX_NONE);
+			OutColor.SetAndAdvance(FVector3f::ZeroVector);
+			continue;
+		}
 
-			const FVector CameraLocation = CameraManager->GetCameraLocation();
-			const FRotator CameraRotation = CameraManager->GetCameraRotation();
+		FVector4f Position;
+		FVector3f Color;
+		EvaluateGaussianData(Payload, Index, InstanceData->InstanceMatrices[Instance], InstanceData->ActorMatrix,
+		                     CameraPosition, Position, Color, InstanceData->MaxSHCoefficientsCount);
+		OutPosition.SetAndAdvance(Position);
+		OutIndex.SetAndAdvance(Index);
+		OutColor.SetAndAdvance(Color);
+	}
+}
 
-			return FTransform(CameraRotation, CameraLocation);
+void USceneNiagaraDataInterface::GetGaussianStaticDataVM(FVectorVMExternalFunctionContext& Context) const
+{
+	VectorVM::FUserPtrHandler<FNDIGaussianInstanceData> InstanceData(Context);
+	FNDIOutputParam<FVector4f> OutPosition(Context);
+	FNDIOutputParam<int32> OutIndex(Context);
+	FNDIOutputParam<FVector3f> OutBaseColor(Context);
+
+	const FSceneBufferRenderResource* RenderResource = InstanceData->RenderResource.Get();
+	const int32 GaussianCount = RenderResource ? RenderResource->GetGaussianCount() : 0;
+	const int32 TotalCount = GaussianCount * InstanceData->InstanceMatrices.Num();
+	if (TotalCount == 0)
+	{
+		for (int32 i = 0; i < Context.GetNumInstances(); ++i)
+		{
+			OutPosition.SetAndAdvance(FVector4f::Zero());
+			OutIndex.SetAndAdvance(INDEX_NONE);
+			OutBaseColor.SetAndAdvance(FVector3f::ZeroVector);
 		}
+		return;
 	}
-#if WITH_EDITOR
-	else
+
+	FReadScopeLock Lock(RenderResource->GetPayloadLock());
+	const FSceneGPUPayload& Payload = RenderResource->GetPayload();
+	const int32 StartInstance = Context.GetStartInstance();
+	for (int32 i = 0; i < Context.GetNumInstances(); ++i)
+	{
+		const int32 Lane = (StartInstance + i) % TotalCount;
+		const int32 Instance = Lane / GaussianCount;
+		const int32 Index = Lane % GaussianCount;
+
+		const VectorRegister4Float LocalPosition = VectorSet_W1(VectorLoad(&Payload.PositionOpacity[Index].X));
+		const VectorRegister4Float PositionInActor = VectorTransformVector(
+			LocalPosition, &InstanceData->InstanceMatrices[Instance]);
+		const VectorRegister4Float BaseColor = EvaluateGaussianColor(Payload, Index, GlobalVectorConstants::Float0001, 1);
+
+		FVector4f Position;
+		FVector3f Color;
+		VectorStore(PositionInActor, &Position.X);
+		VectorStoreFloat3(BaseColor, &Color.X);
+		OutPosition.SetAndAdvance(Position);
+		OutIndex.SetAndAdvance(Index);
+		OutBaseColor.SetAndAdvance(Color);
+	}
+}
+
+void USceneNiagaraDataInterface::GetGaussianViewColorVM(FVectorVMExternalFunctionContext& Context) const
+{
+	VectorVM::FUserPtrHandler<FNDIGaussianInstanceData> InstanceData(Context);
+	FNDIInputParam<int32> InIndex(Context);
+	FNDIInputParam<FVector4f> InPosition(Context);
+	FNDIOutputParam<FVector3f> OutColor(Context);
+
+	const FSceneBufferRenderResource* RenderResource = InstanceData->RenderResource.Get();
+	if (!RenderResource)
 	{
-		for (const auto LevelVC : GEditor->GetLevelViewportClients())
+		for (int32 i = 0; i < Context.GetNumInstances(); ++i)
 		{
-			if (LevelVC && LevelVC->IsPerspective())
-			{
-				const FVector CameraLocation = LevelVC->GetViewLocation();
-				const FRotator CameraRotation = LevelVC->GetViewRotation();
+			OutColor.SetAndAdvance(FVector3f::ZeroVector);
+		}
+		return;
+	}
 
-				return FTransform(CameraRotation, CameraLocation);
-			}
+	const int32 GaussianCount = RenderResource->GetGaussianCount();
+	FReadScopeLock Lock(RenderResource->GetPayloadLock());
+	const FSceneGPUPayload& Payload = RenderResource->GetPayload();
+	const FVector3f CameraLocation(InstanceData->CameraLocation);
+	const VectorRegister4Float CameraPosition = VectorLoadFloat3(&CameraLocation.X);
+
+	for (int32 i = 0; i < Context.GetNumInstances(); ++i)
+	{
+		const int32 Index = InIndex.GetAndAdvance();
+		const FVector4f Position = InPosition.GetAndAdvance();
+		if (Index < 0 || Index >= GaussianCount)
+		{
+			OutColor.SetAndAdvance(FVector3f::ZeroVector);
+			continue;
 		}
+
+		// 粒子上缓存的是 Actor 变换之前的位置
+		const VectorRegister4Float WorldPosition = VectorTransformVector(
+			VectorSet_W1(VectorLoad(&Position.X)), &InstanceData->ActorMatrix);
+		const VectorRegister4Float Direction = VectorNormalizeSafe(
+			VectorSet_W0(VectorSubtract(WorldPosition, CameraPosition)), GlobalVectorConstants::Float0001);
+
+		FVector3f Color;
+		VectorStoreFloat3(EvaluateGaussianColor(Payload, Index, Direction, InstanceData->MaxSHCoefficientsCount),
+		                  &Color.X);
+		OutColor.SetAndAdvance(Color);
 	}
-#endif
+}
 
-	return FTransform::Identity;
+void USceneNiagaraDataInterface::GetDataVersionVM(FVectorVMExternalFunctionContext& Context) const
+{
+	VectorVM::FUserPtrHandler<FNDIGaussianInstanceData> InstanceData(Context);
+	FNDIOutputParam<int32> OutVersion(Context);
+
+	const int32 Version = static_cast<int32>(InstanceData->GetDataVersion());
+	for (int32 i = 0; i < Context.GetNumInstances(); ++i)
+	{
+		OutVersion.SetAndAdvance(Version);
+	}
+}
+
+void USceneNiagaraDataInterface::EvaluateGaussianData(const FSceneGPUPayload& Payload, const int32 Index,
+                                                      const FMatrix44f& InstanceMatrix, const FMatrix44f& ActorMatrix,
+                                                      const FVector3f& CameraPosition, FVector4f& OutPosition,
+                                                      FVector3f& OutColor, const int32 MaxSHCoefficientsCount)
+{
+	// 行向量约定，和 Shader 中的 mul(Position, Matrix) 一致
+	const VectorRegister4Float LocalPosition = VectorSet_W1(VectorLoad(&Payload.PositionOpacity[Index].X));
+	const VectorRegister4Float PositionInActor = VectorTransformVector(LocalPosition, &InstanceMatrix);
+	const VectorRegister4Float WorldPosition = VectorTransformVector(PositionInActor, &ActorMatrix);
+	const VectorRegister4Float Direction = VectorNormalizeSafe(
+		VectorSet_W0(VectorSubtract(WorldPosition, VectorLoadFloat3(&CameraPosition.X))), GlobalVectorConstants::Float0001);
+
+	const VectorRegister4Float Result = EvaluateGaussianColor(Payload, Index, Direction, MaxSHCoefficientsCount);
+
+	VectorStore(PositionInActor, &OutPosition.X);
+	VectorStoreFloat3(Result, &OutColor.X);
+}
+
+FVector USceneNiagaraDataInterface::GetCameraLocation(const FNiagaraSystemInstance* SystemInstance) const
+{
+	// Niagara 在上一帧结束时缓存了渲染的视图，和 GPU 上的 PrimaryView 是同一个视图
+	if (const FNiagaraWorldManager* WorldManager = SystemInstance->GetWorldManager())
+	{
+		const TArrayView<const FNiagaraCachedViewInfo> CachedViewInfo = WorldManager->GetCachedViewInfo();
+		if (!CachedViewInfo.IsEmpty())
+		{
+			return CachedViewInfo[0].ViewToWorld.GetOrigin();
+		}
+	}
+	return FVector::ZeroVector;
 }
 
 FTransform USceneNiagaraDataInterface::GetActorTransform(FNiagaraSystemInstance* SystemInstance) const
 {
-	if (const AActor* Owner = SystemInstance->GetAttachComponent()->GetOwner())
+	// ASceneActor 的根组件就是 Niagara 组件，USceneInstancedComponent 可以挂在任意位置，所以使用组件的变换
+	if (const USceneComponent* AttachComponent = SystemInstance->GetAttachComponent())
 	{
-		return Owner->GetActorTransform();
+		return AttachComponent->GetComponentTransform();
 	}
 	return FTransform::Identity;
 }
@@ -0,0 +1,152 @@
+﻿#include "SceneQueryLibrary.h"
+
+#include "SceneActor.h"
+#include "SceneBufferAsset.h"
+
+namespace
+{
+	/// Actor 使用的资产在资产空间的 BVH，没有资产时返回 nullptr
+	TSharedPtr<const FSceneBVH, ESPMode::ThreadSafe> GetSceneBVH(const ASceneActor* SceneActor)
+	{
+		if (!IsValid(SceneActor) || !SceneActor->SceneNiagaraParameter)
+		{
+			return nullptr;
+		}
+		USceneBufferAsset* Asset = TSoftObjectPtr<USceneBufferAsset>(
+			SceneActor->SceneNiagaraParameter->SceneBufferAssetPath).LoadSynchronous();
+		return Asset ? Asset->GetBVH() : nullptr;
+	}
+
+	/// 把资产空间的命中结果转换到世界空间，法线按逆转置变换
+	FSceneRaycastHit ToWorld(const FSceneRaycastHit& LocalHit, const FTransform& Transform, const FVector& Start)
+	{
+		FSceneRaycastHit Hit = LocalHit;
+		if (Hit.bHit)
+		{
+			Hit.Location = Transform.TransformPosition(LocalHit.Location);
+			Hit.Normal = Transform.GetRotation().RotateVector(LocalHit.Normal / Transform.GetScale3D()).GetSafeNormal();
+			Hit.Distance = FVector::Dist(Start, Hit.Location);
+		}
+		return Hit;
+	}
+}
+
+FSceneRaycastHit USceneQueryLibrary::RaycastScene(ASceneActor* SceneActor, const FVector& Start, const FVector& End,
+                                                  const float OpacityThreshold)
+{
+	const TSharedPtr<const FSceneBVH, ESPMode::ThreadSafe> BVH = GetSceneBVH(SceneActor);
+	if (!BVH)
+	{
+		return {};
+	}
+
+	const FTransform Transform = SceneActor->GetActorTransform();
+	const FSceneRaycastHit LocalHit = BVH->Raycast(Transform.InverseTransformPosition(Start),
+	                                               Transform.InverseTransformPosition(End), OpacityThreshold);
+	return ToWorld(LocalHit, Transform, Start);
+}
+
+TArray<FSceneRaycastHit> USceneQueryLibrary::BatchRaycastScene(ASceneActor* SceneActor, const TArray<FVector>& Starts,
+                                                               const TArray<FVector>& Ends,
+                                                               const float OpacityThreshold)
+{
+	TArray<FSceneRaycastHit> Hits;
+	if (Starts.Num() != Ends.Num())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("BatchRaycastScene: %d starts but %d ends."), Starts.Num(), Ends.Num());
+		return Hits;
+	}
+
+	const TSharedPtr<const FSceneBVH, ESPMode::ThreadSafe> BVH = GetSceneBVH(SceneActor);
+	if (!BVH)
+	{
+		Hits.SetNum(Starts.Num());
+		return Hits;
+	}
+
+	const FTransform Transform = SceneActor->GetActorTransform();
+	TArray<FVector> LocalStarts;
+	TArray<FVector> LocalEnds;
+	LocalStarts.Reserve(Starts.Num());
+	LocalEnds.Reserve(Ends.Num());
+	for (int32 i = 0; i < Starts.Num(); ++i)
+	{
+		LocalStarts.Add(Transform.InverseTransformPosition(Starts[i]));
+		LocalEnds.Add(Transform.InverseTransformPosition(Ends[i]));
+	}
+
+	BVH->RaycastBatch(LocalStarts, LocalEnds, OpacityThreshold, Hits);
+	for (int32 i = 0; i < Hits.Num(); ++i)
+	{
+		Hits[i] = ToWorld(Hits[i], Transform, Starts[i]);
+	}
+	return Hits;
+}
+
+bool USceneQueryLibrary::FindNearestGaussian(ASceneActor* SceneActor, const FVector& Location, const float MaxDistance,
+                                             int32& OutGaussianIndex, FVector& OutGaussianLocation,
+                                             float& OutDistance)
+{
+	OutGaussianIndex = INDEX_NONE;
+	const TSharedPtr<const FSceneBVH, ESPMode::ThreadSafe> BVH = GetSceneBVH(SceneActor);
+	if (!BVH)
+	{
+		return false;
+	}
+
+	// 非均匀缩放时资产空间中最近的高斯不一定是世界空间中最近的，所以直接按世界空间的距离查找
+	const FTransform Transform = SceneActor->GetActorTransform();
+	double Distance;
+	const int32 Index = BVH->FindNearest(Location, MaxDistance, Distance, Transform);
+	if (Index == INDEX_NONE)
+	{
+		return false;
+	}
+
+	OutGaussianIndex = Index;
+	OutGaussianLocation = Transform.TransformPosition(BVH->GetGaussianPosition(Index));
+	OutDistance = Distance;
+	return true;
+}
+
+TArray<int32> USceneQueryLibrary::OverlapBox(ASceneActor* SceneActor, const FBox& Box)
+{
+	TArray<int32> Indices;
+	const TSharedPtr<const FSceneBVH, ESPMode::ThreadSafe> BVH = GetSceneBVH(SceneActor);
+	if (!BVH)
+	{
+		return Indices;
+	}
+
+	// 先用资产空间中包住世界包围盒的包围盒查询，再按世界坐标筛选
+	const FTransform Transform = SceneActor->GetActorTransform();
+	BVH->OverlapBox(Box.InverseTransformBy(Transform), Indices);
+	Indices.RemoveAllSwap([&Box, &Transform, &BVH](const int32 Index)
+	{
+		return !Box.IsInsideOrOn(Transform.TransformPosition(BVH->GetGaussianPosition(Index)));
+	}, EAllowShrinking::No);
+	Indices.Sort();
+	return Indices;
+}
+
+TArray<int32> USceneQueryLibrary::OverlapSphere(ASceneActor* SceneActor, const FVector& Center, const float Radius)
+{
+	TArray<int32> Indices;
+	const TSharedPtr<const FSceneBVH, ESPMode::ThreadSafe> BVH = GetSceneBVH(SceneActor);
+	if (!BVH)
+	{
+		return Indices;
+	}
+
+	const FTransform Transform = SceneActor->GetActorTransform();
+	const double MinScale = FMath::Max(Transform.GetMinimumAxisScale(), UE_DOUBLE_SMALL_NUMBER);
+	BVH->OverlapSphere(Transform.InverseTransformPosition(Center), Radius / MinScale, Indices);
+	const double RadiusSquared = FMath::Square(Radius);
+	Indices.RemoveAllSwap([&Center, &Transform, &BVH, RadiusSquared](const int32 Index)
+	{
+		return FVector::DistSquared(Transform.TransformPosition(BVH->GetGaussianPosition(Index)), Center) >
+			RadiusSquared;
+	}, EAllowShrinking::No);
+	Indices.Sort();
+	return Indices;
+}
@@ -0,0 +1,561 @@
+﻿#include "SceneStreamingManager.h"
+
+#include "GaussianSplattingXSettings.h"
+#include "GaussianSplattingXStats.h"
+#include "SceneBudgetController.h"
+#include "SceneBufferRenderResource.h"
+#include "SceneView.h"
+#include "SceneViewExtension.h"
+
+DECLARE_CYCLE_STAT(TEXT("Streaming Tick"), STAT_GaussianSplattingX_StreamingTick, STATGROUP_GaussianSplattingX);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Resident Chunks"), STAT_GaussianSplattingX_ResidentChunks,
+                           STATGROUP_GaussianSplattingX);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Requested Chunks"), STAT_GaussianSplattingX_RequestedChunks,
+                           STATGROUP_GaussianSplattingX);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Chunk Uploads"), STAT_GaussianSplattingX_ChunkUploads, STATGROUP_GaussianSplattingX);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Visible Gaussians"), STAT_GaussianSplattingX_VisibleGaussians,
+                           STATGROUP_GaussianSplattingX);
+DECLARE_MEMORY_STAT(TEXT("Splat Pool Memory"), STAT_GaussianSplattingX_PoolMemory, STATGROUP_GaussianSplattingX);
+DECLARE_MEMORY_STAT(TEXT("Uploaded Per Frame"), STAT_GaussianSplattingX_UploadedBytes, STATGROUP_GaussianSplattingX);
+
+namespace
+{
+	TUniquePtr<FSceneStreamingManager> StreamingManager;
+
+	/// 超过这么多帧没有被使用的资产会释放显存
+	constexpr uint64 InactiveFrames = 60;
+
+	constexpr int64 BytesPerMB = 1024 * 1024;
+
+	/// 按驻留状态生成 SlotTable，不满的 Chunk 所在的 Slot 放在最后，返回驻留的高斯数量
+	uint32 BuildSlotTable(const TArray<FSceneChunk>& Chunks, const TArray<int32>& SlotChunks,
+	                      TArray<uint32>& OutResidentSlots)
+	{
+		OutResidentSlots.Reset();
+		int32 PartialSlot = INDEX_NONE;
+		uint32 ResidentGaussianCount = 0;
+		for (int32 Slot = 0; Slot < SlotChunks.Num(); ++Slot)
+		{
+			const int32 ChunkIndex = SlotChunks[Slot];
+			if (ChunkIndex == INDEX_NONE)
+			{
+				continue;
+			}
+			ResidentGaussianCount += Chunks[ChunkIndex].Count;
+			if (Chunks[ChunkIndex].Count < FSceneChunk::MaxGaussians)
+			{
+				PartialSlot = Slot;
+				continue;
+			}
+			OutResidentSlots.Add(Slot);
+		}
+		if (PartialSlot != INDEX_NONE)
+		{
+			OutResidentSlots.Add(PartialSlot);
+		}
+		return ResidentGaussianCount;
+	}
+}
+
+/// 在 GT 上收集每一帧渲染的视图，作为下一帧流送的依据
+class FSceneStreamingViewExtension : public FSceneViewExtensionBase
+{
+public:
+	explicit FSceneStreamingViewExtension(const FAutoRegister& AutoRegister)
+		: FSceneViewExtensionBase(AutoRegister)
+	{
+	}
+
+	virtual void SetupViewFamily(FSceneViewFamily& InViewFamily) override
+	{
+	}
+
+	virtual void SetupView(FSceneViewFamily& InViewFamily, FSceneView& InView) override
+	{
+		FSceneStreamingView View;
+		View.Origin = InView.ViewMatrices.GetViewOrigin();
+		const FMatrix& ProjectionMatrix = InView.ViewMatrices.GetProjectionMatrix();
+		View.ProjectionScale = FMath::Max(ProjectionMatrix.M[0][0], ProjectionMatrix.M[1][1]);
+		View.Frustum = InView.ViewFrustum;
+		FSceneStreamingManager::Get().AddView(View);
+	}
+
+	virtual void BeginRenderViewFamily(FSceneViewFamily& InViewFamily) override
+	{
+	}
+};
+
+void FSceneStreamingManager::Startup()
+{
+	StreamingManager = MakeUnique<FSceneStreamingManager>();
+}
+
+void FSceneStreamingManager::Shutdown()
+{
+	StreamingManager.Reset();
+}
+
+FSceneStreamingManager& FSceneStreamingManager::Get()
+{
+	check(StreamingManager);
+	return *StreamingManager;
+}
+
+void FSceneStreamingManager::RegisterResource(
+	const TSharedPtr<FSceneBufferRenderResource, ESPMode::ThreadSafe>& Resource)
+{
+	check(IsInGameThread());
+	FResourceEntry& Entry = Entries.AddDefaulted_GetRef();
+	Entry.Resource = Resource;
+	Entry.SlotCount = Resource->GetResidency_GameThread().SlotChunks.Num();
+	Entry.TargetSlotCount = Entry.SlotCount;
+	Entry.LastUsedFrame = GFrameCounter;
+}
+
+void FSceneStreamingManager::AddView(const FSceneStreamingView& View)
+{
+	check(IsInGameThread());
+	PendingViews.Add(View);
+}
+
+void FSceneStreamingManager::SetResourceSuspended(const FSceneBufferRenderResource* Resource, const bool bSuspended)
+{
+	check(IsInGameThread());
+	for (FResourceEntry& Entry : Entries)
+	{
+		if (Entry.Resource.Pin().Get() == Resource)
+		{
+			Entry.bSuspended = bSuspended;
+		}
+	}
+}
+
+void FSceneStreamingManager::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_GaussianSplattingX_StreamingTick);
+
+	// 先根据上一帧的耗时更新预算，这一帧的驻留和绘制都使用新的预算
+	FSceneBudgetController::Update();
+	const FSceneSplatBudget& Budget = FSceneBudgetController::GetBudget();
+
+	if (!ViewExtension && GEngine)
+	{
+		ViewExtension = FSceneViewExtensions::NewExtension<FSceneStreamingViewExtension>();
+	}
+	if (!PendingViews.IsEmpty())
+	{
+		Views = MoveTemp(PendingViews);
+		PendingViews.Reset();
+	}
+
+	Entries.RemoveAll([](const FResourceEntry& Entry)
+	{
+		return !Entry.Resource.IsValid();
+	});
+
+	const UGaussianSplattingXSettings* Settings = GetDefault<UGaussianSplattingXSettings>();
+	const bool bStreaming = Settings->bEnableStreaming;
+
+	// 收集这一帧使用的实例，长时间没有被使用的资产不参与预算分配
+	TArray<FResourceEntry*> ActiveEntries;
+	for (FResourceEntry& Entry : Entries)
+	{
+		const TSharedPtr<FSceneBufferRenderResource, ESPMode::ThreadSafe> Resource = Entry.Resource.Pin();
+		FSceneBufferRenderResource::FResidency& Residency = Resource->GetResidency_GameThread();
+		if (!Residency.InstanceTransforms.IsEmpty())
+		{
+			Entry.InstanceTransforms = MoveTemp(Residency.InstanceTransforms);
+			Residency.InstanceTransforms.Reset();
+			Entry.LastUsedFrame = GFrameCounter;
+		}
+
+		if (Entry.bSuspended)
+		{
+			Entry.TargetSlotCount = 0;
+		}
+		else if (GFrameCounter - Entry.LastUsedFrame <= InactiveFrames)
+		{
+			ActiveEntries.Add(&Entry);
+			Entry.TargetSlotCount = bStreaming ? 0 : Resource->GetChunks().Num();
+		}
+		else
+		{
+			Entry.TargetSlotCount = bStreaming ? 0 : Entry.SlotCount;
+		}
+	}
+	if (bStreaming)
+	{
+		DistributeBudget(ActiveEntries, static_cast<int64>(Settings->StreamingBudgetMB) * BytesPerMB);
+	}
+
+	// 预算的变化没有超过滞后范围时保留当前的池，释放、分配和补全所有 Chunk 的变化总是立即生效
+	TArray<int32> NewSlotCounts;
+	NewSlotCounts.SetNumUninitialized(Entries.Num());
+	int64 NewPoolBytes = 0;
+	for (int32 i = 0; i < Entries.Num(); ++i)
+	{
+		const FResourceEntry& Entry = Entries[i];
+		const TSharedPtr<FSceneBufferRenderResource, ESPMode::ThreadSafe> Resource = Entry.Resource.Pin();
+		const bool bResize = Entry.TargetSlotCount == 0 || Entry.TargetSlotCount == Resource->GetChunks().Num() ||
+			FMath::Abs(Entry.TargetSlotCount - Entry.SlotCount) > Entry.SlotCount * Settings->PoolResizeHysteresis;
+		NewSlotCounts[i] = bResize ? Entry.TargetSlotCount : Entry.SlotCount;
+		NewPoolBytes += NewSlotCounts[i] * Resource->GetSlotBytes();
+	}
+	if (bStreaming && NewPoolBytes > static_cast<int64>(Settings->StreamingBudgetMB) * BytesPerMB)
+	{
+		for (int32 i = 0; i < Entries.Num(); ++i)
+		{
+			NewSlotCounts[i] = FMath::Min(NewSlotCounts[i], Entries[i].TargetSlotCount);
+		}
+	}
+
+	// 重新分配池时保留的 Chunk 在 GPU 上拷贝过去，缩小时先移出优先级最低的 Chunk
+	PoolBytes = 0;
+	for (int32 i = 0; i < Entries.Num(); ++i)
+	{
+		FResourceEntry& Entry = Entries[i];
+		if (NewSlotCounts[i] != Entry.SlotCount)
+		{
+			ResizePool(Entry, NewSlotCounts[i], *Settings);
+		}
+		PoolBytes += Entry.SlotCount * Entry.Resource.Pin()->GetSlotBytes();
+	}
+
+	// 按优先级替换驻留的 Chunk，每帧从不同的资产开始，所有资产共享上传预算
+	const bool bLimitUpload = bStreaming || Settings->bProgressiveLoading;
+	int64 UploadBudgetBytes = bLimitUpload ? static_cast<int64>(Settings->MaxUploadMBPerFrame) * BytesPerMB : MAX_int64;
+	int64 UploadedBytes = 0;
+	TArray<float> Priorities;
+	for (int32 i = 0; i < ActiveEntries.Num(); ++i)
+	{
+		const FResourceEntry& Entry = *ActiveEntries[(FirstUploadEntry + i) % ActiveEntries.Num()];
+		const TSharedPtr<FSceneBufferRenderResource, ESPMode::ThreadSafe> Resource = Entry.Resource.Pin();
+		ComputeEntryPriorities(Entry, *Settings, Priorities);
+		const int64 Uploaded = UpdateResidency(Resource, Priorities, UploadBudgetBytes - UploadedBytes,
+		                                       Budget.ResidentChunkScale);
+		UploadedBytes += Uploaded;
+	}
+	FirstUploadEntry = ActiveEntries.IsEmpty() ? 0 : (FirstUploadEntry + 1) % ActiveEntries.Num();
+
+	// 每个实例都绘制资产中所有驻留的高斯
+	int32 ResidentChunks = 0;
+	int64 VisibleGaussians = 0;
+	for (const FResourceEntry& Entry : Entries)
+	{
+		const TSharedPtr<FSceneBufferRenderResource, ESPMode::ThreadSafe> Resource = Entry.Resource.Pin();
+		const bool bActive = !Entry.bSuspended && GFrameCounter - Entry.LastUsedFrame <= InactiveFrames;
+		for (const int32 Chunk : Resource->GetResidency_GameThread().SlotChunks)
+		{
+			if (Chunk != INDEX_NONE)
+			{
+				++ResidentChunks;
+				VisibleGaussians += bActive ? Resource->GetChunks()[Chunk].Count * Entry.InstanceTransforms.Num() : 0;
+			}
+		}
+	}
+	VisibleGaussianCount = VisibleGaussians;
+	SET_DWORD_STAT(STAT_GaussianSplattingX_ResidentChunks, ResidentChunks);
+	SET_DWORD_STAT(STAT_GaussianSplattingX_VisibleGaussians, VisibleGaussians);
+	SET_MEMORY_STAT(STAT_GaussianSplattingX_PoolMemory, PoolBytes);
+	SET_MEMORY_STAT(STAT_GaussianSplattingX_UploadedBytes, UploadedBytes);
+}
+
+TStatId FSceneStreamingManager::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(FSceneStreamingManager, STATGROUP_Tickables);
+}
+
+void FSceneStreamingManager::DistributeBudget(TArray<FResourceEntry*>& ActiveEntries, const int64 BudgetBytes)
+{
+	// 需求小的资产先分配，分不完的预算留给后面的资产
+	const auto GetNeededBytes = [](const FResourceEntry& Entry)
+	{
+		const TSharedPtr<FSceneBufferRenderResource, ESPMode::ThreadSafe> Resource = Entry.Resource.Pin();
+		return Resource->GetChunks().Num() * Resource->GetSlotBytes();
+	};
+	ActiveEntries.Sort([&GetNeededBytes](const FResourceEntry& A, const FResourceEntry& B)
+	{
+		return GetNeededBytes(A) < GetNeededBytes(B);
+	});
+
+	int64 RemainingBytes = BudgetBytes;
+	for (int32 i = 0; i < ActiveEntries.Num(); ++i)
+	{
+		FResourceEntry& Entry = *ActiveEntries[i];
+		const int64 SlotBytes = Entry.Resource.Pin()->GetSlotBytes();
+		const int64 ShareBytes = RemainingBytes / (ActiveEntries.Num() - i);
+		const int64 GrantedBytes = FMath::Min(GetNeededBytes(Entry), ShareBytes);
+
+		Entry.TargetSlotCount = static_cast<int32>(GrantedBytes / SlotBytes);
+		RemainingBytes -= Entry.TargetSlotCount * SlotBytes;
+	}
+}
+
+void FSceneStreamingManager::ComputePriorities(const FSceneBufferRenderResource& Resource,
+                                               const TArray<FTransform>& InstanceTransforms,
+                                               const float MinScreenCoverage, const float OutOfViewPriorityScale,
+                                               TArray<float>& OutPriorities) const
+{
+	const TArray<FSceneChunk>& Chunks = Resource.GetChunks();
+	OutPriorities.Init(0.0f, Chunks.Num());
+
+	double TotalImportance = 0.0;
+	for (const FSceneChunk& Chunk : Chunks)
+	{
+		TotalImportance += Chunk.Importance;
+	}
+	const double MeanImportance = FMath::Max(TotalImportance / FMath::Max(Chunks.Num(), 1), UE_DOUBLE_SMALL_NUMBER);
+
+	for (int32 ChunkIndex = 0; ChunkIndex < Chunks.Num(); ++ChunkIndex)
+	{
+		const FSceneChunk& Chunk = Chunks[ChunkIndex];
+		const double Importance = FMath::Max(Chunk.Importance / MeanImportance, 0.01);
+
+		// 还没有渲染过任何视图时只按重要性排序
+		if (Views.IsEmpty())
+		{
+			OutPriorities[ChunkIndex] = Importance;
+			continue;
+		}
+
+		for (const FTransform& Transform : InstanceTransforms)
+		{
+			const FBox WorldBounds = Chunk.Bounds.TransformBy(Transform);
+			const FVector Center = WorldBounds.GetCenter();
+			const double Radius = WorldBounds.GetExtent().Size();
+
+			for (const FSceneStreamingView& View : Views)
+			{
+				// 包围球投影到屏幕上的面积占整个屏幕的比例，相机在包围球内时认为覆盖整个屏幕
+				const double Distance = FVector::Distance(Center, View.Origin);
+				double Coverage = 1.0;
+				if (Distance > Radius)
+				{
+					Coverage = FMath::Min(UE_DOUBLE_PI / 4.0 * FMath::Square(Radius * View.ProjectionScale / Distance),
+					                      1.0);
+				}
+				if (Coverage < MinScreenCoverage)
+				{
+					continue;
+				}
+				if (!View.Frustum.IntersectSphere(Center, Radius))
+				{
+					Coverage *= OutOfViewPriorityScale;
+				}
+
+				OutPriorities[ChunkIndex] = FMath::Max<float>(OutPriorities[ChunkIndex], Coverage * Importance);
+			}
+		}
+	}
+}
+
+void FSceneStreamingManager::ComputeEntryPriorities(const FResourceEntry& Entry,
+                                                    const UGaussianSplattingXSettings& Settings,
+                                                    TArray<float>& OutPriorities) const
+{
+	const TSharedPtr<FSceneBufferRenderResource, ESPMode::ThreadSafe> Resource = Entry.Resource.Pin();
+	if (Settings.bEnableStreaming)
+	{
+		ComputePriorities(*Resource, Entry.InstanceTransforms, Settings.MinScreenCoverage,
+		                  Settings.OutOfViewPriorityScale, OutPriorities);
+		return;
+	}
+
+	// 所有 Chunk 最终都会驻留，只决定上传的先后，对画面贡献大的先上传，优先级为 0 的 Chunk 不会被请求
+	const TArray<FSceneChunk>& Chunks = Resource->GetChunks();
+	OutPriorities.SetNumUninitialized(Chunks.Num());
+	for (int32 ChunkIndex = 0; ChunkIndex < Chunks.Num(); ++ChunkIndex)
+	{
+		OutPriorities[ChunkIndex] = FMath::Max(Chunks[ChunkIndex].Importance, UE_SMALL_NUMBER);
+	}
+}
+
+void FSceneStreamingManager::ResizePool(FResourceEntry& Entry, const int32 NewSlotCount,
+                                        const UGaussianSplattingXSettings& Settings) const
+{
+	const TSharedPtr<FSceneBufferRenderResource, ESPMode::ThreadSafe> Resource = Entry.Resource.Pin();
+	FSceneBufferRenderResource::FResidency& Residency = Resource->GetResidency_GameThread();
+
+	// 放不下所有驻留的 Chunk 时只保留优先级最高的
+	TArray<int32> KeptSlots;
+	for (int32 Slot = 0; Slot < Residency.SlotChunks.Num(); ++Slot)
+	{
+		if (Residency.SlotChunks[Slot] != INDEX_NONE)
+		{
+			KeptSlots.Add(Slot);
+		}
+	}
+	if (KeptSlots.Num() > NewSlotCount)
+	{
+		TArray<float> Priorities;
+		ComputeEntryPriorities(Entry, Settings, Priorities);
+		KeptSlots.Sort([&Residency, &Priorities](const int32 A, const int32 B)
+		{
+			return Priorities[Residency.SlotChunks[A]] > Priorities[Residency.SlotChunks[B]];
+		});
+		KeptSlots.SetNum(NewSlotCount);
+		KeptSlots.Sort();
+	}
+
+	// 保留的 Chunk 按原来的顺序放在新池的最前面
+	TArray<int32> SlotRemap;
+	SlotRemap.Init(INDEX_NONE, NewSlotCount);
+	TArray<int32> SlotChunks;
+	SlotChunks.Init(INDEX_NONE, NewSlotCount);
+	Residency.ChunkSlots.Init(INDEX_NONE, Resource->GetChunks().Num());
+	for (int32 Slot = 0; Slot < KeptSlots.Num(); ++Slot)
+	{
+		const int32 ChunkIndex = Residency.SlotChunks[KeptSlots[Slot]];
+		SlotRemap[Slot] = KeptSlots[Slot];
+		SlotChunks[Slot] = ChunkIndex;
+		Residency.ChunkSlots[ChunkIndex] = Slot;
+	}
+	Residency.SlotChunks = MoveTemp(SlotChunks);
+	Entry.SlotCount = NewSlotCount;
+
+	TArray<uint32> ResidentSlots;
+	const uint32 ResidentGaussianCount = BuildSlotTable(Resource->GetChunks(), Residency.SlotChunks, ResidentSlots);
+	ENQUEUE_RENDER_COMMAND(ResizeSceneSlotPool)(
+		[Resource, NewSlotCount, SlotRemap = MoveTemp(SlotRemap), ResidentSlots = MoveTemp(ResidentSlots),
+			ResidentGaussianCount](FRHICommandListImmediate& RHICmdList)
+		{
+			if (Resource->IsInitialized())
+			{
+				Resource->ResizePool_RenderThread(RHICmdList, NewSlotCount, SlotRemap);
+				Resource->UpdateSlotTable_RenderThread(RHICmdList, ResidentSlots, ResidentGaussianCount);
+			}
+		});
+}
+
+int64 FSceneStreamingManager::UpdateResidency(
+	const TSharedPtr<FSceneBufferRenderResource, ESPMode::ThreadSafe>& Resource, const TArray<float>& Priorities,
+	const int64 UploadBudgetBytes, const float ResidentChunkScale)
+{
+	FSceneBufferRenderResource::FResidency& Residency = Resource->GetResidency_GameThread();
+	const TArray<FSceneChunk>& Chunks = Resource->GetChunks();
+	const int32 SlotCount = Residency.SlotChunks.Num();
+	if (SlotCount == 0)
+	{
+		return 0;
+	}
+	const int32 MaxResidentChunks = FMath::Clamp(FMath::CeilToInt(SlotCount * ResidentChunkScale), 1, SlotCount);
+
+	// 期望驻留的 Chunk：优先级最高的 SlotCount 个
+	TArray<int32> Requested;
+	for (int32 ChunkIndex = 0; ChunkIndex < Chunks.Num(); ++ChunkIndex)
+	{
+		if (Priorities[ChunkIndex] > 0.0f)
+		{
+			Requested.Add(ChunkIndex);
+		}
+	}
+	Requested.Sort([&Priorities](const int32 A, const int32 B)
+	{
+		return Priorities[A] > Priorities[B];
+	});
+	Requested.SetNum(FMath::Min(Requested.Num(), MaxResidentChunks));
+
+	TBitArray<> bRequested(false, Chunks.Num());
+	for (const int32 ChunkIndex : Requested)
+	{
+		bRequested[ChunkIndex] = true;
+	}
+
+	// 可以使用的 Slot：先用空的，再替换不在期望集合中且优先级最低的
+	TArray<int32> EmptySlots;
+	TArray<int32> EvictableSlots;
+	for (int32 Slot = 0; Slot < SlotCount; ++Slot)
+	{
+		const int32 ChunkIndex = Residency.SlotChunks[Slot];
+		if (ChunkIndex == INDEX_NONE)
+		{
+			EmptySlots.Add(Slot);
+		}
+		else if (!bRequested[ChunkIndex])
+		{
+			EvictableSlots.Add(Slot);
+		}
+	}
+	EvictableSlots.Sort([&Residency, &Priorities](const int32 A, const int32 B)
+	{
+		return Priorities[Residency.SlotChunks[A]] < Priorities[Residency.SlotChunks[B]];
+	});
+	EmptySlots.Append(EvictableSlots);
+
+	const int64 BytesPerGaussian = sizeof(FVector4f) * (3 + Resource->GetSHCoefficientsCount());
+	TArray<TPair<int32, int32>> Uploads;
+	int64 UploadedBytes = 0;
+	int32 RequestedChunks = 0;
+	for (const int32 ChunkIndex : Requested)
+	{
+		if (Residency.ChunkSlots[ChunkIndex] != INDEX_NONE)
+		{
+			continue;
+		}
+		++RequestedChunks;
+
+		const int64 ChunkBytes = Chunks[ChunkIndex].Count * BytesPerGaussian;
+		if (Uploads.Num() >= EmptySlots.Num() || UploadedBytes + ChunkBytes > UploadBudgetBytes)
+		{
+			continue;
+		}
+
+		const int32 Slot = EmptySlots[Uploads.Num()];
+		if (const int32 EvictedChunk = Residency.SlotChunks[Slot]; EvictedChunk != INDEX_NONE)
+		{
+			Residency.ChunkSlots[EvictedChunk] = INDEX_NONE;
+		}
+		Residency.SlotChunks[Slot] = ChunkIndex;
+		Residency.ChunkSlots[ChunkIndex] = Slot;
+		Uploads.Emplace(ChunkIndex, Slot);
+		UploadedBytes += ChunkBytes;
+	}
+	INC_DWORD_STAT_BY(STAT_GaussianSplattingX_RequestedChunks, RequestedChunks);
+	INC_DWORD_STAT_BY(STAT_GaussianSplattingX_ChunkUploads, Uploads.Num());
+
+	// 没有预算限制时不在期望集合中的 Chunk 仍然留在 Slot 中，预算降低后按优先级从低到高移出，不再绘制
+	int32 ResidentChunks = 0;
+	for (const int32 ChunkIndex : Residency.SlotChunks)
+	{
+		ResidentChunks += ChunkIndex != INDEX_NONE;
+	}
+	bool bEvicted = false;
+	for (int32 i = 0; i < EvictableSlots.Num() && ResidentChunks > MaxResidentChunks; ++i)
+	{
+		const int32 Slot = EvictableSlots[i];
+		const int32 ChunkIndex = Residency.SlotChunks[Slot];
+		if (ChunkIndex == INDEX_NONE || bRequested[ChunkIndex])
+		{
+			continue;
+		}
+		Residency.ChunkSlots[ChunkIndex] = INDEX_NONE;
+		Residency.SlotChunks[Slot] = INDEX_NONE;
+		--ResidentChunks;
+		bEvicted = true;
+	}
+
+	if (Uploads.IsEmpty() && !bEvicted)
+	{
+		return 0;
+	}
+
+	// Shader 按 SlotTable 把连续的下标映射到 Slot，只有最后一个 Slot 可以不满
+	TArray<uint32> ResidentSlots;
+	const uint32 ResidentGaussianCount = BuildSlotTable(Chunks, Residency.SlotChunks, ResidentSlots);
+
+	ENQUEUE_RENDER_COMMAND(UploadSceneChunks)(
+		[Resource, Uploads = MoveTemp(Uploads), ResidentSlots = MoveTemp(ResidentSlots), ResidentGaussianCount](
+		FRHICommandListImmediate& RHICmdList)
+		{
+			if (!Resource->IsInitialized())
+			{
+				return;
+			}
+			for (const TPair<int32, int32>& Upload : Uploads)
+			{
+				Resource->UploadChunk_RenderThread(RHICmdList, Upload.Key, Upload.Value);
+			}
+			Resource->UpdateSlotTable_RenderThread(RHICmdList, ResidentSlots, ResidentGaussianCount);
+		});
+	return UploadedBytes;
+}
@@ -0,0 +1,32 @@
+﻿#include "SceneTilePrevFrameHZB.h"
+
+#include "Misc/EngineVersionComparison.h"
+#include "SceneTileRasterizer.h"
+
+// FPreviousViewInfo 的布局在不同引擎版本之间会变化，升级引擎后需要重新确认再放开版本范围
+#define GAUSSIANSPLATTINGX_PREV_FRAME_HZB (!UE_VERSION_OLDER_THAN(5, 5, 0) && UE_VERSION_OLDER_THAN(5, 6, 0))
+
+#if GAUSSIANSPLATTINGX_PREV_FRAME_HZB
+#include "ScenePrivate.h"
+#endif
+
+bool GetSceneTilePrevFrameOcclusion(FRDGBuilder& GraphBuilder, const FSceneView& View,
+                                    FSceneTileOcclusion& OutOcclusion)
+{
+#if GAUSSIANSPLATTINGX_PREV_FRAME_HZB
+	const FSceneViewState* ViewState = View.State ? View.State->GetConcreteViewState() : nullptr;
+	if (!ViewState || !ViewState->PrevFrameViewInfo.HZB)
+	{
+		return false;
+	}
+
+	const FPreviousViewInfo& PrevViewInfo = ViewState->PrevFrameViewInfo;
+	OutOcclusion.HZB = GraphBuilder.RegisterExternalTexture(PrevViewInfo.HZB);
+	OutOcclusion.TranslatedWorldToClip = PrevViewInfo.ViewMatrices.GetTranslatedViewProjectionMatrix();
+	OutOcclusion.PreViewTranslation = PrevViewInfo.ViewMatrices.GetPreViewTranslation();
+	OutOcclusion.ViewRect = PrevViewInfo.ViewRect;
+	return true;
+#else
+	return false;
+#endif
+}
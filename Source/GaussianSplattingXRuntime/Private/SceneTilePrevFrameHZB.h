@@ -0,0 +1,14 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "RenderGraphFwd.h"
+
+class FSceneView;
+struct FSceneTileOcclusion;
+
+/// 读取引擎在视图状态中保留的上一帧 HZB 和生成它时的视图
+/// @note 引擎没有公开上一帧的 HZB，这是插件中唯一依赖 Renderer 私有头文件（ScenePrivate.h）的地方。
+/// 只在验证过的引擎版本上启用，其他版本总是返回 false，预处理退回到不做遮挡剔除
+/// @return 视图没有状态或上一帧没有生成 HZB 时返回 false
+bool GetSceneTilePrevFrameOcclusion(FRDGBuilder& GraphBuilder, const FSceneView& View,
+                                    FSceneTileOcclusion& OutOcclusion);
@@ -0,0 +1,325 @@
+﻿#include "SceneTileRenderer.h"
+
+#include "FXRenderingUtils.h"
+#include "SceneBudgetController.h"
+#include "SceneBufferRenderResource.h"
+#include "SceneRenderTargetParameters.h"
+#include "SceneTilePrevFrameHZB.h"
+#include "SceneTileRasterizer.h"
+#include "SceneViewExtension.h"
+#include "StereoRendering.h"
+#include "PostProcess/PostProcessInputs.h"
+#include "RenderGraphBuilder.h"
+
+DECLARE_GPU_STAT_NAMED(GaussianSplattingXTileRaster, TEXT("GaussianSplattingX Tile Raster"));
+
+TSharedPtr<FSceneTileViewExtension, ESPMode::ThreadSafe> FSceneTileRenderer::ViewExtension;
+
+/// 在 GT 上收集这一帧提交的实例，在后处理之前光栅化
+class FSceneTileViewExtension : public FSceneViewExtensionBase
+{
+public:
+	explicit FSceneTileViewExtension(const FAutoRegister& AutoRegister)
+		: FSceneViewExtensionBase(AutoRegister)
+	{
+	}
+
+	void AddInstance_GameThread(const TSharedPtr<FSceneBufferRenderResource, ESPMode::ThreadSafe>& Resource,
+	                            const FTransform& LocalToWorld)
+	{
+		if (PendingFrame != GFrameCounter)
+		{
+			PendingInstances.Reset();
+			PendingFrame = GFrameCounter;
+		}
+		PendingInstances.Add({Resource, LocalToWorld.ToMatrixWithScale()});
+	}
+
+	virtual void SetupViewFamily(FSceneViewFamily& InViewFamily) override
+	{
+	}
+
+	virtual void SetupView(FSceneViewFamily& InViewFamily, FSceneView& InView) override
+	{
+	}
+
+	virtual void BeginRenderViewFamily(FSceneViewFamily& InViewFamily) override
+	{
+		// 这一帧没有 Actor 提交时清空 RT 上的列表
+		TArray<FInstance> Instances;
+		if (PendingFrame == GFrameCounter)
+		{
+			Instances = PendingInstances;
+		}
+
+		ENQUEUE_RENDER_COMMAND(UpdateSceneTileInstances)(
+			[Extension = StaticCastSharedRef<FSceneTileViewExtension>(AsShared()), Instances = MoveTemp(Instances),
+				Budget = FSceneBudgetController::GetBudget()](FRHICommandListImmediate& RHICmdList) mutable
+			{
+				Extension->Instances_RenderThread = MoveTemp(Instances);
+				Extension->Budget_RenderThread = Budget;
+			});
+	}
+
+	virtual void PreRenderViewFamily_RenderThread(FRDGBuilder& GraphBuilder, FSceneViewFamily& InViewFamily) override
+	{
+		ResolveGPUTimers_RenderThread();
+
+		// 预处理不依赖场景纹理，在渲染开始时就加入图中，和 BasePass 在异步计算队列上重叠
+		RDG_GPU_STAT_SCOPE(GraphBuilder, GaussianSplattingXTileRaster);
+		TArray<FSceneTileRasterInput, TInlineAllocator<8>> RasterInputs;
+		GatherRasterInputs(GraphBuilder, RasterInputs);
+
+		// 不在异步计算队列上时预处理和排序直接占用图形队列，计入高斯的耗时
+		FGPUTimer* Timer = !RasterInputs.IsEmpty() && !IsSceneTilePreprocessAsync()
+			                   ? BeginGPUTimer_RenderThread(GraphBuilder)
+			                   : nullptr;
+		for (int32 ViewIndex = 0; ViewIndex < InViewFamily.Views.Num(); ++ViewIndex)
+		{
+			const FSceneView* View = InViewFamily.Views[ViewIndex];
+			const FIntRect ViewRect = UE::FXRenderingUtils::GetRawViewRectUnsafe(*View);
+
+			// 立体渲染的一对视图共享一次预处理
+			const FSceneView* NextView = ViewIndex + 1 < InViewFamily.Views.Num()
+				                             ? InViewFamily.Views[ViewIndex + 1]
+				                             : nullptr;
+			if (NextView && IStereoRendering::IsStereoEyeView(*View) && IStereoRendering::IsAPrimaryView(*View) &&
+				IStereoRendering::IsASecondaryView(*NextView))
+			{
+				FSceneTilePreprocessOutput Left;
+				FSceneTilePreprocessOutput Right;
+				AddSceneTileStereoPreprocessPasses(GraphBuilder, *View, ViewRect, *NextView,
+				                                   UE::FXRenderingUtils::GetRawViewRectUnsafe(*NextView), RasterInputs,
+				                                   TileEntryCapacity_RenderThread, GetOcclusion(GraphBuilder, *View),
+				                                   GetOcclusion(GraphBuilder, *NextView), Left, Right);
+				AddPreprocessed(View, Left);
+				AddPreprocessed(NextView, Right);
+				++ViewIndex;
+				continue;
+			}
+
+			AddPreprocessed(View, AddSceneTilePreprocessPasses(GraphBuilder, *View, ViewRect, RasterInputs,
+			                                                   TileEntryCapacity_RenderThread,
+			                                                   GetOcclusion(GraphBuilder, *View)));
+		}
+		EndGPUTimer_RenderThread(GraphBuilder, Timer);
+	}
+
+	virtual void PrePostProcessPass_RenderThread(FRDGBuilder& GraphBuilder, const FSceneView& View,
+	                                             const FPostProcessingInputs& Inputs) override
+	{
+		const FIntRect ViewRect = UE::FXRenderingUtils::GetRawViewRectUnsafe(View);
+		FSceneTilePreprocessOutput Preprocessed;
+		if (const FSceneTilePreprocessOutput* Found = Preprocessed_RenderThread.Find(&View))
+		{
+			Preprocessed = *Found;
+		}
+
+		// 渲染开始时视图范围还没有确定的话，在这里按最终的范围重新预处理
+		RDG_GPU_STAT_SCOPE(GraphBuilder, GaussianSplattingXTileRaster);
+		FGPUTimer* Timer = nullptr;
+		if (!Preprocessed.IsValid() || Preprocessed.ViewRect != ViewRect)
+		{
+			TArray<FSceneTileRasterInput, TInlineAllocator<8>> RasterInputs;
+			GatherRasterInputs(GraphBuilder, RasterInputs);
+			if (!RasterInputs.IsEmpty() && !IsSceneTilePreprocessAsync())
+			{
+				Timer = BeginGPUTimer_RenderThread(GraphBuilder);
+			}
+			Preprocessed = AddSceneTilePreprocessPasses(GraphBuilder, View, ViewRect, RasterInputs,
+			                                            TileEntryCapacity_RenderThread, GetOcclusion(GraphBuilder, View));
+		}
+		if (!Preprocessed.IsValid())
+		{
+			EndGPUTimer_RenderThread(GraphBuilder, Timer);
+			return;
+		}
+
+		Inputs.Validate();
+		const FSceneTextureUniformParameters& SceneTextures = *Inputs.SceneTextures->GetParameters();
+		if (!Timer)
+		{
+			Timer = BeginGPUTimer_RenderThread(GraphBuilder);
+		}
+		AddSceneTileRasterizePasses(GraphBuilder, View, Preprocessed, SceneTextures.SceneColorTexture,
+		                            SceneTextures.SceneDepthTexture);
+		EndGPUTimer_RenderThread(GraphBuilder, Timer);
+	}
+
+	virtual void PostRenderViewFamily_RenderThread(FRDGBuilder& GraphBuilder, FSceneViewFamily& InViewFamily) override
+	{
+		// RDG 资源只在这一个图中有效
+		Preprocessed_RenderThread.Reset();
+	}
+
+private:
+	struct FInstance
+	{
+		TSharedPtr<FSceneBufferRenderResource, ESPMode::ThreadSafe> Resource;
+		FMatrix LocalToWorld;
+	};
+
+	TArray<FInstance> PendingInstances;
+	uint64 PendingFrame = 0;
+
+	/// 一段图形队列上的高斯 Pass 的时间戳，一帧中所有段的耗时相加：每个视图的光栅化和合成，
+	/// 以及不在异步计算队列上时的预处理和排序；在异步计算队列上时它们和 BasePass 重叠，不计入
+	struct FGPUTimer
+	{
+		FRHIPooledRenderQuery Begin;
+		FRHIPooledRenderQuery End;
+		uint32 FrameNumber = 0;
+	};
+
+	FGPUTimer* BeginGPUTimer_RenderThread(FRDGBuilder& GraphBuilder)
+	{
+		if (!GSupportsTimestampRenderQueries)
+		{
+			return nullptr;
+		}
+		if (!TimerQueryPool)
+		{
+			TimerQueryPool = RHICreateRenderQueryPool(RQT_AbsoluteTime);
+		}
+
+		// 查询一直没有结果时丢弃最旧的，避免无限增长
+		if (GPUTimers_RenderThread.Num() >= MaxPendingGPUTimers)
+		{
+			GPUTimers_RenderThread.RemoveAt(0);
+		}
+		FGPUTimer* Timer = GPUTimers_RenderThread.Add_GetRef(MakeUnique<FGPUTimer>()).Get();
+		Timer->Begin = TimerQueryPool->AllocateQuery();
+		Timer->End = TimerQueryPool->AllocateQuery();
+		Timer->FrameNumber = GFrameNumberRenderThread;
+		AddTimestampPass(GraphBuilder, Timer->Begin.GetQuery());
+		return Timer;
+	}
+
+	static void EndGPUTimer_RenderThread(FRDGBuilder& GraphBuilder, const FGPUTimer* Timer)
+	{
+		if (Timer)
+		{
+			AddTimestampPass(GraphBuilder, Timer->End.GetQuery());
+		}
+	}
+
+	static void AddTimestampPass(FRDGBuilder& GraphBuilder, FRHIRenderQuery* Query)
+	{
+		GraphBuilder.AddPass(RDG_EVENT_NAME("Timestamp"), ERDGPassFlags::NeverCull,
+		                     [Query](FRHICommandList& RHICmdList)
+		                     {
+			                     RHICmdList.EndRenderQuery(Query);
+		                     });
+	}
+
+	/// 时间戳通常在几帧之后才可用，一帧中所有视图的查询都有结果并且已经开始了新的一帧时，把总耗时报告给预算控制器
+	void ResolveGPUTimers_RenderThread()
+	{
+		while (!GPUTimers_RenderThread.IsEmpty())
+		{
+			const uint32 FrameNumber = GPUTimers_RenderThread[0]->FrameNumber;
+			uint64 FrameMicroseconds = 0;
+			int32 Count = 0;
+			for (; Count < GPUTimers_RenderThread.Num() && GPUTimers_RenderThread[Count]->FrameNumber == FrameNumber;
+			       ++Count)
+			{
+				const FGPUTimer& Timer = *GPUTimers_RenderThread[Count];
+				uint64 Begin = 0;
+				uint64 End = 0;
+				if (!RHIGetRenderQueryResult(Timer.Begin.GetQuery(), Begin, false) ||
+					!RHIGetRenderQueryResult(Timer.End.GetQuery(), End, false))
+				{
+					return;
+				}
+				FrameMicroseconds += End > Begin ? End - Begin : 0;
+			}
+			if (Count == GPUTimers_RenderThread.Num())
+			{
+				return;
+			}
+
+			GPUTimers_RenderThread.RemoveAt(0, Count);
+			FSceneBudgetController::ReportSplatGPUTime_RenderThread(FrameMicroseconds / 1000.0f);
+		}
+	}
+
+	void AddPreprocessed(const FSceneView* View, const FSceneTilePreprocessOutput& Preprocessed)
+	{
+		if (Preprocessed.IsValid())
+		{
+			Preprocessed_RenderThread.Add(View, Preprocessed);
+		}
+	}
+
+	/// 上一帧的 HZB，预处理在 BasePass 之前，这一帧的 HZB 还没有生成
+	/// @note 镜头切换后上一帧的深度和这一帧无关，没有视图状态或上一帧没有生成 HZB 时也不剔除
+	static FSceneTileOcclusion GetOcclusion(FRDGBuilder& GraphBuilder, const FSceneView& View)
+	{
+		FSceneTileOcclusion Occlusion;
+		if (View.bCameraCut || View.bPrevTransformsReset ||
+			!GetSceneTilePrevFrameOcclusion(GraphBuilder, View, Occlusion))
+		{
+			return FSceneTileOcclusion();
+		}
+		return Occlusion;
+	}
+
+	/// 把这一帧的实例的常驻 Buffer 注册到 RDG 中
+	void GatherRasterInputs(FRDGBuilder& GraphBuilder,
+	                        TArray<FSceneTileRasterInput, TInlineAllocator<8>>& RasterInputs) const
+	{
+		for (const FInstance& Instance : Instances_RenderThread)
+		{
+			const FSceneBufferRenderResource& Resource = *Instance.Resource;
+			if (!Resource.IsInitialized() || Resource.GetResidentGaussianCount_RenderThread() == 0)
+			{
+				continue;
+			}
+
+			FSceneTileRasterInput& RasterInput = RasterInputs.AddDefaulted_GetRef();
+			RasterInput.PositionOpacityBuffer = Resource.PositionOpacityBuffer.Register(GraphBuilder);
+			RasterInput.ScaleBuffer = Resource.ScaleBuffer.Register(GraphBuilder);
+			RasterInput.RotationBuffer = Resource.RotationBuffer.Register(GraphBuilder);
+			RasterInput.SHCoefficientsBuffer = Resource.SHCoefficientsBuffer.Register(GraphBuilder);
+			RasterInput.SlotTableBuffer = Resource.SlotTableBuffer.Register(GraphBuilder);
+			RasterInput.SlotBoundsBuffer = Resource.SlotBoundsBuffer.Register(GraphBuilder);
+			RasterInput.ResidentGaussianCount = Resource.GetResidentGaussianCount_RenderThread();
+			RasterInput.ChunkSize = FSceneChunk::MaxGaussians;
+			RasterInput.SHCoefficientsCount = Resource.GetSHCoefficientsCount();
+			RasterInput.MinOpacity = Budget_RenderThread.MinOpacity;
+			RasterInput.MaxSHCoefficientsCount = Budget_RenderThread.MaxSHCoefficientsCount;
+			RasterInput.LocalToWorld = Instance.LocalToWorld;
+		}
+	}
+
+	TArray<FInstance> Instances_RenderThread;
+
+	/// 这一帧的绘制预算，在 GT 上从 FSceneBudgetController 复制
+	FSceneSplatBudget Budget_RenderThread;
+
+	/// 渲染开始时添加的预处理结果，按视图查找
+	TMap<const FSceneView*, FSceneTilePreprocessOutput> Preprocessed_RenderThread;
+
+	/// 所有视图共用，按之前读回的 Tile 条目数量分配排序的列表
+	FSceneTileEntryCapacity TileEntryCapacity_RenderThread;
+
+	static constexpr int32 MaxPendingGPUTimers = 64;
+	FRenderQueryPoolRHIRef TimerQueryPool;
+	TArray<TUniquePtr<FGPUTimer>> GPUTimers_RenderThread;
+};
+
+void FSceneTileRenderer::Shutdown()
+{
+	ViewExtension.Reset();
+}
+
+void FSceneTileRenderer::AddInstance_GameThread(
+	const TSharedPtr<FSceneBufferRenderResource, ESPMode::ThreadSafe>& Resource, const FTransform& LocalToWorld)
+{
+	check(IsInGameThread());
+	if (!ViewExtension)
+	{
+		ViewExtension = FSceneViewExtensions::NewExtension<FSceneTileViewExtension>();
+	}
+	ViewExtension->AddInstance_GameThread(Resource, LocalToWorld);
+}
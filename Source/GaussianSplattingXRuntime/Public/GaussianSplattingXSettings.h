@@ -0,0 +1,108 @@
+﻿#pragma once
+
+#include "Engine/DeveloperSettings.h"
+
+#include "GaussianSplattingXSettings.generated.h"
+
+/// 导入时的剪枝选项，用来移除对画面几乎没有贡献的高斯
+/// @note 所有阈值都基于激活后的数值：不透明度在 sigmoid 之后，缩放在 exp 之后
+USTRUCT()
+struct GAUSSIANSPLATTINGXRUNTIME_API FScenePruneOptions
+{
+	GENERATED_BODY()
+
+	/// 是否在导入时剪枝
+	UPROPERTY(Config, EditAnywhere, Category = "Prune")
+	bool bEnabled = false;
+
+	/// 不透明度低于该值的高斯会被移除，0 表示不按不透明度剪枝
+	UPROPERTY(Config, EditAnywhere, Category = "Prune", meta = (EditCondition = "bEnabled", ClampMin = 0, ClampMax = 1))
+	float MinOpacity = 1.0f / 255.0f;
+
+	/// 三个轴中最大的缩放仍小于该值的高斯会被移除，0 表示不按缩放剪枝
+	UPROPERTY(Config, EditAnywhere, Category = "Prune", meta = (EditCondition = "bEnabled", ClampMin = 0))
+	float MinScale = 0.0f;
+
+	/// 是否移除离群点：在 OutlierRadius 范围内邻居少于 OutlierMinNeighbors 的高斯会被移除
+	UPROPERTY(Config, EditAnywhere, Category = "Prune", meta = (EditCondition = "bEnabled"))
+	bool bRemoveOutliers = false;
+
+	/// 统计邻居时使用的网格大小，单位与源文件一致
+	UPROPERTY(Config, EditAnywhere, Category = "Prune",
+		meta = (EditCondition = "bEnabled && bRemoveOutliers", ClampMin = 0.0001))
+	float OutlierRadius = 0.1f;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Prune",
+		meta = (EditCondition = "bEnabled && bRemoveOutliers", ClampMin = 1))
+	int32 OutlierMinNeighbors = 4;
+
+	/// 是否只保留 CropBox 内的高斯
+	UPROPERTY(Config, EditAnywhere, Category = "Prune", meta = (EditCondition = "bEnabled"))
+	bool bCropToBox = false;
+
+	/// 裁剪包围盒，单位与源文件一致
+	UPROPERTY(Config, EditAnywhere, Category = "Prune", meta = (EditCondition = "bEnabled && bCropToBox"))
+	FBox CropBox = FBox(FVector(-100.0), FVector(100.0));
+};
+
+/// 插件设置，保存在 Config/DefaultGaussianSplattingX.ini 中，可以在 Project Settings > Plugins 中修改
+UCLASS(Config = GaussianSplattingX, DefaultConfig, meta = (DisplayName = "Gaussian Splatting X"))
+class GAUSSIANSPLATTINGXRUNTIME_API UGaussianSplattingXSettings : public UDeveloperSettings
+{
+	GENERATED_BODY()
+
+public:
+	virtual FName GetCategoryName() const override;
+
+	// =============================== 导入 ===============================
+	/// 导入场景文件时默认使用的剪枝选项
+	UPROPERTY(Config, EditAnywhere, Category = "Import")
+	FScenePruneOptions ImportPruneOptions;
+
+	// =============================== 流送 ===============================
+	/// 是否按相机距离和屏幕覆盖率流送 Chunk，关闭时每个资产的所有高斯都常驻显存
+	/// @note 默认关闭，和之前的行为一致，需要的项目自己开启
+	UPROPERTY(Config, EditAnywhere, Category = "Streaming")
+	bool bEnableStreaming = false;
+
+	/// 所有场景资产共享的显存预算，按需求在正在使用的资产之间平均分配
+	UPROPERTY(Config, EditAnywhere, Category = "Streaming",
+		meta = (EditCondition = "bEnableStreaming", ClampMin = 16, Units = "Megabytes"))
+	int32 StreamingBudgetMB = 2048;
+
+	/// 关闭流送时是否仍然按重要性逐帧上传 Chunk，先显示粗略的场景再逐渐补全，关闭时创建资源时一次性上传所有 Chunk
+	UPROPERTY(Config, EditAnywhere, Category = "Streaming", meta = (EditCondition = "!bEnableStreaming"))
+	bool bProgressiveLoading = false;
+
+	/// 每帧最多上传的数据量，避免一次上传太多造成卡顿
+	UPROPERTY(Config, EditAnywhere, Category = "Streaming",
+		meta = (EditCondition = "bEnableStreaming || bProgressiveLoading", ClampMin = 1, Units = "Megabytes"))
+	int32 MaxUploadMBPerFrame = 64;
+
+	/// 屏幕覆盖率低于该值的 Chunk 不会被请求加载
+	UPROPERTY(Config, EditAnywhere, Category = "Streaming",
+		meta = (EditCondition = "bEnableStreaming", ClampMin = 0, ClampMax = 1))
+	float MinScreenCoverage = 0.00001f;
+
+	/// 不在视锥内的 Chunk 的优先级缩放，保留一部分优先级使相机转动时不会出现空洞
+	UPROPERTY(Config, EditAnywhere, Category = "Streaming",
+		meta = (EditCondition = "bEnableStreaming", ClampMin = 0, ClampMax = 1))
+	float OutOfViewPriorityScale = 0.1f;
+
+	/// 分配给资产的 Slot 数量变化超过这个比例时才重新分配池，避免预算的小幅波动反复分配显存
+	/// @note 所有资产的池超出总预算时不受这个限制，仍然立即缩小
+	UPROPERTY(Config, EditAnywhere, Category = "Streaming",
+		meta = (EditCondition = "bEnableStreaming", ClampMin = 0, ClampMax = 1))
+	float PoolResizeHysteresis = 0.1f;
+
+	// =============================== 合并 ===============================
+	/// 是否把包围盒相交的静态 ASceneActor 合并到同一个 Niagara System 中，统一排序并一次绘制
+	/// @note 只在游戏世界中生效，编辑器视口中每个 Actor 仍然单独绘制；默认关闭，需要的项目自己开启
+	UPROPERTY(Config, EditAnywhere, Category = "Aggregation")
+	bool bEnableAggregation = false;
+
+	// =============================== 空间查询 ===============================
+	/// 是否在加载资产时构建 BVH，关闭时在第一次射线检测或区域查询时构建
+	UPROPERTY(Config, EditAnywhere, Category = "Spatial Query")
+	bool bBuildSpatialIndexOnLoad = false;
+};
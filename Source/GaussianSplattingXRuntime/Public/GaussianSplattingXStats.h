@@ -0,0 +1,6 @@
+﻿#pragma once
+
+#include "Stats/Stats.h"
+
+/// stat GaussianSplattingX
+DECLARE_STATS_GROUP(TEXT("GaussianSplattingX"), STATGROUP_GaussianSplattingX, STATCAT_Advanced);
@@ -5,6 +5,19 @@
 
 #include "SceneActor.generated.h"
 
+class USceneBufferAsset;
+
+/// 场景的绘制方式
+UENUM(BlueprintType)
+enum class ESceneRenderBackend : uint8
+{
+	/// 每个高斯是一个 Niagara 粒子
+	Niagara,
+
+	/// 在 Compute Shader 中按 Tile 光栅化，适合几百万个高斯以上的场景
+	TileCompute
+};
+
 /// 可以放入关卡中的场景 Actor，包含一个 Niagara Component 用来渲染高斯体场景
 UCLASS(BlueprintType)
 class GAUSSIANSPLATTINGXRUNTIME_API ASceneActor : public AActor
@@ -15,6 +28,29 @@ public:
 	UPROPERTY(EditAnywhere)
 	TObjectPtr<USceneNiagaraParameter> SceneNiagaraParameter;
 
+	/// 是否允许和包围盒相交的其他 ASceneActor 合并绘制，移动中的 Actor 会暂时单独绘制
+	UPROPERTY(EditAnywhere, Category = "Aggregation")
+	bool bAllowAggregation = true;
+
+	UPROPERTY(EditAnywhere, Category = "Rendering")
+	ESceneRenderBackend RenderBackend = ESceneRenderBackend::Niagara;
+
+	/// 静态粒子模式使用的 Niagara System，为空时使用默认的 FX_GaussianSplattingX，每帧为所有粒子调用 GetGaussianData
+	/// @note 需要在 Niagara 编辑器中制作：生成时和 GetDataVersion 变化时调用 GetGaussianStaticData，每帧只调用 GetGaussianViewColor
+	UPROPERTY(EditAnywhere, Category = "Rendering",
+		meta = (EditCondition = "RenderBackend == ESceneRenderBackend::Niagara"))
+	TSoftObjectPtr<UNiagaraSystem> StaticParticleSystem;
+
+#if WITH_EDITORONLY_DATA
+	/// 是否监视 LiveReloadFile，文件变化后在后台重新读取并替换 GPU 上的数据，不会修改或保存任何资产
+	UPROPERTY(EditAnywhere, Category = "Live Reload")
+	bool bLiveReload = false;
+
+	/// 训练过程中不断被覆盖的 PLY 检查点
+	UPROPERTY(EditAnywhere, Category = "Live Reload", meta = (EditCondition = "bLiveReload", FilePathFilter = "ply"))
+	FFilePath LiveReloadFile;
+#endif
+
 	// 用来运行 Niagara System 的组件
 	UPROPERTY()
 	TObjectPtr<UNiagaraComponent> NiagaraComp;
@@ -22,8 +58,27 @@ public:
 	ASceneActor();
 
 	virtual void OnConstruction(const FTransform& Transform) override;
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void Tick(float DeltaSeconds) override;
+	virtual bool ShouldTickIfViewportsOnly() const override { return true; }
 
 #if WITH_EDITOR
 	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
 #endif
+
+	/// 用一个临时资产代替 SceneNiagaraParameter 中的资产绘制，为空时恢复
+	void SetLiveSceneBufferAsset(USceneBufferAsset* Asset);
+	USceneBufferAsset* GetLiveSceneBufferAsset() const;
+
+private:
+	/// 正在使用的参数，热重载时是指向临时资产的参数
+	USceneNiagaraParameter* GetActiveNiagaraParameter() const;
+
+	UPROPERTY(Transient)
+	TObjectPtr<USceneNiagaraParameter> LiveNiagaraParameter;
+
+	/// TileCompute 后端直接使用资产的 RenderResource，不经过 Niagara Data Interface
+	UPROPERTY(Transient)
+	TObjectPtr<USceneBufferAsset> TileSceneBufferAsset;
 };
@@ -0,0 +1,139 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "SceneBufferRenderResource.h"
+#include "Async/Future.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/StrongObjectPtr.h"
+
+#include "SceneAggregatorSubsystem.generated.h"
+
+class ASceneActor;
+class USceneBufferAsset;
+class USceneNiagaraParameter;
+
+/// 一组包围盒相交的 ASceneActor 合并后的数据
+USTRUCT()
+struct FSceneAggregate
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<TWeakObjectPtr<ASceneActor>> Members;
+
+	/// 合并时每个成员的变换和 RenderResource，变化后需要重新合并
+	TArray<FTransform> MemberTransforms;
+	TArray<TWeakPtr<FSceneBufferRenderResource, ESPMode::ThreadSafe>> MemberResources;
+
+	/// 所有成员的高斯变换到世界空间后合并成的临时资产
+	UPROPERTY()
+	TObjectPtr<USceneBufferAsset> Asset;
+
+	UPROPERTY()
+	TObjectPtr<USceneNiagaraParameter> Parameter;
+
+	/// 负责绘制合并资产的临时 Actor
+	UPROPERTY()
+	TObjectPtr<ASceneActor> DrawActor;
+
+	/// 每个 Chunk 中来自每个成员的高斯数量，下标为 Chunk * Members.Num() + Member
+	TArray<int32> ChunkMemberCounts;
+
+	/// 每个成员的高斯总数，以及这一帧驻留在显存中的数量
+	TArray<int32> MemberGaussians;
+	TArray<int32> MemberResidentGaussians;
+};
+
+/// 把相互重叠的 ASceneActor 合并为一个 Niagara System，所有高斯统一排序并在一次绘制中完成混合
+/// @note 每个 Actor 单独排序时重叠区域的混合顺序是错误的，并且每个 System 都有自己的每帧开销
+/// @note 只合并一段时间内没有移动过、并且最近在视图中出现过的 Actor，正在移动的 Actor 会退出合并，停下之后重新合并
+/// @note 合并在工作线程上读取成员的打包数据完成，GT 上只创建 RenderResource，完成之前旧的合并结果或成员自己继续绘制
+/// @note 被合并的成员挂起流送，显存只保留合并后的资产
+UCLASS()
+class GAUSSIANSPLATTINGXRUNTIME_API USceneAggregatorSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	void RegisterSceneActor(ASceneActor* SceneActor);
+	void UnregisterSceneActor(ASceneActor* SceneActor);
+
+	/// 输出每个合并组中每个 Actor 的高斯数量和驻留数量
+	void DumpAggregates(FOutputDevice& Ar) const;
+
+	// =============================== UTickableWorldSubsystem ===============================
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	struct FBuildResult
+	{
+		FSceneGPUPayload Payload;
+
+		/// 同 FSceneAggregate::ChunkMemberCounts
+		TArray<int32> ChunkMemberCounts;
+
+		double Seconds = 0.0;
+	};
+
+	/// 正在工作线程上合并的一组 Actor
+	struct FPendingAggregate
+	{
+		TArray<TWeakObjectPtr<ASceneActor>> Members;
+		TArray<FTransform> MemberTransforms;
+		TArray<TWeakPtr<FSceneBufferRenderResource, ESPMode::ThreadSafe>> MemberResources;
+
+		/// 工作线程写入合并后的数组和 Chunk，完成后成为 FSceneAggregate::Asset
+		TStrongObjectPtr<USceneBufferAsset> Staging;
+		TFuture<FBuildResult> Future;
+	};
+
+	/// 找出所有包围盒相交的 Actor 组，每组至少两个 Actor
+	TArray<TArray<ASceneActor*>> FindOverlappingGroups() const;
+
+	/// 在工作线程上开始合并一组 Actor
+	void StartAggregate(const TArray<ASceneActor*>& Members);
+
+	/// 把成员的打包数据变换到世界空间后合并到 Asset 中，划分 Chunk 并重新打包，在工作线程上调用
+	/// @note 只读取 RenderResource 中的打包数据，读取时持有读锁，不需要恢复成员资产的双精度数组
+	static FBuildResult BuildAggregate(
+		const TArray<TSharedPtr<FSceneBufferRenderResource, ESPMode::ThreadSafe>>& Resources,
+		const TArray<FTransform>& Transforms, USceneBufferAsset& Asset);
+
+	/// 用后台合并的结果创建 RenderResource，并生成负责绘制的 Actor
+	FSceneAggregate FinishAggregate(FPendingAggregate& Pending);
+
+	/// 恢复不在 StillAggregated 中的成员自己的绘制，销毁临时 Actor
+	static void DissolveAggregate(FSceneAggregate& Aggregate, const TSet<const ASceneActor*>& StillAggregated);
+
+	/// 挂起只被合并后的成员使用的 RenderResource，恢复不再需要挂起的 RenderResource
+	/// @note 同一个资产也可能被没有合并的 Actor 使用，这时不能挂起
+	void UpdateSuspendedResources(const TSet<const ASceneActor*>& AggregatedActors);
+
+	/// 统计每个成员驻留在显存中的高斯数量
+	static void UpdateContribution(FSceneAggregate& Aggregate);
+
+	struct FTrackedActor
+	{
+		TWeakObjectPtr<ASceneActor> SceneActor;
+		FTransform LastTransform;
+		uint64 LastMovedFrame = 0;
+
+		/// 世界空间的包围盒，不是合并候选时无效
+		FBox WorldBounds = FBox(ForceInit);
+		uint64 LastVisibleFrame = 0;
+	};
+
+	TArray<FTrackedActor> SceneActors;
+
+	TArray<FPendingAggregate> PendingAggregates;
+
+	TArray<TWeakPtr<FSceneBufferRenderResource, ESPMode::ThreadSafe>> SuspendedResources;
+
+	UPROPERTY()
+	TArray<FSceneAggregate> Aggregates;
+};
@@ -0,0 +1,95 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+
+#include "SceneBVH.generated.h"
+
+class USceneBufferAsset;
+
+/// 射线检测的结果，坐标和距离所在的空间与输入的射线一致
+USTRUCT(BlueprintType)
+struct GAUSSIANSPLATTINGXRUNTIME_API FSceneRaycastHit
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Scene")
+	bool bHit = false;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Scene")
+	FVector Location = FVector::ZeroVector;
+
+	/// 命中的高斯椭球在命中点的法线，朝向射线起点
+	UPROPERTY(BlueprintReadOnly, Category = "Scene")
+	FVector Normal = FVector::ZeroVector;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Scene")
+	float Distance = 0.0f;
+
+	/// 使累积不透明度超过阈值的高斯
+	UPROPERTY(BlueprintReadOnly, Category = "Scene")
+	int32 GaussianIndex = INDEX_NONE;
+
+	/// 到命中点为止累积的不透明度
+	UPROPERTY(BlueprintReadOnly, Category = "Scene")
+	float Opacity = 0.0f;
+};
+
+/// 资产空间下所有高斯的 BVH，由资产持有，资产数据变化后需要重新构建
+/// @note 高斯已经按 Morton 顺序排列，所以直接把相邻的 LeafSize 个高斯作为叶子，再逐层两两合并，每一层都可以并行构建
+/// @note 构建时拷贝一份单精度的高斯数据，之后资产被编辑、重新加载或销毁都不影响已经构建的 BVH
+/// @note 构建之后只读，可以在多个线程上同时查询
+class GAUSSIANSPLATTINGXRUNTIME_API FSceneBVH
+{
+public:
+	/// 每个叶子包含的高斯数量
+	static constexpr int32 LeafSize = 8;
+
+	/// 高斯椭球的包围盒取 3σ 范围
+	static constexpr float SigmaExtent = 3.0f;
+
+	explicit FSceneBVH(const USceneBufferAsset& InScene);
+
+	/// 高斯椭球 SigmaExtent 范围的轴对齐包围盒的半边长
+	static FVector GetGaussianExtent(const FQuat& Rotation, const FVector& Scale);
+
+	/// 沿射线从前到后累积每个高斯在射线上的最大不透明度，超过 OpacityThreshold 时视为命中
+	FSceneRaycastHit Raycast(const FVector& Start, const FVector& End, float OpacityThreshold) const;
+
+	/// 在多个线程上同时检测多条射线
+	void RaycastBatch(TConstArrayView<FVector> Starts, TConstArrayView<FVector> Ends, float OpacityThreshold,
+	                  TArray<FSceneRaycastHit>& OutHits) const;
+
+	/// 经过 Transform 变换后中心距离 Location 最近的高斯，超过 MaxDistance 时返回 INDEX_NONE
+	/// @param Location 和 MaxDistance 都在 Transform 变换后的空间中，非均匀缩放时按变换后的真实距离比较
+	int32 FindNearest(const FVector& Location, double MaxDistance, double& OutDistance,
+	                  const FTransform& Transform = FTransform::Identity) const;
+
+	/// 中心在包围盒或球内的所有高斯
+	void OverlapBox(const FBox& Box, TArray<int32>& OutIndices) const;
+	void OverlapSphere(const FVector& Center, double Radius, TArray<int32>& OutIndices) const;
+
+	/// 构建时高斯的中心
+	FVector GetGaussianPosition(const int32 Index) const { return FVector(Positions[Index]); }
+
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	struct FNode
+	{
+		FVector3f Min;
+		FVector3f Max;
+	};
+
+	/// 按节点包围盒遍历，对每个相交的叶子调用 LeafFunc(FirstGaussian, LastGaussian)
+	template <typename NodeFuncType, typename LeafFuncType>
+	void Traverse(NodeFuncType&& NodeFunc, LeafFuncType&& LeafFunc) const;
+
+	int32 GaussianCount = 0;
+	TArray<FVector3f> Positions;
+	TArray<FVector3f> Scales;
+	TArray<FQuat4f> Rotations;
+	TArray<float> Opacities;
+
+	/// Levels[0] 是叶子，Levels.Last() 只有根节点，第 i 层的节点 j 的子节点是第 i-1 层的 2j 和 2j+1
+	TArray<TArray<FNode>> Levels;
+};
@@ -0,0 +1,48 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+
+/// 这一帧的绘制预算，画质为 1 时不做任何削减
+struct FSceneSplatBudget
+{
+	/// 综合画质，范围 [GaussianSplattingX.Budget.MinQuality, 1]
+	float Quality = 1.0f;
+
+	/// 每个资产最多绘制的驻留 Chunk 占 Slot 数量的比例，优先级低的 Chunk 先被移出，相当于 LOD 偏移
+	float ResidentChunkScale = 1.0f;
+
+	/// 不透明度低于该值的高斯不绘制
+	float MinOpacity = 0.0f;
+
+	/// 计算颜色时最多使用的 SH 系数数量
+	int32 MaxSHCoefficientsCount = 16;
+};
+
+/// 按帧时间目标自动调整绘制预算，用于需要稳定帧率的部署
+/// @note 测量上一帧的 GPU 时间和其中绘制高斯的耗时并平滑，帧时间在目标附近的死区内时不调整
+/// @note 超出死区时假设绘制高斯的耗时和画质成正比，按需要减少或可以增加的耗时占绘制耗时的比例调整画质，
+///       每帧只走平滑系数这一部分，等测量追上之后再继续，避免平滑延迟造成的过冲和振荡
+/// @note 默认关闭，通过 GaussianSplattingX.Budget.* 控制台变量配置，当前预算可以在 stat GaussianSplattingX 中查看
+class GAUSSIANSPLATTINGXRUNTIME_API FSceneBudgetController
+{
+public:
+	/// 由流送管理器在每帧开始时调用，流送、Niagara Data Interface 和 Tile 光栅化在这一帧都使用更新后的预算
+	static void Update();
+
+	/// 只能在 GT 读取，需要在 RT 使用时随实例数据一起传递
+	static const FSceneSplatBudget& GetBudget();
+
+	/// Tile 光栅化的 GPU 时间戳有结果之后在 RT 上调用，TimeMs 是一帧中所有视图绘制高斯的耗时之和
+	/// @note 一段时间没有报告时（例如只使用 Niagara 后端）把整帧的 GPU 时间当作绘制高斯的耗时
+	static void ReportSplatGPUTime_RenderThread(float TimeMs);
+
+private:
+	static FSceneSplatBudget Budget;
+
+	/// 平滑后的帧时间和绘制高斯的耗时
+	static float SmoothedFrameTimeMs;
+	static float SmoothedSplatTimeMs;
+
+	/// 连续低于目标下沿的帧数
+	static int32 FramesBelowTarget;
+};
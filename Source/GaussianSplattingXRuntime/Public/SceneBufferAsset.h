@@ -4,6 +4,53 @@
 
 #include "SceneBufferAsset.generated.h"
 
+class USceneBufferAssetImportData;
+class FSceneBufferRenderResource;
+class FSceneBVH;
+struct FSceneGPUPayload;
+
+/// 高斯属性对应的 GPU Buffer，用于标记编辑后需要重新上传的数据
+enum class ESceneGaussianAttributes : uint8
+{
+	None = 0,
+	/// 位置和不透明度在同一个 Buffer 中
+	PositionOpacity = 1 << 0,
+	Scale = 1 << 1,
+	Rotation = 1 << 2,
+	SHCoefficients = 1 << 3,
+	All = PositionOpacity | Scale | Rotation | SHCoefficients
+};
+ENUM_CLASS_FLAGS(ESceneGaussianAttributes);
+
+/// 空间上相邻的一组高斯，是 GPU 流送的最小单位
+USTRUCT()
+struct GAUSSIANSPLATTINGXRUNTIME_API FSceneChunk
+{
+	GENERATED_BODY()
+
+	/// 每个 Chunk 最多包含的高斯数量，除了最后一个 Chunk 之外都是满的
+	static constexpr int32 MaxGaussians = 4096;
+
+	/// 第一个高斯的下标
+	UPROPERTY()
+	int32 Start = 0;
+
+	UPROPERTY()
+	int32 Count = 0;
+
+	/// 所有高斯中心的包围盒，Actor 空间
+	UPROPERTY()
+	FBox Bounds = FBox(ForceInit);
+
+	/// 所有高斯 3σ 椭球的包围盒，Actor 空间，遮挡剔除时使用，必须完整包含 Chunk 绘制的范围
+	UPROPERTY()
+	FBox SplatBounds = FBox(ForceInit);
+
+	/// 对画面的贡献，所有高斯的不透明度乘以最大缩放的平方之和
+	UPROPERTY()
+	float Importance = 0.0f;
+};
+
 UCLASS(BlueprintType)
 class GAUSSIANSPLATTINGXRUNTIME_API USceneBufferAsset : public UObject
 {
@@ -22,16 +69,23 @@ public:
 	UPROPERTY()
 	uint32 GaussianCount = {};
 
+	/// 高斯属性是否已经激活，旧版本的资产保存的是训练器的原始输出，加载时会在 PostLoad 中转换
+	UPROPERTY()
+	bool bAttributesActivated = false;
+
 	// =============================== Gaussian 参数 ===============================
 	UPROPERTY()
 	TArray<FVector> GaussianPositions = {};
 
+	/// 线性缩放（已经过 exp）
 	UPROPERTY()
 	TArray<FVector> GaussianScales = {};
 
+	/// 归一化的旋转，按 FQuat 的 x,y,z,w 存储
 	UPROPERTY()
 	TArray<FQuat> GaussianRotations = {};
 
+	/// 不透明度（已经过 sigmoid），范围 [0, 1]
 	UPROPERTY()
 	TArray<float> GaussianOpacities = {};
 
@@ -39,5 +93,123 @@ public:
 	UPROPERTY()
 	TArray<FVector> GaussianSHCoefficients = {};
 
+	// =============================== 空间划分 ===============================
+	/// 高斯按 Morton 顺序排列后划分的 Chunk，第 i 个 Chunk 包含 [i * MaxGaussians, i * MaxGaussians + Count) 的高斯
+	UPROPERTY()
+	TArray<FSceneChunk> Chunks = {};
+
+#if WITH_EDITORONLY_DATA
+	// =============================== 导入信息 ===============================
+	/// 源文件的路径、大小、时间戳和哈希，用于判断重新导入时源文件是否发生变化
+	UPROPERTY(VisibleAnywhere, Instanced, Category = "ImportSettings")
+	TObjectPtr<USceneBufferAssetImportData> AssetImportData;
+#endif
+
+	virtual void PostInitProperties() override;
+	virtual void Serialize(FArchive& Ar) override;
+	virtual void PostLoad() override;
+	virtual void BeginDestroy() override;
+	virtual void GetAssetRegistryTags(FAssetRegistryTagsContext Context) const override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
 	void SetGaussianCount(size_t NewGaussianCount);
+
+	/// 烘焙的包中只有打包好的数据，双精度数组在第一次查询、编辑或合并时才从打包数据恢复，只能在 GT 调用
+	/// @note 直接读写 Gaussian 数组之前需要先调用，其他资产或已经恢复过时不做任何事
+	void UnpackCookedPayload();
+
+	/// 释放双精度数组，只保留 RenderResource 中打包好的数据，之后需要时和烘焙的资产一样由 UnpackCookedPayload 恢复
+	/// @note 只用于运行时生成、只用来绘制的资产，例如合并后的临时资产，只能在 GT 调用
+	void DiscardUnpackedData();
+
+	// =============================== 资产注册表 ===============================
+	/// 保存时写入资产注册表的标签，内容浏览器和工具不需要加载资产就可以读取
+	static const FName GaussianCountTag;
+	static const FName SHDegreeTag;
+	static const FName BoundsTag;
+	static const FName GPUMemoryTag;
+	static const FName SourceFileHashTag;
+
+	/// 每个高斯打包后在 GPU 上占用的字节数：位置和不透明度、缩放、旋转各一个 float4，每个 SH 系数一个 float4
+	static int64 GetGPUBytesPerGaussian(uint32 InSHCoefficientsCount);
+
+	/// 所有 Chunk 包围盒的并集，没有 Chunk 时无效
+	FBox GetBounds() const;
+
+	/// 把训练器的原始输出转换为可以直接使用的值：不透明度做 sigmoid，缩放做 exp，旋转归一化
+	/// 已经激活过的资产不会重复转换
+	void ActivateAttributes();
+
+	/// 按位置的 Morton 顺序重新排列所有高斯，然后划分为 Chunk，需要在激活之后调用
+	/// @param OutOrder 不为空时输出排列，排序后的第 i 个高斯是排序前的第 OutOrder[i] 个
+	void BuildChunks(TArray<uint32>* OutOrder = nullptr);
+
+	/// 重新计算一个 Chunk 的 SplatBounds，高斯的位置、缩放或旋转变化后调用
+	void UpdateChunkSplatBounds(int32 ChunkIndex);
+
+	// =============================== GPU 数据 ===============================
+	/// 获取 GPU 上的数据，第一次调用时打包并上传，只能在 GT 调用
+	TSharedPtr<FSceneBufferRenderResource, ESPMode::ThreadSafe> GetRenderResource();
+
+	/// 资产数据变化后重新打包并上传，正在使用旧数据的 Niagara System 会在下一帧切换到新数据
+	void UpdateRenderResource();
+
+	/// 使用在其他线程打包好的数据重新创建 RenderResource，和 UpdateRenderResource() 一样按流送设置分配 Slot 和上传 Chunk
+	/// @note 用于热重载，在 GT 上不做任何打包，开启流送时新数据按预算逐帧补全
+	void UpdateRenderResource(FSceneGPUPayload&& Payload);
+
+	// =============================== 编辑 ===============================
+	/// 修改一个高斯的属性并记录脏范围，CommitGaussianEdits 时只重新打包和上传这些范围
+	/// @note 只能修改已有的高斯，增删高斯需要调用 UpdateRenderResource，删除一片区域可以把不透明度设为 0
+	void SetGaussianPosition(int32 Index, const FVector& Position);
+	void SetGaussianOpacity(int32 Index, float Opacity);
+	void SetGaussianScale(int32 Index, const FVector& Scale);
+	void SetGaussianRotation(int32 Index, const FQuat& Rotation);
+	void SetGaussianSHCoefficients(int32 Index, TConstArrayView<FVector> Coefficients);
+
+	/// 直接修改属性数组之后调用，标记 [Start, Start + Count) 的高斯，烘焙的资产在修改之前需要调用 UnpackCookedPayload
+	void MarkGaussiansDirty(int32 Start, int32 Count, ESceneGaussianAttributes Attributes);
+
+	/// 把所有脏范围上传到 GPU，驻留的 Chunk 立即更新，未驻留的 Chunk 在下次流送时使用新数据
+	/// @note Chunk 的包围盒和重要性不会更新，移动幅度较大时需要调用 UpdateRenderResource
+	void CommitGaussianEdits();
+
+	// =============================== 空间查询 ===============================
+	/// 获取资产空间的 BVH，第一次调用时构建，构建时读取资产的数组，所以和编辑一样在 GT 上调用
+	/// @note 返回的 BVH 是构建时数据的快照，可以交给任意线程查询，资产之后的修改不会影响它
+	TSharedPtr<const FSceneBVH, ESPMode::ThreadSafe> GetBVH();
+
+private:
+	/// 按流送设置创建 RenderResource 并注册到流送管理器
+	void CreateRenderResource(FSceneGPUPayload&& Payload);
+
+	void ReleaseRenderResource();
+
+	/// 资产数据变化后丢弃 BVH，下次查询时重新构建，正在查询的线程持有的旧快照仍然有效，只是不包含这次修改
+	void ResetBVH();
+
+	/// RT 上的实例数据也会持有引用，所以资产销毁时只释放 RHI 资源，对象本身在最后一个引用释放时析构
+	TSharedPtr<FSceneBufferRenderResource, ESPMode::ThreadSafe> RenderResource;
+
+	/// 按标记顺序记录的脏范围，提交时按属性合并
+	struct FDirtyRange
+	{
+		int32 Start;
+		int32 End;
+		ESceneGaussianAttributes Attributes;
+	};
+
+	TArray<FDirtyRange> DirtyRanges;
+
+	/// 烘焙时按目标平台打包好的 GPU 数据，第一次创建 RenderResource 时直接使用，不再打包
+	/// @note 只在需要烘焙数据的平台上加载，编辑器中始终为空
+	TSharedPtr<FSceneGPUPayload, ESPMode::ThreadSafe> CookedPayload;
+
+	/// 双精度数组还没有从烘焙的数据恢复
+	bool bNeedsUnpack = false;
+
+	TSharedPtr<const FSceneBVH, ESPMode::ThreadSafe> BVH;
+	FCriticalSection BVHCriticalSection;
 };
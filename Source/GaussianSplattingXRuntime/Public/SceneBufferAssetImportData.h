@@ -0,0 +1,29 @@
+﻿#pragma once
+
+#include "EditorFramework/AssetImportData.h"
+
+#include "SceneBufferAssetImportData.generated.h"
+
+/// SceneBufferAsset 的导入信息，记录源文件的路径、大小、时间戳和内容哈希，用于增量重新导入
+UCLASS()
+class GAUSSIANSPLATTINGXRUNTIME_API USceneBufferAssetImportData : public UAssetImportData
+{
+	GENERATED_BODY()
+
+public:
+	/// 导入时源文件的字节数
+	UPROPERTY(VisibleAnywhere, Category = "File Path")
+	int64 SourceFileSize = INDEX_NONE;
+
+#if WITH_EDITORONLY_DATA
+	/// 记录源文件的当前状态，Hash 为空时会重新计算文件内容的 MD5
+	void UpdateSourceFile(const FString& AbsoluteFilename, const FMD5Hash& Hash = FMD5Hash());
+
+	/// 判断源文件相对于上一次导入是否没有变化
+	/// @note 先比较大小，大小不同直接认为发生变化；时间戳相同认为没有变化；
+	///       时间戳不同时再比较内容哈希，避免文件只被 touch 时重复导入
+	/// @param AbsoluteFilename 源文件的绝对路径
+	/// @param OutHash 如果计算了文件哈希，输出计算结果，方便调用者复用
+	bool IsSourceFileUnchanged(const FString& AbsoluteFilename, FMD5Hash& OutHash) const;
+#endif
+};
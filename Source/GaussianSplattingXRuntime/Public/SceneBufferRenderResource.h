@@ -0,0 +1,180 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "RenderGraphResources.h"
+#include "RenderResource.h"
+#include "SceneBufferAsset.h"
+
+#include <atomic>
+
+/// 打包好的 GPU 数据，每个数组对应 Shader 中的一个 Buffer，可以直接整块拷贝到锁定的 Buffer 中
+struct GAUSSIANSPLATTINGXRUNTIME_API FSceneGPUPayload
+{
+	uint32 GaussianCount = 0;
+	uint32 SHCoefficientsCount = 0;
+
+	/// xyz 是位置，w 是不透明度
+	TArray<FVector4f> PositionOpacity;
+
+	/// xyz 是缩放，w 是填充
+	TArray<FVector4f> Scale;
+
+	/// 旋转，按 x,y,z,w 存储
+	TArray<FVector4f> Rotation;
+
+	/// 展开的 SH 系数，xyz 是 RGB，w 是填充
+	TArray<FVector4f> SHCoefficients;
+
+	/// 在多个工作线程上把资产中的双精度数据转换为 GPU 使用的单精度格式
+	/// @param MaxSHCoefficientsCount 每个高斯最多保留的 SH 系数数量，多出的高阶系数被丢弃
+	void Pack(const USceneBufferAsset& Scene, int32 MaxSHCoefficientsCount = MAX_int32);
+
+	/// Pack 的逆过程，用烘焙的数据恢复资产中的双精度数组，供空间查询、编辑和合并使用
+	void Unpack(USceneBufferAsset& Scene) const;
+
+	/// 只打包 [Start, Start + Count) 的高斯中 Attributes 对应的数组，其他数组为空
+	void PackRange(const USceneBufferAsset& Scene, int32 Start, int32 Count, ESceneGaussianAttributes Attributes);
+
+	SIZE_T GetAllocatedSize() const;
+
+	/// 烘焙后的资产直接保存打包好的数组，加载后可以整块上传
+	void Serialize(FArchive& Ar);
+};
+
+/// 从 RDG 缓冲池分配的常驻 Buffer，Tile 光栅化时注册到 RDG 中，Niagara 直接绑定 RHI 的 SRV
+struct GAUSSIANSPLATTINGXRUNTIME_API FSceneGaussianBuffer
+{
+	TRefCountPtr<FRDGPooledBuffer> PooledBuffer;
+	FBufferRHIRef Buffer;
+	FShaderResourceViewRHIRef SRV;
+	uint32 NumBytes = 0;
+	EPixelFormat Format = PF_Unknown;
+
+	void Initialize(FRHICommandListBase& RHICmdList, const TCHAR* Name, uint32 BytesPerElement, uint32 NumElements,
+	                EPixelFormat InFormat);
+	void Release();
+
+	/// 注册到这一帧的 RDG 中，没有分配时返回空
+	FRDGBufferSRVRef Register(FRDGBuilder& GraphBuilder) const;
+};
+
+/// 编辑后需要更新的一段高斯，不跨越 Chunk
+struct GAUSSIANSPLATTINGXRUNTIME_API FSceneGaussianUpdate
+{
+	int32 Start = 0;
+	int32 Count = 0;
+	ESceneGaussianAttributes Attributes = ESceneGaussianAttributes::None;
+
+	/// 提交时这段高斯所在 Chunk 的 Slot，INDEX_NONE 表示不驻留，只更新 CPU 上的数据
+	int32 Slot = INDEX_NONE;
+
+	/// 编辑后所在 Chunk 的 SplatBounds，只有位置、缩放或旋转变化时有效
+	FBox SplatBounds = FBox(ForceInit);
+
+	/// 只包含这段高斯的打包数据
+	FSceneGPUPayload Data;
+};
+
+/// SceneBufferAsset 在 GPU 上的数据，由资产持有，所有使用同一个资产的 Niagara System 共享
+/// @note GPU 上是一个由 Slot 组成的池，每个 Slot 存放一个 Chunk，哪些 Chunk 驻留由 FSceneStreamingManager 决定
+/// @note Shader 通过 SlotTable 把 [0, ResidentGaussianCount) 映射到池中的下标
+class GAUSSIANSPLATTINGXRUNTIME_API FSceneBufferRenderResource : public FRenderResource
+{
+public:
+	/// @param InSlotCount 初始的 Slot 数量
+	/// @param bInitiallyResident 为真时 Slot 数量必须等于 Chunk 数量，所有 Chunk 在初始化时一次性上传
+	FSceneBufferRenderResource(FSceneGPUPayload&& InPayload, const TArray<FSceneChunk>& InChunks, int32 InSlotCount,
+	                           bool bInitiallyResident);
+
+	virtual void InitRHI(FRHICommandListBase& RHICmdList) override;
+	virtual void ReleaseRHI() override;
+	virtual FString GetFriendlyName() const override;
+
+	uint32 GetGaussianCount() const { return GaussianCount; }
+	uint32 GetSHCoefficientsCount() const { return SHCoefficientsCount; }
+	const TArray<FSceneChunk>& GetChunks() const { return Chunks; }
+
+	/// CPU 上的打包数据，RT 之外的线程读取时需要持有 GetPayloadLock() 的读锁
+	/// @note 只有 UpdateGaussians_RenderThread 会在写锁中修改，所以 RT 上读取不需要加锁
+	const FSceneGPUPayload& GetPayload() const { return Payload; }
+	FRWLock& GetPayloadLock() const { return PayloadLock; }
+
+	/// 一个 Slot 在显存中占用的字节数
+	int64 GetSlotBytes() const;
+
+	/// SlotTable 或高斯数据每次变化后更新，粒子据此判断缓存的静态数据是否失效，可以在任意线程读取
+	/// @note 所有 RenderResource 共享一个递增的计数器，所以换成新的 RenderResource 之后版本也一定变大
+	uint32 GetDataVersion() const { return DataVersion.load(std::memory_order_relaxed); }
+	static uint32 AllocateDataVersion();
+
+	// =============================== RT ===============================
+	uint32 GetResidentGaussianCount_RenderThread() const { return ResidentGaussianCount; }
+
+	/// 重新分配 Slot 池，保留的 Slot 在 GPU 上拷贝到新的池中，不需要重新上传
+	/// @param SlotRemap 新池中每个 Slot 对应的旧 Slot，INDEX_NONE 表示空，调用之后需要重新设置 SlotTable
+	void ResizePool_RenderThread(FRHICommandListImmediate& RHICmdList, int32 NewSlotCount,
+	                             const TArray<int32>& SlotRemap);
+
+	/// 把一个 Chunk 的数据上传到指定的 Slot，每个 Buffer 只锁定这个 Slot 对应的范围
+	void UploadChunk_RenderThread(FRHICommandListBase& RHICmdList, int32 ChunkIndex, int32 Slot);
+
+	/// 把编辑后的数据写入 CPU 上的打包数据，并只上传驻留 Chunk 中被修改的范围
+	void UpdateGaussians_RenderThread(FRHICommandListBase& RHICmdList, TArray<FSceneGaussianUpdate>& Updates);
+
+	/// 更新 SlotTable，ResidentSlots 中只有最后一个 Slot 可以不满
+	void UpdateSlotTable_RenderThread(FRHICommandListBase& RHICmdList, const TArray<uint32>& ResidentSlots,
+	                                  uint32 InResidentGaussianCount);
+
+	// =============================== Buffer ===============================
+	FSceneGaussianBuffer PositionOpacityBuffer;
+	FSceneGaussianBuffer ScaleBuffer;
+	FSceneGaussianBuffer RotationBuffer;
+	FSceneGaussianBuffer SHCoefficientsBuffer;
+
+	/// 第 i 个驻留的 Chunk 所在的 Slot
+	FSceneGaussianBuffer SlotTableBuffer;
+
+	/// 每个 Slot 两个 float4，分别是其中 Chunk 的 SplatBounds 的最小值和最大值，Tile 光栅化用来做遮挡剔除
+	FSceneGaussianBuffer SlotBoundsBuffer;
+
+	// =============================== GT 上的驻留状态，只由 FSceneStreamingManager 读写 ===============================
+	struct FResidency
+	{
+		/// 每个 Slot 中的 Chunk，INDEX_NONE 表示空
+		TArray<int32> SlotChunks;
+
+		/// 每个 Chunk 所在的 Slot，INDEX_NONE 表示不驻留
+		TArray<int32> ChunkSlots;
+
+		/// 这一帧使用这个资产的所有实例的变换
+		TArray<FTransform> InstanceTransforms;
+	};
+
+	FResidency& GetResidency_GameThread();
+
+	/// 由 Niagara Data Interface 在每个实例的 Tick 中调用，告诉流送管理器这个资产正在被使用
+	void ReportInstance_GameThread(const FTransform& InstanceTransform);
+
+private:
+	void CreateBuffers(FRHICommandListBase& RHICmdList);
+
+	/// 把 Chunk 的 SplatBounds 写入 Slot 对应的 SlotBoundsBuffer
+	void UploadSlotBounds_RenderThread(FRHICommandListBase& RHICmdList, int32 ChunkIndex, int32 Slot) const;
+
+	/// CPU 上保留一份打包好的数据，流送时直接从这里拷贝
+	FSceneGPUPayload Payload;
+	mutable FRWLock PayloadLock;
+
+	/// 除了 SplatBounds 之外只读，SplatBounds 只在 RT 上随编辑更新
+	TArray<FSceneChunk> Chunks;
+
+	uint32 GaussianCount = 0;
+	uint32 SHCoefficientsCount = 0;
+
+	int32 SlotCount = 0;
+	bool bInitiallyResident = false;
+	uint32 ResidentGaussianCount = 0;
+	std::atomic<uint32> DataVersion;
+
+	FResidency Residency;
+};
@@ -0,0 +1,73 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Tickable.h"
+
+class ACameraActor;
+class AActor;
+class USplineComponent;
+
+/// 沿关卡中的样条线匀速移动相机，逐帧记录耗时、绘制的高斯数量和内存，用于发现性能回退
+/// @note 通过控制台命令 GaussianSplattingX.Flythrough 启动，自动化时可以用 -game -ExecCmds 运行，加 -nullrhi 时 GPU 时间为 0
+/// @note 结束时把每帧的数据写入 CSV，给出基线 CSV 时比较各项的中位数和 P95，超出阈值记为回退，命令行带 -FlythroughExit 时以结果作为退出码
+class GAUSSIANSPLATTINGXRUNTIME_API FSceneFlythroughTest : public FTickableGameObject
+{
+public:
+	/// 在 World 中查找名称、标签或 Tag 为 SplineActorName 且带有样条线组件的 Actor，用 DurationSeconds 秒走完整条样条线
+	/// @param BaselinePath 为空时只写出结果，不做比较
+	static bool Start(UWorld* World, const FString& SplineActorName, float DurationSeconds, const FString& OutputPath,
+	                  const FString& BaselinePath);
+	static bool IsRunning();
+	static void Shutdown();
+
+	// =============================== FTickableGameObject ===============================
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual bool IsTickable() const override { return bRunning; }
+	virtual bool IsTickableWhenPaused() const override { return true; }
+
+private:
+	/// 一帧的测量结果，时间单位为毫秒，内存单位为 MB
+	struct FSample
+	{
+		int32 Frame = 0;
+		double Time = 0.0;
+		float FrameMs = 0.0f;
+		float GameThreadMs = 0.0f;
+		float RenderThreadMs = 0.0f;
+		float GPUMs = 0.0f;
+		int64 VisibleGaussians = 0;
+		float PoolMB = 0.0f;
+		float UsedPhysicalMB = 0.0f;
+		float BudgetQuality = 1.0f;
+	};
+
+	/// 和 FSample 的成员一一对应的 CSV 表头
+	static const TCHAR* CsvHeader;
+
+	void MoveCamera(float Distance) const;
+	void Finish();
+
+	/// 写出 CSV，返回是否成功
+	bool WriteCsv() const;
+
+	/// 和基线比较，返回是否没有回退
+	bool CompareWithBaseline() const;
+
+	TWeakObjectPtr<UWorld> World;
+	TWeakObjectPtr<USplineComponent> Spline;
+	TWeakObjectPtr<ACameraActor> Camera;
+
+	/// 开始前的观察目标，结束后恢复
+	TWeakObjectPtr<AActor> PreviousViewTarget;
+
+	float DurationSeconds = 0.0f;
+	FString OutputPath;
+	FString BaselinePath;
+
+	/// 从开始到现在经过的时间，包括预热
+	double ElapsedSeconds = 0.0;
+
+	TArray<FSample> Samples;
+	bool bRunning = false;
+};
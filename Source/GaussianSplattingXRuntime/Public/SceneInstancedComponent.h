@@ -0,0 +1,52 @@
+﻿#pragma once
+
+#include "NiagaraComponent.h"
+#include "SceneNiagaraParameter.h"
+
+#include "SceneInstancedComponent.generated.h"
+
+/// 用同一个 SceneBufferAsset 渲染多个实例，所有实例共享一份 GPU 数据，在同一个 Niagara System 中一起排序和绘制
+/// @note 实例的变换相对于这个组件
+UCLASS(ClassGroup = Rendering, meta = (BlueprintSpawnableComponent))
+class GAUSSIANSPLATTINGXRUNTIME_API USceneInstancedComponent : public UNiagaraComponent
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, Category = "Scene")
+	TObjectPtr<USceneNiagaraParameter> SceneNiagaraParameter;
+
+	UPROPERTY(EditAnywhere, Category = "Scene", meta = (MakeEditWidget))
+	TArray<FTransform> InstanceTransforms;
+
+	virtual void OnRegister() override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	// =============================== 实例 ===============================
+	/// 添加一个实例，返回实例的下标
+	UFUNCTION(BlueprintCallable, Category = "Scene")
+	int32 AddInstance(const FTransform& InstanceTransform);
+
+	UFUNCTION(BlueprintCallable, Category = "Scene")
+	bool RemoveInstance(int32 InstanceIndex);
+
+	UFUNCTION(BlueprintCallable, Category = "Scene")
+	bool UpdateInstanceTransform(int32 InstanceIndex, const FTransform& InstanceTransform);
+
+	UFUNCTION(BlueprintCallable, Category = "Scene")
+	void ClearInstances();
+
+	UFUNCTION(BlueprintPure, Category = "Scene")
+	int32 GetInstanceCount() const;
+
+	/// 实例变换每次被修改时递增，Data Interface 据此判断是否需要重新上传
+	uint32 GetInstanceTransformsVersion() const { return InstanceTransformsVersion; }
+
+private:
+	void MarkInstancesDirty();
+
+	uint32 InstanceTransformsVersion = 1;
+};
@@ -7,6 +7,8 @@
 
 #include "SceneNiagaraDataInterface.generated.h"
 
+struct FSceneGPUPayload;
+
 UCLASS(meta = (DisplayName = "Gaussian Splatting Niagara Data Interface"))
 class GAUSSIANSPLATTINGXRUNTIME_API USceneNiagaraDataInterface : public UNiagaraDataInterface
 {
@@ -22,13 +24,20 @@ private:
 	// =============================== 暴露给 HLSL（GPU）的数据结构 ===============================
 	BEGIN_SHADER_PARAMETER_STRUCT(FShaderParameters,)
 		SHADER_PARAMETER(int, GaussianCount)
+		SHADER_PARAMETER(int, ResidentGaussianCount)
+		SHADER_PARAMETER(int, ChunkSize)
 		SHADER_PARAMETER(int, SHCoefficientsCount)
+		SHADER_PARAMETER(float, MinOpacity)
+		SHADER_PARAMETER(int, MaxSHCoefficientsCount)
 		SHADER_PARAMETER(FMatrix44f, ActorTransformMatrix)
-		SHADER_PARAMETER(FVector4f, CameraPosition)
 		SHADER_PARAMETER_SRV(Buffer<FVector4f>, GaussianPositionOpacityBuffer)
 		SHADER_PARAMETER_SRV(Buffer<FVector4f>, GaussianScaleBuffer)
 		SHADER_PARAMETER_SRV(Buffer<FQuat4f>, GaussianRotationBuffer)
 		SHADER_PARAMETER_SRV(Buffer<FVector4f>, GaussianSHCoefficientsBuffer)
+		SHADER_PARAMETER_SRV(Buffer<uint>, SlotTableBuffer)
+		SHADER_PARAMETER(int, InstanceCount)
+		SHADER_PARAMETER_SRV(Buffer<FVector4f>, InstanceTransformBuffer)
+		SHADER_PARAMETER(int, DataVersion)
 	END_SHADER_PARAMETER_STRUCT()
 
 protected:
@@ -49,6 +58,8 @@ public:
 
 	// =============================== Niagara Data Interface 的配置 ===============================
 	virtual bool CanExecuteOnTarget(ENiagaraSimTarget Target) const override;
+	/// 相机位置来自 View Uniform Buffer
+	virtual bool RequiresEarlyViewData() const override;
 	/// 如果设置了 MemberFunction，那么 Niagara 会将当前的 Niagara Data Interface 对象复制到 Render Thread 中
 	virtual bool CopyToInternal(UNiagaraDataInterface* Destination) const override;
 	/// 用于比较两个 Data Interface 是否相等，决定是否需要重新编译 Niagara 系统或者重新传递数据
@@ -87,15 +98,37 @@ public:
 
 private:
 	// ============================== VM（CPU）实现 ===============================
-	// note: 都会在 RT 上执行
+	// note: 在 Niagara 的 CPU 模拟线程上执行，只能读取 GT 上的 InstanceData
+	// note: 高斯数据读取 RenderResource 的打包数据而不是资产的双精度数组：GT 上的编辑会直接修改资产的数组，
+	//       烘焙后的资产中它们也只是打包数据的副本；打包数据在读锁中读取，每个属性按 float4 对齐，可以直接加载到向量寄存器
 	void GetGaussianCountVM(FVectorVMExternalFunctionContext& Context) const;
+	void GetGaussianDataVM(FVectorVMExternalFunctionContext& Context) const;
+	void GetGaussianStaticDataVM(FVectorVMExternalFunctionContext& Context) const;
+	void GetGaussianViewColorVM(FVectorVMExternalFunctionContext& Context) const;
+	void GetDataVersionVM(FVectorVMExternalFunctionContext& Context) const;
+
+public:
+	/// 计算一个高斯的 GetGaussianData 输出，和 GPU 上的 GetGaussianDataInternal 一致
+	/// @param Index 高斯在资产中的下标
+	/// @param OutPosition 实例变换之后、Actor 变换之前的位置
+	/// @param MaxSHCoefficientsCount 计算颜色时最多使用的 SH 系数数量
+	static void EvaluateGaussianData(const FSceneGPUPayload& Payload, int32 Index, const FMatrix44f& InstanceMatrix,
+	                                 const FMatrix44f& ActorMatrix, const FVector3f& CameraPosition,
+	                                 FVector4f& OutPosition, FVector3f& OutColor,
+	                                 int32 MaxSHCoefficientsCount = MAX_int32);
+
+private:
 
 	// ============================== 辅助函数 ===============================
-	FTransform GetCameraTransform(const FNiagaraSystemInstance* SystemInstance) const;
+	/// VM 使用的相机位置，GPU 上每个视图使用自己的相机
+	FVector GetCameraLocation(const FNiagaraSystemInstance* SystemInstance) const;
 	FTransform GetActorTransform(FNiagaraSystemInstance* SystemInstance) const;
 
 private:
 	static const FName GetGaussianCountName;
 	static const FName GetGaussianDataName;
+	static const FName GetGaussianStaticDataName;
+	static const FName GetGaussianViewColorName;
+	static const FName GetDataVersionName;
 	static const FString GaussianShaderFile;
 };
@@ -0,0 +1,40 @@
+﻿#pragma once
+
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "SceneBVH.h"
+
+#include "SceneQueryLibrary.generated.h"
+
+class ASceneActor;
+
+/// 在 ASceneActor 的高斯上做射线检测和区域查询，输入输出都是世界空间
+/// @note 查询使用资产的 BVH，第一次查询某个资产时会构建，可以在设置中改为加载时构建
+UCLASS()
+class GAUSSIANSPLATTINGXRUNTIME_API USceneQueryLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	/// 从 Start 到 End 检测射线，累积不透明度超过 OpacityThreshold 的位置视为命中
+	UFUNCTION(BlueprintCallable, Category = "Gaussian Splatting X|Query")
+	static FSceneRaycastHit RaycastScene(ASceneActor* SceneActor, const FVector& Start, const FVector& End,
+	                                     float OpacityThreshold = 0.5f);
+
+	/// 同时检测多条射线，Starts 和 Ends 的长度必须相同
+	UFUNCTION(BlueprintCallable, Category = "Gaussian Splatting X|Query")
+	static TArray<FSceneRaycastHit> BatchRaycastScene(ASceneActor* SceneActor, const TArray<FVector>& Starts,
+	                                                  const TArray<FVector>& Ends, float OpacityThreshold = 0.5f);
+
+	/// 中心离 Location 最近的高斯，MaxDistance 内没有高斯时返回 false
+	UFUNCTION(BlueprintCallable, Category = "Gaussian Splatting X|Query")
+	static bool FindNearestGaussian(ASceneActor* SceneActor, const FVector& Location, float MaxDistance,
+	                                int32& OutGaussianIndex, FVector& OutGaussianLocation, float& OutDistance);
+
+	/// 中心在包围盒内的所有高斯的下标
+	UFUNCTION(BlueprintCallable, Category = "Gaussian Splatting X|Query")
+	static TArray<int32> OverlapBox(ASceneActor* SceneActor, const FBox& Box);
+
+	/// 中心在球内的所有高斯的下标
+	UFUNCTION(BlueprintCallable, Category = "Gaussian Splatting X|Query")
+	static TArray<int32> OverlapSphere(ASceneActor* SceneActor, const FVector& Center, float Radius);
+};
@@ -0,0 +1,105 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "ConvexVolume.h"
+#include "Tickable.h"
+
+class FSceneBufferRenderResource;
+class FSceneStreamingViewExtension;
+class UGaussianSplattingXSettings;
+
+/// 流送时使用的视图信息，来自上一帧渲染的所有视图
+struct FSceneStreamingView
+{
+	FVector Origin = FVector::ZeroVector;
+
+	/// 投影矩阵的缩放，等于 cot(FOV / 2)，用来把包围球的半径换算到屏幕空间
+	double ProjectionScale = 1.0;
+
+	FConvexVolume Frustum;
+};
+
+/// 按相机距离和屏幕覆盖率把 SceneBufferAsset 的 Chunk 流送进显存
+/// @note 所有资产共享插件设置中的显存预算，预算在这一帧正在使用的资产之间平均分配，用不完的部分分给其他资产
+/// @note 每个资产按 屏幕覆盖率 × 重要性 排序，优先级高的 Chunk 先加载，每帧上传的数据量有上限
+class GAUSSIANSPLATTINGXRUNTIME_API FSceneStreamingManager : public FTickableGameObject
+{
+public:
+	static void Startup();
+	static void Shutdown();
+	static FSceneStreamingManager& Get();
+
+	/// 创建 RenderResource 之后注册，资产释放 RenderResource 后会自动移除
+	void RegisterResource(const TSharedPtr<FSceneBufferRenderResource, ESPMode::ThreadSafe>& Resource);
+
+	/// 在 GT 上由视图扩展调用，记录这一帧渲染的视图
+	void AddView(const FSceneStreamingView& View);
+
+	/// 上一帧渲染的所有视图
+	const TArray<FSceneStreamingView>& GetViews() const { return Views; }
+
+	/// 挂起的资产立即释放所有 Slot，不管是否开启流送，取消挂起后重新按优先级加载
+	/// @note 用于被合并到其他资产中的 Actor，它们的高斯已经由合并后的资产绘制
+	void SetResourceSuspended(const FSceneBufferRenderResource* Resource, bool bSuspended);
+
+	/// 上一次 Tick 之后所有正在使用的实例绘制的高斯数量
+	int64 GetVisibleGaussianCount() const { return VisibleGaussianCount; }
+
+	/// 上一次 Tick 之后所有资产的 Slot 池占用的显存
+	int64 GetPoolBytes() const { return PoolBytes; }
+
+	// =============================== FTickableGameObject ===============================
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual bool IsTickableInEditor() const override { return true; }
+	virtual ETickableTickType GetTickableTickType() const override { return ETickableTickType::Always; }
+
+private:
+	struct FResourceEntry
+	{
+		TWeakPtr<FSceneBufferRenderResource, ESPMode::ThreadSafe> Resource;
+
+		/// 当前分配给这个资产的 Slot 数量，和这一帧按预算计算出的数量
+		int32 SlotCount = 0;
+		int32 TargetSlotCount = 0;
+
+		/// 最近一次被使用时所有实例的变换，以及那一帧的帧号
+		TArray<FTransform> InstanceTransforms;
+		uint64 LastUsedFrame = 0;
+
+		bool bSuspended = false;
+	};
+
+	/// 把显存预算按需求平均分给正在使用的资产
+	static void DistributeBudget(TArray<FResourceEntry*>& ActiveEntries, int64 BudgetBytes);
+
+	/// 计算每个 Chunk 在所有实例和视图中最大的优先级
+	void ComputePriorities(const FSceneBufferRenderResource& Resource, const TArray<FTransform>& InstanceTransforms,
+	                       float MinScreenCoverage, float OutOfViewPriorityScale, TArray<float>& OutPriorities) const;
+
+	/// 流送时按屏幕覆盖率计算优先级，关闭流送时只按重要性
+	void ComputeEntryPriorities(const FResourceEntry& Entry, const UGaussianSplattingXSettings& Settings,
+	                            TArray<float>& OutPriorities) const;
+
+	/// 把资产的池调整为 NewSlotCount 个 Slot，缩小时保留优先级最高的 Chunk，保留的 Chunk 在 GPU 上拷贝到新的池中
+	void ResizePool(FResourceEntry& Entry, int32 NewSlotCount, const UGaussianSplattingXSettings& Settings) const;
+
+	/// 根据优先级替换驻留的 Chunk，返回这一帧上传的字节数
+	/// @param ResidentChunkScale 最多驻留 Slot 数量的这个比例的 Chunk，超出的部分按优先级从低到高移出
+	static int64 UpdateResidency(const TSharedPtr<FSceneBufferRenderResource, ESPMode::ThreadSafe>& Resource,
+	                             const TArray<float>& Priorities, int64 UploadBudgetBytes, float ResidentChunkScale);
+
+	TArray<FResourceEntry> Entries;
+
+	/// 上一帧的视图，和这一帧正在收集的视图
+	TArray<FSceneStreamingView> Views;
+	TArray<FSceneStreamingView> PendingViews;
+
+	/// 每帧从不同的资产开始上传，避免总是同一个资产用掉上传预算
+	int32 FirstUploadEntry = 0;
+
+	int64 VisibleGaussianCount = 0;
+	int64 PoolBytes = 0;
+
+	TSharedPtr<FSceneStreamingViewExtension, ESPMode::ThreadSafe> ViewExtension;
+};
@@ -0,0 +1,21 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+
+class FSceneBufferRenderResource;
+class FSceneTileViewExtension;
+
+/// Compute 光栅化后端，不经过 Niagara，在后处理之前把所有选择这个后端的 Actor 一起光栅化并合成到 SceneColor
+/// @note Actor 每帧在 GT 上提交一次，渲染这一帧的所有视图都使用同一份列表
+class GAUSSIANSPLATTINGXRUNTIME_API FSceneTileRenderer
+{
+public:
+	static void Shutdown();
+
+	/// 提交这一帧需要绘制的资产实例，只能在 GT 调用
+	static void AddInstance_GameThread(const TSharedPtr<FSceneBufferRenderResource, ESPMode::ThreadSafe>& Resource,
+	                                   const FTransform& LocalToWorld);
+
+private:
+	static TSharedPtr<FSceneTileViewExtension, ESPMode::ThreadSafe> ViewExtension;
+};
@@ -0,0 +1,26 @@
+﻿using UnrealBuildTool;
+
+public class GaussianSplattingXShaders : ModuleRules
+{
+	public GaussianSplattingXShaders(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = ModuleRules.PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PublicDependencyModuleNames.AddRange(
+			[
+				"Core",
+				"RenderCore",
+				"Renderer",
+				"RHI"
+			]
+		);
+
+		PrivateDependencyModuleNames.AddRange(
+			[
+				"CoreUObject",
+				"Engine",
+				"Projects"
+			]
+		);
+	}
+}
@@ -0,0 +1,18 @@
+﻿#include "GaussianSplattingXShaders.h"
+
+#include "ShaderCore.h"
+#include "Interfaces/IPluginManager.h"
+
+#define LOCTEXT_NAMESPACE "FGaussianSplattingXShadersModule"
+
+void FGaussianSplattingXShadersModule::StartupModule()
+{
+	// 全局 Shader 必须在引擎初始化之前注册，所以 Shader 目录在这里映射，Niagara Data Interface 也使用这个目录
+	const FString PluginShaderDir = FPaths::Combine(
+		IPluginManager::Get().FindPlugin(TEXT("GaussianSplattingX"))->GetBaseDir(), TEXT("Shaders"));
+	AddShaderSourceDirectoryMapping(TEXT("/Plugin/GaussianSplattingX"), PluginShaderDir);
+}
+
+#undef LOCTEXT_NAMESPACE
+
+IMPLEMENT_MODULE(FGaussianSplattingXShadersModule, GaussianSplattingXShaders)
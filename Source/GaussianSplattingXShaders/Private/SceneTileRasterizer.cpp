@@ -0,0 +1,928 @@
+﻿#include "SceneTileRasterizer.h"
+
+#include "GlobalShader.h"
+#include "PixelShaderUtils.h"
+#include "RenderGraphBuilder.h"
+#include "RenderGraphUtils.h"
+#include "RHIGPUReadback.h"
+#include "SceneView.h"
+#include "ShaderParameterStruct.h"
+
+namespace
+{
+	/// 和 Shader 中的 FSplat 一致
+	constexpr uint32 SplatStride = sizeof(FVector4f) * 3;
+
+	constexpr int32 TileSize = 16;
+
+	/// 基数排序每个线程组的线程数和每个线程处理的条目数，每次排序 8 位
+	constexpr uint32 SortGroupSize = 256;
+	constexpr uint32 SortElementsPerThread = 8;
+	constexpr uint32 SortBlockSize = SortGroupSize * SortElementsPerThread;
+
+	/// 扫描时每个线程组负责的条目块数量，第二级扫描只需要串行处理条目块数量的 1/32
+	constexpr uint32 SortScanBlocksPerGroup = 32;
+	constexpr uint32 RadixSize = 256;
+
+	/// 还没有读回过条目数量时，按每个高斯平均覆盖这么多个 Tile 分配
+	constexpr uint32 InitialTilesPerSplat = 4;
+
+	/// 同时等待读回的条目数量最多有这么多个，读回通常在几帧之内完成
+	constexpr int32 MaxPendingEntryReadbacks = 8;
+
+	TAutoConsoleVariable<int32> CVarTileRasterAsyncCompute(
+		TEXT("GaussianSplattingX.TileRaster.AsyncCompute"),
+		1,
+		TEXT("Run the tile rasterizer preprocess passes on the async compute queue where it is supported."),
+		ECVF_RenderThreadSafe);
+
+	TAutoConsoleVariable<int32> CVarTileRasterStereoSharedPreprocess(
+		TEXT("GaussianSplattingX.TileRaster.StereoSharedPreprocess"),
+		1,
+		TEXT("Preprocess both eyes of a stereo pair in one pass, evaluating the SH color once from the midpoint of the eyes. ")
+		TEXT("Set to 0 to preprocess each eye separately if the shared color is visibly wrong."),
+		ECVF_RenderThreadSafe);
+
+	TAutoConsoleVariable<float> CVarTileRasterResolutionScale(
+		TEXT("GaussianSplattingX.TileRaster.ResolutionScale"),
+		1.0f,
+		TEXT("Resolution of the Gaussian layer relative to the view, e.g. 0.5 or 0.67. Values below 1 rasterize ")
+		TEXT("into a smaller target and upsample it with depth-aware weights when compositing. Multiplies with the ")
+		TEXT("engine's dynamic resolution."),
+		ECVF_Scalability | ECVF_RenderThreadSafe);
+
+	TAutoConsoleVariable<int32> CVarTileRasterOcclusionCulling(
+		TEXT("GaussianSplattingX.TileRaster.OcclusionCulling"),
+		1,
+		TEXT("Test the bounds of every resident chunk against the previous frame's HZB and skip preprocessing the ")
+		TEXT("Gaussians of chunks that are hidden behind scene geometry."),
+		ECVF_RenderThreadSafe);
+
+	TAutoConsoleVariable<int32> CVarTileRasterMaxTileEntries(
+		TEXT("GaussianSplattingX.TileRaster.MaxTileEntries"),
+		1 << 24,
+		TEXT("Upper bound on the per-view list of (splat, tile) pairs that is sorted each frame. The list is sized ")
+		TEXT("from the count read back from previous frames and costs 24 bytes per entry while sorting. Pairs beyond ")
+		TEXT("the capacity are dropped."),
+		ECVF_RenderThreadSafe);
+
+	/// 预处理的线程组大小，每个 Chunk 的高斯数量必须是它的整数倍
+	constexpr uint32 PreprocessGroupSize = 64;
+}
+
+/// 所有 Tile 光栅化 Shader 共享的编译选项
+class FSceneTileShader : public FGlobalShader
+{
+public:
+	FSceneTileShader() = default;
+
+	explicit FSceneTileShader(const ShaderMetaType::CompiledShaderInitializerType& Initializer)
+		: FGlobalShader(Initializer)
+	{
+	}
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+	}
+
+	static void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters,
+	                                         FShaderCompilerEnvironment& OutEnvironment)
+	{
+		FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+		OutEnvironment.SetDefine(TEXT("TILE_SIZE"), TileSize);
+		OutEnvironment.SetDefine(TEXT("SORT_GROUP_SIZE"), SortGroupSize);
+		OutEnvironment.SetDefine(TEXT("SORT_ELEMENTS_PER_THREAD"), SortElementsPerThread);
+		OutEnvironment.SetDefine(TEXT("SORT_SCAN_BLOCKS_PER_GROUP"), SortScanBlocksPerGroup);
+	}
+};
+
+class FSceneTilePreprocessCS : public FSceneTileShader
+{
+public:
+	DECLARE_GLOBAL_SHADER(FSceneTilePreprocessCS);
+	SHADER_USE_PARAMETER_STRUCT(FSceneTilePreprocessCS, FSceneTileShader);
+
+	/// 同时预处理立体渲染的两只眼睛
+	class FStereoDim : SHADER_PERMUTATION_BOOL("STEREO");
+
+	/// 间接派发，只处理遮挡剔除后剩下的 Chunk
+	class FOcclusionCullDim : SHADER_PERMUTATION_BOOL("OCCLUSION_CULL");
+	using FPermutationDomain = TShaderPermutationDomain<FStereoDim, FOcclusionCullDim>;
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters,)
+		SHADER_PARAMETER(uint32, ResidentGaussianCount)
+		SHADER_PARAMETER(uint32, ChunkSize)
+		SHADER_PARAMETER(uint32, SHCoefficientsCount)
+		SHADER_PARAMETER(float, MinOpacity)
+		SHADER_PARAMETER(uint32, MaxSHCoefficientsCount)
+		SHADER_PARAMETER(FVector3f, TranslatedWorldCameraOrigin)
+		SHADER_PARAMETER(FMatrix44f, LocalToTranslatedWorld)
+		SHADER_PARAMETER(FMatrix44f, TranslatedWorldToView)
+		SHADER_PARAMETER(FMatrix44f, ViewToClip)
+		SHADER_PARAMETER(FVector2f, ViewSize)
+		SHADER_PARAMETER(FUintVector2, TileCount)
+		SHADER_PARAMETER(FMatrix44f, LocalToTranslatedWorld1)
+		SHADER_PARAMETER(FMatrix44f, TranslatedWorldToView1)
+		SHADER_PARAMETER(FMatrix44f, ViewToClip1)
+		SHADER_PARAMETER(FVector2f, ViewSize1)
+		SHADER_PARAMETER(FUintVector2, TileCount1)
+		SHADER_PARAMETER(uint32, MaxTileEntries)
+		SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<float4>, PositionOpacityBuffer)
+		SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<float4>, ScaleBuffer)
+		SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<float4>, RotationBuffer)
+		SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<float4>, SHCoefficientsBuffer)
+		SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<uint>, SlotTableBuffer)
+		SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<uint>, VisibleChunks)
+		RDG_BUFFER_ACCESS(IndirectArgs, ERHIAccess::IndirectArgs)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWStructuredBuffer<FSplat>, RWSplats)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, RWSplatCounter)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, RWTileEntryCounter)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint2>, RWTileEntryKeys)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, RWTileEntrySplats)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWStructuredBuffer<FSplat>, RWSplats1)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, RWSplatCounter1)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, RWTileEntryCounter1)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint2>, RWTileEntryKeys1)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, RWTileEntrySplats1)
+	END_SHADER_PARAMETER_STRUCT()
+};
+
+IMPLEMENT_GLOBAL_SHADER(FSceneTilePreprocessCS, "/Plugin/GaussianSplattingX/Private/SceneTileRasterizer.usf",
+                        "PreprocessCS", SF_Compute);
+
+class FSceneTileCullChunksCS : public FSceneTileShader
+{
+public:
+	DECLARE_GLOBAL_SHADER(FSceneTileCullChunksCS);
+	SHADER_USE_PARAMETER_STRUCT(FSceneTileCullChunksCS, FSceneTileShader);
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters,)
+		SHADER_PARAMETER(uint32, ResidentChunkCount)
+		SHADER_PARAMETER(uint32, GroupsPerChunk)
+		SHADER_PARAMETER(uint32, NumOcclusionViews)
+		SHADER_PARAMETER(FMatrix44f, LocalToPrevClip)
+		SHADER_PARAMETER(FVector2f, HZBUvFactor)
+		SHADER_PARAMETER(FVector2f, HZBSize)
+		SHADER_PARAMETER(uint32, HZBMaxMip)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float>, HZBTexture)
+		SHADER_PARAMETER(FMatrix44f, LocalToPrevClip1)
+		SHADER_PARAMETER(FVector2f, HZBUvFactor1)
+		SHADER_PARAMETER(FVector2f, HZBSize1)
+		SHADER_PARAMETER(uint32, HZBMaxMip1)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float>, HZBTexture1)
+		SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<uint>, SlotTableBuffer)
+		SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<float4>, SlotBoundsBuffer)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, RWVisibleChunks)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, RWIndirectArgs)
+	END_SHADER_PARAMETER_STRUCT()
+};
+
+IMPLEMENT_GLOBAL_SHADER(FSceneTileCullChunksCS, "/Plugin/GaussianSplattingX/Private/SceneTileRasterizer.usf",
+                        "CullChunksCS", SF_Compute);
+
+/// 把截断到容量的条目数量写入间接派发参数
+class FSceneTilePrepareSortCS : public FSceneTileShader
+{
+public:
+	DECLARE_GLOBAL_SHADER(FSceneTilePrepareSortCS);
+	SHADER_USE_PARAMETER_STRUCT(FSceneTilePrepareSortCS, FSceneTileShader);
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters,)
+		SHADER_PARAMETER(uint32, MaxTileEntries)
+		SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<uint>, TileEntryCounter)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, RWSortCount)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, RWSortIndirectArgs)
+	END_SHADER_PARAMETER_STRUCT()
+};
+
+IMPLEMENT_GLOBAL_SHADER(FSceneTilePrepareSortCS, "/Plugin/GaussianSplattingX/Private/SceneTileRasterizer.usf",
+                        "PrepareSortCS", SF_Compute);
+
+/// 统计每个线程组中每个数位的条目数量
+class FSceneTileRadixCountCS : public FSceneTileShader
+{
+public:
+	DECLARE_GLOBAL_SHADER(FSceneTileRadixCountCS);
+	SHADER_USE_PARAMETER_STRUCT(FSceneTileRadixCountCS, FSceneTileShader);
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters,)
+		SHADER_PARAMETER(uint32, RadixKeyComponent)
+		SHADER_PARAMETER(uint32, RadixShift)
+		SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<uint>, SortCount)
+		SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<uint2>, SortKeys)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, RWBlockHistograms)
+		RDG_BUFFER_ACCESS(IndirectArgs, ERHIAccess::IndirectArgs)
+	END_SHADER_PARAMETER_STRUCT()
+};
+
+IMPLEMENT_GLOBAL_SHADER(FSceneTileRadixCountCS, "/Plugin/GaussianSplattingX/Private/SceneTileRasterizer.usf",
+                        "RadixCountCS", SF_Compute);
+
+/// 第一级扫描：每个扫描组内的条目块按数位扫描，输出扫描组的总数
+class FSceneTileRadixScanBlocksCS : public FSceneTileShader
+{
+public:
+	DECLARE_GLOBAL_SHADER(FSceneTileRadixScanBlocksCS);
+	SHADER_USE_PARAMETER_STRUCT(FSceneTileRadixScanBlocksCS, FSceneTileShader);
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters,)
+		SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<uint>, SortCount)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, RWBlockHistograms)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, RWScanGroupOffsets)
+		RDG_BUFFER_ACCESS(IndirectArgs, ERHIAccess::IndirectArgs)
+	END_SHADER_PARAMETER_STRUCT()
+};
+
+IMPLEMENT_GLOBAL_SHADER(FSceneTileRadixScanBlocksCS, "/Plugin/GaussianSplattingX/Private/SceneTileRasterizer.usf",
+                        "RadixScanBlocksCS", SF_Compute);
+
+/// 第二级扫描：扫描所有扫描组的总数，得到每个扫描组每个数位写入的起始位置
+class FSceneTileRadixScanGroupsCS : public FSceneTileShader
+{
+public:
+	DECLARE_GLOBAL_SHADER(FSceneTileRadixScanGroupsCS);
+	SHADER_USE_PARAMETER_STRUCT(FSceneTileRadixScanGroupsCS, FSceneTileShader);
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters,)
+		SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<uint>, SortCount)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, RWScanGroupOffsets)
+	END_SHADER_PARAMETER_STRUCT()
+};
+
+IMPLEMENT_GLOBAL_SHADER(FSceneTileRadixScanGroupsCS, "/Plugin/GaussianSplattingX/Private/SceneTileRasterizer.usf",
+                        "RadixScanGroupsCS", SF_Compute);
+
+/// 按数位稳定地写入另一组 Buffer
+class FSceneTileRadixScatterCS : public FSceneTileShader
+{
+public:
+	DECLARE_GLOBAL_SHADER(FSceneTileRadixScatterCS);
+	SHADER_USE_PARAMETER_STRUCT(FSceneTileRadixScatterCS, FSceneTileShader);
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters,)
+		SHADER_PARAMETER(uint32, RadixKeyComponent)
+		SHADER_PARAMETER(uint32, RadixShift)
+		SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<uint>, SortCount)
+		SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<uint2>, SortKeys)
+		SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<uint>, SortValues)
+		SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<uint>, BlockOffsets)
+		SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<uint>, ScanGroupOffsets)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint2>, RWSortKeys)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, RWSortValues)
+		RDG_BUFFER_ACCESS(IndirectArgs, ERHIAccess::IndirectArgs)
+	END_SHADER_PARAMETER_STRUCT()
+};
+
+IMPLEMENT_GLOBAL_SHADER(FSceneTileRadixScatterCS, "/Plugin/GaussianSplattingX/Private/SceneTileRasterizer.usf",
+                        "RadixScatterCS", SF_Compute);
+
+/// 从排序后的键中找出每个 Tile 的范围
+class FSceneTileRangesCS : public FSceneTileShader
+{
+public:
+	DECLARE_GLOBAL_SHADER(FSceneTileRangesCS);
+	SHADER_USE_PARAMETER_STRUCT(FSceneTileRangesCS, FSceneTileShader);
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters,)
+		SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<uint>, SortCount)
+		SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<uint2>, SortKeys)
+		SHADER_PARAMETER_RDG_BUFFER_UAV(RWBuffer<uint>, RWTileRanges)
+		RDG_BUFFER_ACCESS(IndirectArgs, ERHIAccess::IndirectArgs)
+	END_SHADER_PARAMETER_STRUCT()
+};
+
+IMPLEMENT_GLOBAL_SHADER(FSceneTileRangesCS, "/Plugin/GaussianSplattingX/Private/SceneTileRasterizer.usf",
+                        "TileRangesCS", SF_Compute);
+
+/// 在低分辨率下光栅化，合成时上采样
+class FSceneTileUpsampleDim : SHADER_PERMUTATION_BOOL("UPSAMPLE");
+
+class FSceneTileRasterizeCS : public FSceneTileShader
+{
+public:
+	DECLARE_GLOBAL_SHADER(FSceneTileRasterizeCS);
+	SHADER_USE_PARAMETER_STRUCT(FSceneTileRasterizeCS, FSceneTileShader);
+
+	using FPermutationDomain = TShaderPermutationDomain<FSceneTileUpsampleDim>;
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters,)
+		SHADER_PARAMETER_STRUCT_REF(FViewUniformShaderParameters, View)
+		SHADER_PARAMETER(FVector2f, ViewSize)
+		SHADER_PARAMETER(FIntPoint, ViewMin)
+		SHADER_PARAMETER(FUintVector2, TileCount)
+		SHADER_PARAMETER(FVector2f, RasterToViewScale)
+		SHADER_PARAMETER(FIntPoint, SceneViewSize)
+		SHADER_PARAMETER_RDG_BUFFER_SRV(StructuredBuffer<FSplat>, Splats)
+		SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<uint>, SortedSplats)
+		SHADER_PARAMETER_RDG_BUFFER_SRV(Buffer<uint>, TileRanges)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float>, SceneDepthTexture)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float4>, RWOutputTexture)
+		SHADER_PARAMETER_RDG_TEXTURE_UAV(RWTexture2D<float>, RWOutputDepthTexture)
+	END_SHADER_PARAMETER_STRUCT()
+};
+
+IMPLEMENT_GLOBAL_SHADER(FSceneTileRasterizeCS, "/Plugin/GaussianSplattingX/Private/SceneTileRasterizer.usf",
+                        "RasterizeCS", SF_Compute);
+
+class FSceneTileCompositePS : public FSceneTileShader
+{
+public:
+	DECLARE_GLOBAL_SHADER(FSceneTileCompositePS);
+	SHADER_USE_PARAMETER_STRUCT(FSceneTileCompositePS, FSceneTileShader);
+
+	using FPermutationDomain = TShaderPermutationDomain<FSceneTileUpsampleDim>;
+
+	BEGIN_SHADER_PARAMETER_STRUCT(FParameters,)
+		SHADER_PARAMETER_STRUCT_REF(FViewUniformShaderParameters, View)
+		SHADER_PARAMETER(FIntPoint, ViewMin)
+		SHADER_PARAMETER(FIntPoint, RasterSize)
+		SHADER_PARAMETER(FVector2f, ViewToRasterScale)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float4>, SplatTexture)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float>, SplatDepthTexture)
+		SHADER_PARAMETER_RDG_TEXTURE(Texture2D<float>, SceneDepthTexture)
+		RENDER_TARGET_BINDING_SLOTS()
+	END_SHADER_PARAMETER_STRUCT()
+};
+
+IMPLEMENT_GLOBAL_SHADER(FSceneTileCompositePS, "/Plugin/GaussianSplattingX/Private/SceneTileRasterizer.usf",
+                        "CompositePS", SF_Pixel);
+
+namespace
+{
+	/// 一个视图的预处理结果和写入它们的 UAV
+	struct FPreprocessTarget
+	{
+		const FSceneView* View = nullptr;
+		FSceneTileOcclusion Occlusion;
+		FSceneTilePreprocessOutput Output;
+		FRDGBufferUAVRef SplatsUAV = nullptr;
+		FRDGBufferUAVRef SplatCounterUAV = nullptr;
+
+		/// 预处理追加的 Tile 条目，排序时作为第一组 Buffer
+		uint32 MaxTileEntries = 0;
+		FRDGBufferRef TileEntryCounter = nullptr;
+		FRDGBufferRef TileEntryKeys = nullptr;
+		FRDGBufferRef TileEntrySplats = nullptr;
+		FRDGBufferUAVRef TileEntryCounterUAV = nullptr;
+		FRDGBufferUAVRef TileEntryKeysUAV = nullptr;
+		FRDGBufferUAVRef TileEntrySplatsUAV = nullptr;
+	};
+
+	uint32 GetTotalResidentGaussians(const TConstArrayView<FSceneTileRasterInput> Inputs)
+	{
+		uint32 TotalResidentGaussians = 0;
+		for (const FSceneTileRasterInput& Input : Inputs)
+		{
+			TotalResidentGaussians += Input.ResidentGaussianCount;
+		}
+		return TotalResidentGaussians;
+	}
+
+	/// 预处理只读取常驻的 Buffer，RDG 在 SceneDepth 等依赖处自动插入跨队列的同步
+	ERDGPassFlags GetPreprocessPassFlags()
+	{
+		return GSupportsEfficientAsyncCompute && CVarTileRasterAsyncCompute.GetValueOnRenderThread() != 0
+			       ? ERDGPassFlags::AsyncCompute
+			       : ERDGPassFlags::Compute;
+	}
+
+	FPreprocessTarget CreatePreprocessTarget(FRDGBuilder& GraphBuilder, const FSceneView& View,
+	                                         const FIntRect& ViewRect, const FSceneTileOcclusion& Occlusion,
+	                                         const uint32 MaxSplats, const uint32 MaxTileEntries,
+	                                         const ERDGPassFlags PassFlags)
+	{
+		FPreprocessTarget Target;
+		Target.View = &View;
+		Target.Occlusion = Occlusion;
+
+		// 投影到光栅化分辨率的屏幕上，Tile 也按光栅化分辨率划分
+		const float ResolutionScale = FMath::Clamp(CVarTileRasterResolutionScale.GetValueOnRenderThread(), 0.25f, 1.0f);
+		const FIntPoint RasterSize = ResolutionScale < 1.0f
+			                             ? FIntPoint(
+				                             FMath::Max(FMath::CeilToInt(ViewRect.Width() * ResolutionScale), 1),
+				                             FMath::Max(FMath::CeilToInt(ViewRect.Height() * ResolutionScale), 1))
+			                             : ViewRect.Size();
+		const FIntPoint TileCount = FIntPoint::DivideAndRoundUp(RasterSize, TileSize);
+		const int32 NumTiles = TileCount.X * TileCount.Y;
+		FSceneTilePreprocessOutput& Output = Target.Output;
+		Output.ViewRect = ViewRect;
+		Output.RasterSize = RasterSize;
+		Output.TileCount = TileCount;
+
+		Output.Splats = GraphBuilder.CreateBuffer(
+			FRDGBufferDesc::CreateStructuredDesc(SplatStride, MaxSplats), TEXT("GaussianSplattingX.Splats"));
+		FRDGBufferRef SplatCounter = GraphBuilder.CreateBuffer(
+			FRDGBufferDesc::CreateBufferDesc(sizeof(uint32), 1), TEXT("GaussianSplattingX.SplatCounter"));
+		Output.TileRanges = GraphBuilder.CreateBuffer(
+			FRDGBufferDesc::CreateBufferDesc(sizeof(uint32), NumTiles * 2), TEXT("GaussianSplattingX.TileRanges"));
+
+		Target.MaxTileEntries = MaxTileEntries;
+		Target.TileEntryCounter = GraphBuilder.CreateBuffer(
+			FRDGBufferDesc::CreateBufferDesc(sizeof(uint32), 1), TEXT("GaussianSplattingX.TileEntryCounter"));
+		Target.TileEntryKeys = GraphBuilder.CreateBuffer(
+			FRDGBufferDesc::CreateBufferDesc(sizeof(uint32) * 2, Target.MaxTileEntries),
+			TEXT("GaussianSplattingX.TileEntryKeys"));
+		Target.TileEntrySplats = GraphBuilder.CreateBuffer(
+			FRDGBufferDesc::CreateBufferDesc(sizeof(uint32), Target.MaxTileEntries),
+			TEXT("GaussianSplattingX.TileEntrySplats"));
+
+		AddClearUAVPass(GraphBuilder, PassFlags, GraphBuilder.CreateUAV(SplatCounter, PF_R32_UINT), 0u);
+		AddClearUAVPass(GraphBuilder, PassFlags, GraphBuilder.CreateUAV(Target.TileEntryCounter, PF_R32_UINT), 0u);
+
+		// 所有输入只做原子追加，可以互相重叠执行
+		constexpr ERDGUnorderedAccessViewFlags Flags = ERDGUnorderedAccessViewFlags::SkipBarrier;
+		Target.SplatsUAV = GraphBuilder.CreateUAV(FRDGBufferUAVDesc(Output.Splats), Flags);
+		Target.SplatCounterUAV = GraphBuilder.CreateUAV(FRDGBufferUAVDesc(SplatCounter, PF_R32_UINT), Flags);
+		Target.TileEntryCounterUAV = GraphBuilder.CreateUAV(
+			FRDGBufferUAVDesc(Target.TileEntryCounter, PF_R32_UINT), Flags);
+		Target.TileEntryKeysUAV = GraphBuilder.CreateUAV(FRDGBufferUAVDesc(Target.TileEntryKeys, PF_R32G32_UINT),
+		                                                 Flags);
+		Target.TileEntrySplatsUAV = GraphBuilder.CreateUAV(
+			FRDGBufferUAVDesc(Target.TileEntrySplats, PF_R32_UINT), Flags);
+		return Target;
+	}
+
+	void SetOcclusionParameters(const FSceneTileOcclusion& Occlusion, const FMatrix& LocalToWorld,
+	                            FMatrix44f& OutLocalToPrevClip, FVector2f& OutHZBUvFactor, FVector2f& OutHZBSize,
+	                            uint32& OutHZBMaxMip, FRDGTextureRef& OutHZBTexture)
+	{
+		// HZB 第 0 级的一个纹素对应视图中的 2x2 像素，尺寸向上取整到 2 的幂，只有左上角对应视图范围
+		const FIntPoint HZBExtent = Occlusion.HZB->Desc.Extent;
+		OutLocalToPrevClip = FMatrix44f(
+			LocalToWorld * FTranslationMatrix(Occlusion.PreViewTranslation) * Occlusion.TranslatedWorldToClip);
+		OutHZBUvFactor = FVector2f(Occlusion.ViewRect.Size()) / (2.0f * FVector2f(HZBExtent));
+		OutHZBSize = FVector2f(HZBExtent);
+		OutHZBMaxMip = Occlusion.HZB->Desc.NumMips - 1;
+		OutHZBTexture = Occlusion.HZB;
+	}
+
+	/// 用上一帧的 HZB 剔除一个输入中被遮挡的 Chunk，输出可见 Chunk 的列表和预处理的间接派发参数
+	/// @note Target1 不为空时只剔除在两个视图中都被遮挡的 Chunk
+	FRDGBufferRef AddCullChunksPass(FRDGBuilder& GraphBuilder, const FPreprocessTarget& Target,
+	                                const FPreprocessTarget* Target1, const FSceneTileRasterInput& Input,
+	                                const ERDGPassFlags PassFlags, FRDGBufferSRVRef& OutVisibleChunks)
+	{
+		const uint32 ResidentChunkCount = FMath::DivideAndRoundUp(Input.ResidentGaussianCount, Input.ChunkSize);
+		FRDGBufferRef VisibleChunks = GraphBuilder.CreateBuffer(
+			FRDGBufferDesc::CreateBufferDesc(sizeof(uint32), ResidentChunkCount),
+			TEXT("GaussianSplattingX.VisibleChunks"));
+		FRDGBufferRef IndirectArgs = GraphBuilder.CreateBuffer(
+			FRDGBufferDesc::CreateIndirectDesc<FRHIDispatchIndirectParameters>(1),
+			TEXT("GaussianSplattingX.PreprocessIndirectArgs"));
+		FRDGBufferUAVRef IndirectArgsUAV = GraphBuilder.CreateUAV(IndirectArgs, PF_R32_UINT);
+		AddClearUAVPass(GraphBuilder, PassFlags, IndirectArgsUAV, 0u);
+
+		FSceneTileCullChunksCS::FParameters* Parameters = GraphBuilder.AllocParameters<
+			FSceneTileCullChunksCS::FParameters>();
+		Parameters->ResidentChunkCount = ResidentChunkCount;
+		Parameters->GroupsPerChunk = Input.ChunkSize / PreprocessGroupSize;
+		Parameters->NumOcclusionViews = Target1 ? 2 : 1;
+		SetOcclusionParameters(Target.Occlusion, Input.LocalToWorld, Parameters->LocalToPrevClip,
+		                       Parameters->HZBUvFactor, Parameters->HZBSize, Parameters->HZBMaxMip,
+		                       Parameters->HZBTexture);
+		SetOcclusionParameters(Target1 ? Target1->Occlusion : Target.Occlusion, Input.LocalToWorld,
+		                       Parameters->LocalToPrevClip1, Parameters->HZBUvFactor1, Parameters->HZBSize1,
+		                       Parameters->HZBMaxMip1, Parameters->HZBTexture1);
+		Parameters->SlotTableBuffer = Input.SlotTableBuffer;
+		Parameters->SlotBoundsBuffer = Input.SlotBoundsBuffer;
+		Parameters->RWVisibleChunks = GraphBuilder.CreateUAV(VisibleChunks, PF_R32_UINT);
+		Parameters->RWIndirectArgs = IndirectArgsUAV;
+
+		FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("CullChunks (%u)", ResidentChunkCount), PassFlags,
+		                             TShaderMapRef<FSceneTileCullChunksCS>(
+			                             GetGlobalShaderMap(Target.View->GetFeatureLevel())),
+		                             Parameters, FComputeShaderUtils::GetGroupCount(ResidentChunkCount, 64u));
+
+		OutVisibleChunks = GraphBuilder.CreateSRV(VisibleChunks, PF_R32_UINT);
+		return IndirectArgs;
+	}
+
+	/// 每个输入一个 Pass，Target1 不为空时同一个 Pass 也写入第二只眼睛
+	void AddPreprocessPasses(FRDGBuilder& GraphBuilder, const FPreprocessTarget& Target,
+	                         const FPreprocessTarget* Target1, const TConstArrayView<FSceneTileRasterInput> Inputs,
+	                         const ERDGPassFlags PassFlags)
+	{
+		const FSceneView& View = *Target.View;
+		const FViewMatrices& ViewMatrices = View.ViewMatrices;
+		const FVector PreViewTranslation = ViewMatrices.GetPreViewTranslation();
+
+		// 立体渲染时从两只眼睛的中点计算颜色
+		FVector CameraOrigin = ViewMatrices.GetViewOrigin();
+		if (Target1)
+		{
+			CameraOrigin = 0.5 * (CameraOrigin + Target1->View->ViewMatrices.GetViewOrigin());
+		}
+
+		// 立体渲染时两个视图都有 HZB 才能剔除
+		const bool bOcclusionCull = CVarTileRasterOcclusionCulling.GetValueOnRenderThread() != 0 &&
+			Target.Occlusion.IsValid() && (!Target1 || Target1->Occlusion.IsValid());
+		FGlobalShaderMap* ShaderMap = GetGlobalShaderMap(View.GetFeatureLevel());
+
+		for (const FSceneTileRasterInput& Input : Inputs)
+		{
+			if (Input.ResidentGaussianCount == 0)
+			{
+				continue;
+			}
+
+			FSceneTilePreprocessCS::FParameters* Parameters = GraphBuilder.AllocParameters<
+				FSceneTilePreprocessCS::FParameters>();
+			Parameters->ResidentGaussianCount = Input.ResidentGaussianCount;
+			Parameters->ChunkSize = Input.ChunkSize;
+			Parameters->SHCoefficientsCount = Input.SHCoefficientsCount;
+			Parameters->MinOpacity = Input.MinOpacity;
+			Parameters->MaxSHCoefficientsCount = FMath::Min(Input.MaxSHCoefficientsCount, Input.SHCoefficientsCount);
+			Parameters->TranslatedWorldCameraOrigin = FVector3f(CameraOrigin + PreViewTranslation);
+			Parameters->LocalToTranslatedWorld = FMatrix44f(
+				Input.LocalToWorld * FTranslationMatrix(PreViewTranslation));
+			Parameters->TranslatedWorldToView = FMatrix44f(ViewMatrices.GetTranslatedViewMatrix());
+			Parameters->ViewToClip = FMatrix44f(ViewMatrices.GetProjectionMatrix());
+			Parameters->ViewSize = FVector2f(Target.Output.RasterSize);
+			Parameters->TileCount = FUintVector2(Target.Output.TileCount.X, Target.Output.TileCount.Y);
+			Parameters->MaxTileEntries = Target.MaxTileEntries;
+			Parameters->PositionOpacityBuffer = Input.PositionOpacityBuffer;
+			Parameters->ScaleBuffer = Input.ScaleBuffer;
+			Parameters->RotationBuffer = Input.RotationBuffer;
+			Parameters->SHCoefficientsBuffer = Input.SHCoefficientsBuffer;
+			Parameters->SlotTableBuffer = Input.SlotTableBuffer;
+			Parameters->RWSplats = Target.SplatsUAV;
+			Parameters->RWSplatCounter = Target.SplatCounterUAV;
+			Parameters->RWTileEntryCounter = Target.TileEntryCounterUAV;
+			Parameters->RWTileEntryKeys = Target.TileEntryKeysUAV;
+			Parameters->RWTileEntrySplats = Target.TileEntrySplatsUAV;
+			if (Target1)
+			{
+				const FViewMatrices& ViewMatrices1 = Target1->View->ViewMatrices;
+				Parameters->LocalToTranslatedWorld1 = FMatrix44f(
+					Input.LocalToWorld * FTranslationMatrix(ViewMatrices1.GetPreViewTranslation()));
+				Parameters->TranslatedWorldToView1 = FMatrix44f(ViewMatrices1.GetTranslatedViewMatrix());
+				Parameters->ViewToClip1 = FMatrix44f(ViewMatrices1.GetProjectionMatrix());
+				Parameters->ViewSize1 = FVector2f(Target1->Output.RasterSize);
+				Parameters->TileCount1 = FUintVector2(Target1->Output.TileCount.X, Target1->Output.TileCount.Y);
+				Parameters->RWSplats1 = Target1->SplatsUAV;
+				Parameters->RWSplatCounter1 = Target1->SplatCounterUAV;
+				Parameters->RWTileEntryCounter1 = Target1->TileEntryCounterUAV;
+				Parameters->RWTileEntryKeys1 = Target1->TileEntryKeysUAV;
+				Parameters->RWTileEntrySplats1 = Target1->TileEntrySplatsUAV;
+			}
+
+			// 剔除之后间接派发，每个可见的 Chunk 占 ChunkSize 个线程，被遮挡的 Chunk 不启动线程
+			FRDGBufferRef IndirectArgs = nullptr;
+			if (bOcclusionCull && Input.SlotBoundsBuffer && Input.ChunkSize % PreprocessGroupSize == 0)
+			{
+				IndirectArgs = AddCullChunksPass(GraphBuilder, Target, Target1, Input, PassFlags,
+				                                 Parameters->VisibleChunks);
+				Parameters->IndirectArgs = IndirectArgs;
+			}
+
+			FSceneTilePreprocessCS::FPermutationDomain PermutationVector;
+			PermutationVector.Set<FSceneTilePreprocessCS::FStereoDim>(Target1 != nullptr);
+			PermutationVector.Set<FSceneTilePreprocessCS::FOcclusionCullDim>(IndirectArgs != nullptr);
+			const TShaderMapRef<FSceneTilePreprocessCS> ComputeShader(ShaderMap, PermutationVector);
+			FRDGEventName PassName = RDG_EVENT_NAME("Preprocess%s%s (%u)", Target1 ? TEXT(" Stereo") : TEXT(""),
+			                                        IndirectArgs ? TEXT(" Culled") : TEXT(""),
+			                                        Input.ResidentGaussianCount);
+			if (IndirectArgs)
+			{
+				FComputeShaderUtils::AddPass(GraphBuilder, MoveTemp(PassName), PassFlags, ComputeShader, Parameters,
+				                             IndirectArgs, 0);
+			}
+			else
+			{
+				FComputeShaderUtils::AddPass(GraphBuilder, MoveTemp(PassName), PassFlags, ComputeShader, Parameters,
+				                             FComputeShaderUtils::GetGroupCount(Input.ResidentGaussianCount,
+				                                                                PreprocessGroupSize));
+			}
+		}
+	}
+
+	/// 按 (Tile, 深度) 对所有条目做稳定的基数排序，每次 8 位，先排深度再排 Tile，然后找出每个 Tile 的范围
+	/// @note 条目数量只在 GPU 上知道，所有 Pass 都按截断到容量后的数量间接派发
+	void AddSortPasses(FRDGBuilder& GraphBuilder, FPreprocessTarget& Target, const ERDGPassFlags PassFlags)
+	{
+		FGlobalShaderMap* ShaderMap = GetGlobalShaderMap(Target.View->GetFeatureLevel());
+		const uint32 NumTiles = Target.Output.TileCount.X * Target.Output.TileCount.Y;
+		const uint32 MaxBlocks = FMath::DivideAndRoundUp(Target.MaxTileEntries, SortBlockSize);
+
+		FRDGBufferRef SortCount = GraphBuilder.CreateBuffer(FRDGBufferDesc::CreateBufferDesc(sizeof(uint32), 1),
+		                                                    TEXT("GaussianSplattingX.SortCount"));
+		FRDGBufferRef IndirectArgs = GraphBuilder.CreateBuffer(
+			FRDGBufferDesc::CreateIndirectDesc<FRHIDispatchIndirectParameters>(2),
+			TEXT("GaussianSplattingX.SortIndirectArgs"));
+		constexpr uint32 ScanIndirectArgsOffset = sizeof(FRHIDispatchIndirectParameters);
+		{
+			FSceneTilePrepareSortCS::FParameters* Parameters = GraphBuilder.AllocParameters<
+				FSceneTilePrepareSortCS::FParameters>();
+			Parameters->MaxTileEntries = Target.MaxTileEntries;
+			Parameters->TileEntryCounter = GraphBuilder.CreateSRV(Target.TileEntryCounter, PF_R32_UINT);
+			Parameters->RWSortCount = GraphBuilder.CreateUAV(SortCount, PF_R32_UINT);
+			Parameters->RWSortIndirectArgs = GraphBuilder.CreateUAV(IndirectArgs, PF_R32_UINT);
+			FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("PrepareSort"), PassFlags,
+			                             TShaderMapRef<FSceneTilePrepareSortCS>(ShaderMap), Parameters,
+			                             FIntVector(1, 1, 1));
+		}
+		FRDGBufferSRVRef SortCountSRV = GraphBuilder.CreateSRV(SortCount, PF_R32_UINT);
+
+		FRDGBufferRef Keys[2] = {
+			Target.TileEntryKeys,
+			GraphBuilder.CreateBuffer(FRDGBufferDesc::CreateBufferDesc(sizeof(uint32) * 2, Target.MaxTileEntries),
+			                          TEXT("GaussianSplattingX.SortKeys"))
+		};
+		FRDGBufferRef Values[2] = {
+			Target.TileEntrySplats,
+			GraphBuilder.CreateBuffer(FRDGBufferDesc::CreateBufferDesc(sizeof(uint32), Target.MaxTileEntries),
+			                          TEXT("GaussianSplattingX.SortValues"))
+		};
+		FRDGBufferRef BlockHistograms = GraphBuilder.CreateBuffer(
+			FRDGBufferDesc::CreateBufferDesc(sizeof(uint32), RadixSize * MaxBlocks),
+			TEXT("GaussianSplattingX.SortBlockHistograms"));
+		FRDGBufferRef ScanGroupOffsets = GraphBuilder.CreateBuffer(
+			FRDGBufferDesc::CreateBufferDesc(
+				sizeof(uint32), RadixSize * FMath::DivideAndRoundUp(MaxBlocks, SortScanBlocksPerGroup)),
+			TEXT("GaussianSplattingX.SortScanGroupOffsets"));
+
+		// 深度的 32 位全部参与排序，Tile 序号只排到最高的有效位
+		TArray<FUintVector2, TInlineAllocator<8>> Digits;
+		for (uint32 Shift = 0; Shift < 32; Shift += 8)
+		{
+			Digits.Add(FUintVector2(0, Shift));
+		}
+		for (uint32 Shift = 0; Shift < 32 && (1ull << Shift) < NumTiles; Shift += 8)
+		{
+			Digits.Add(FUintVector2(1, Shift));
+		}
+
+		int32 Source = 0;
+		for (const FUintVector2& Digit : Digits)
+		{
+			RDG_EVENT_SCOPE(GraphBuilder, "RadixSort (Key%u >> %u)", Digit.X, Digit.Y);
+			FRDGBufferSRVRef KeysSRV = GraphBuilder.CreateSRV(Keys[Source], PF_R32G32_UINT);
+			{
+				FSceneTileRadixCountCS::FParameters* Parameters = GraphBuilder.AllocParameters<
+					FSceneTileRadixCountCS::FParameters>();
+				Parameters->RadixKeyComponent = Digit.X;
+				Parameters->RadixShift = Digit.Y;
+				Parameters->SortCount = SortCountSRV;
+				Parameters->SortKeys = KeysSRV;
+				Parameters->RWBlockHistograms = GraphBuilder.CreateUAV(BlockHistograms, PF_R32_UINT);
+				Parameters->IndirectArgs = IndirectArgs;
+				FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("Count"), PassFlags,
+				                             TShaderMapRef<FSceneTileRadixCountCS>(ShaderMap), Parameters,
+				                             IndirectArgs, 0);
+			}
+			{
+				FSceneTileRadixScanBlocksCS::FParameters* Parameters = GraphBuilder.AllocParameters<
+					FSceneTileRadixScanBlocksCS::FParameters>();
+				Parameters->SortCount = SortCountSRV;
+				Parameters->RWBlockHistograms = GraphBuilder.CreateUAV(BlockHistograms, PF_R32_UINT);
+				Parameters->RWScanGroupOffsets = GraphBuilder.CreateUAV(ScanGroupOffsets, PF_R32_UINT);
+				Parameters->IndirectArgs = IndirectArgs;
+				FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("ScanBlocks"), PassFlags,
+				                             TShaderMapRef<FSceneTileRadixScanBlocksCS>(ShaderMap), Parameters,
+				                             IndirectArgs, ScanIndirectArgsOffset);
+			}
+			{
+				FSceneTileRadixScanGroupsCS::FParameters* Parameters = GraphBuilder.AllocParameters<
+					FSceneTileRadixScanGroupsCS::FParameters>();
+				Parameters->SortCount = SortCountSRV;
+				Parameters->RWScanGroupOffsets = GraphBuilder.CreateUAV(ScanGroupOffsets, PF_R32_UINT);
+				FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("ScanGroups"), PassFlags,
+				                             TShaderMapRef<FSceneTileRadixScanGroupsCS>(ShaderMap), Parameters,
+				                             FIntVector(1, 1, 1));
+			}
+			{
+				FSceneTileRadixScatterCS::FParameters* Parameters = GraphBuilder.AllocParameters<
+					FSceneTileRadixScatterCS::FParameters>();
+				Parameters->RadixKeyComponent = Digit.X;
+				Parameters->RadixShift = Digit.Y;
+				Parameters->SortCount = SortCountSRV;
+				Parameters->SortKeys = KeysSRV;
+				Parameters->SortValues = GraphBuilder.CreateSRV(Values[Source], PF_R32_UINT);
+				Parameters->BlockOffsets = GraphBuilder.CreateSRV(BlockHistograms, PF_R32_UINT);
+				Parameters->ScanGroupOffsets = GraphBuilder.CreateSRV(ScanGroupOffsets, PF_R32_UINT);
+				Parameters->RWSortKeys = GraphBuilder.CreateUAV(Keys[1 - Source], PF_R32G32_UINT);
+				Parameters->RWSortValues = GraphBuilder.CreateUAV(Values[1 - Source], PF_R32_UINT);
+				Parameters->IndirectArgs = IndirectArgs;
+				FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("Scatter"), PassFlags,
+				                             TShaderMapRef<FSceneTileRadixScatterCS>(ShaderMap), Parameters,
+				                             IndirectArgs, 0);
+			}
+			Source = 1 - Source;
+		}
+
+		// 没有条目的 Tile 范围为空
+		FRDGBufferUAVRef TileRangesUAV = GraphBuilder.CreateUAV(Target.Output.TileRanges, PF_R32_UINT);
+		AddClearUAVPass(GraphBuilder, PassFlags, TileRangesUAV, 0u);
+		{
+			FSceneTileRangesCS::FParameters* Parameters = GraphBuilder.AllocParameters<
+				FSceneTileRangesCS::FParameters>();
+			Parameters->SortCount = SortCountSRV;
+			Parameters->SortKeys = GraphBuilder.CreateSRV(Keys[Source], PF_R32G32_UINT);
+			Parameters->RWTileRanges = TileRangesUAV;
+			Parameters->IndirectArgs = IndirectArgs;
+			FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("TileRanges"), PassFlags,
+			                             TShaderMapRef<FSceneTileRangesCS>(ShaderMap), Parameters, IndirectArgs, 0);
+		}
+
+		Target.Output.SortedSplats = Values[Source];
+	}
+}
+
+bool IsSceneTilePreprocessAsync()
+{
+	return GetPreprocessPassFlags() == ERDGPassFlags::AsyncCompute;
+}
+
+FSceneTileEntryCapacity::FSceneTileEntryCapacity() = default;
+
+FSceneTileEntryCapacity::~FSceneTileEntryCapacity() = default;
+
+uint32 FSceneTileEntryCapacity::GetCapacity(const uint32 MaxSplats)
+{
+	ResolveReadbacks();
+
+	// 留出余量，数量慢慢增长时不会丢弃条目
+	const uint64 Capacity = EstimatedEntries > 0
+		                        ? EstimatedEntries + EstimatedEntries / 4
+		                        : static_cast<uint64>(MaxSplats) * InitialTilesPerSplat;
+	const uint32 MaxCapacity = FMath::Max<uint32>(CVarTileRasterMaxTileEntries.GetValueOnRenderThread(),
+	                                              SortBlockSize);
+	return static_cast<uint32>(FMath::Clamp<uint64>(Align(Capacity, SortBlockSize), SortBlockSize, MaxCapacity));
+}
+
+void FSceneTileEntryCapacity::AddReadback(FRDGBuilder& GraphBuilder, FRDGBufferRef EntryCounter)
+{
+	if (Readbacks.Num() >= MaxPendingEntryReadbacks)
+	{
+		return;
+	}
+
+	FRHIGPUBufferReadback* Readback = Readbacks.Add_GetRef(
+		MakeUnique<FRHIGPUBufferReadback>(TEXT("GaussianSplattingX.TileEntryCounterReadback"))).Get();
+	AddEnqueueCopyPass(GraphBuilder, Readback, EntryCounter, sizeof(uint32));
+}
+
+void FSceneTileEntryCapacity::ResolveReadbacks()
+{
+	int32 NumResolved = 0;
+	for (; NumResolved < Readbacks.Num() && Readbacks[NumResolved]->IsReady(); ++NumResolved)
+	{
+		// 计数包含超出容量被丢弃的条目，下一帧按实际数量分配；数量减少时慢慢收缩
+		const uint32 Count = *static_cast<const uint32*>(Readbacks[NumResolved]->Lock(sizeof(uint32)));
+		Readbacks[NumResolved]->Unlock();
+		EstimatedEntries = FMath::Max(Count, EstimatedEntries - EstimatedEntries / 16);
+	}
+	Readbacks.RemoveAt(0, NumResolved);
+}
+
+FSceneTilePreprocessOutput AddSceneTilePreprocessPasses(FRDGBuilder& GraphBuilder, const FSceneView& View,
+                                                        const FIntRect& ViewRect,
+                                                        const TConstArrayView<FSceneTileRasterInput> Inputs,
+                                                        FSceneTileEntryCapacity& EntryCapacity,
+                                                        const FSceneTileOcclusion& Occlusion)
+{
+	const uint32 TotalResidentGaussians = GetTotalResidentGaussians(Inputs);
+	if (TotalResidentGaussians == 0 || ViewRect.Area() == 0)
+	{
+		return FSceneTilePreprocessOutput();
+	}
+
+	RDG_EVENT_SCOPE(GraphBuilder, "GaussianSplattingX TilePreprocess");
+	const ERDGPassFlags PassFlags = GetPreprocessPassFlags();
+	FPreprocessTarget Target = CreatePreprocessTarget(GraphBuilder, View, ViewRect, Occlusion, TotalResidentGaussians,
+	                                                  EntryCapacity.GetCapacity(TotalResidentGaussians), PassFlags);
+	AddPreprocessPasses(GraphBuilder, Target, nullptr, Inputs, PassFlags);
+	AddSortPasses(GraphBuilder, Target, PassFlags);
+	EntryCapacity.AddReadback(GraphBuilder, Target.TileEntryCounter);
+	return Target.Output;
+}
+
+void AddSceneTileStereoPreprocessPasses(FRDGBuilder& GraphBuilder, const FSceneView& LeftView,
+                                        const FIntRect& LeftViewRect, const FSceneView& RightView,
+                                        const FIntRect& RightViewRect,
+                                        const TConstArrayView<FSceneTileRasterInput> Inputs,
+                                        FSceneTileEntryCapacity& EntryCapacity,
+                                        const FSceneTileOcclusion& LeftOcclusion,
+                                        const FSceneTileOcclusion& RightOcclusion,
+                                        FSceneTilePreprocessOutput& OutLeft, FSceneTilePreprocessOutput& OutRight)
+{
+	if (CVarTileRasterStereoSharedPreprocess.GetValueOnRenderThread() == 0 || LeftViewRect.Area() == 0 ||
+		RightViewRect.Area() == 0)
+	{
+		OutLeft = AddSceneTilePreprocessPasses(GraphBuilder, LeftView, LeftViewRect, Inputs, EntryCapacity,
+		                                       LeftOcclusion);
+		OutRight = AddSceneTilePreprocessPasses(GraphBuilder, RightView, RightViewRect, Inputs, EntryCapacity,
+		                                        RightOcclusion);
+		return;
+	}
+
+	OutLeft = FSceneTilePreprocessOutput();
+	OutRight = FSceneTilePreprocessOutput();
+	const uint32 TotalResidentGaussians = GetTotalResidentGaussians(Inputs);
+	if (TotalResidentGaussians == 0)
+	{
+		return;
+	}
+
+	RDG_EVENT_SCOPE(GraphBuilder, "GaussianSplattingX TilePreprocess Stereo");
+	const ERDGPassFlags PassFlags = GetPreprocessPassFlags();
+	// 预处理的 Pass 共用同一个容量参数，两只眼睛使用相同的容量
+	const uint32 MaxTileEntries = EntryCapacity.GetCapacity(TotalResidentGaussians);
+	FPreprocessTarget Left = CreatePreprocessTarget(GraphBuilder, LeftView, LeftViewRect, LeftOcclusion,
+	                                                TotalResidentGaussians, MaxTileEntries, PassFlags);
+	FPreprocessTarget Right = CreatePreprocessTarget(GraphBuilder, RightView, RightViewRect, RightOcclusion,
+	                                                 TotalResidentGaussians, MaxTileEntries, PassFlags);
+	AddPreprocessPasses(GraphBuilder, Left, &Right, Inputs, PassFlags);
+	AddSortPasses(GraphBuilder, Left, PassFlags);
+	AddSortPasses(GraphBuilder, Right, PassFlags);
+	EntryCapacity.AddReadback(GraphBuilder, Left.TileEntryCounter);
+	EntryCapacity.AddReadback(GraphBuilder, Right.TileEntryCounter);
+	OutLeft = Left.Output;
+	OutRight = Right.Output;
+}
+
+void AddSceneTileRasterizePasses(FRDGBuilder& GraphBuilder, const FSceneView& View,
+                                 const FSceneTilePreprocessOutput& Preprocessed, FRDGTextureRef SceneColor,
+                                 FRDGTextureRef SceneDepth)
+{
+	if (!Preprocessed.IsValid())
+	{
+		return;
+	}
+
+	RDG_EVENT_SCOPE(GraphBuilder, "GaussianSplattingX TileRaster");
+	FGlobalShaderMap* ShaderMap = GetGlobalShaderMap(View.GetFeatureLevel());
+	const FIntRect& ViewRect = Preprocessed.ViewRect;
+	const FIntPoint ViewSize = ViewRect.Size();
+	const FIntPoint RasterSize = Preprocessed.RasterSize;
+	const FIntPoint TileCount = Preprocessed.TileCount;
+	const bool bUpsample = RasterSize != ViewSize;
+
+	// =============================== 光栅化 ===============================
+	FRDGTextureRef SplatTexture = GraphBuilder.CreateTexture(
+		FRDGTextureDesc::Create2D(RasterSize, PF_FloatRGBA, FClearValueBinding::None,
+		                          TexCreate_ShaderResource | TexCreate_UAV), TEXT("GaussianSplattingX.SplatTexture"));
+	FRDGTextureRef SplatDepthTexture = bUpsample
+		                                   ? GraphBuilder.CreateTexture(
+			                                   FRDGTextureDesc::Create2D(
+				                                   RasterSize, PF_R32_FLOAT, FClearValueBinding::None,
+				                                   TexCreate_ShaderResource | TexCreate_UAV),
+			                                   TEXT("GaussianSplattingX.SplatDepthTexture"))
+		                                   : nullptr;
+	{
+		FSceneTileRasterizeCS::FParameters* Parameters = GraphBuilder.AllocParameters<
+			FSceneTileRasterizeCS::FParameters>();
+		Parameters->View = View.ViewUniformBuffer;
+		Parameters->ViewSize = FVector2f(RasterSize);
+		Parameters->ViewMin = ViewRect.Min;
+		Parameters->TileCount = FUintVector2(TileCount.X, TileCount.Y);
+		Parameters->RasterToViewScale = FVector2f(ViewSize) / FVector2f(RasterSize);
+		Parameters->SceneViewSize = ViewSize;
+		Parameters->Splats = GraphBuilder.CreateSRV(Preprocessed.Splats);
+		Parameters->SortedSplats = GraphBuilder.CreateSRV(Preprocessed.SortedSplats, PF_R32_UINT);
+		Parameters->TileRanges = GraphBuilder.CreateSRV(Preprocessed.TileRanges, PF_R32_UINT);
+		Parameters->SceneDepthTexture = SceneDepth;
+		Parameters->RWOutputTexture = GraphBuilder.CreateUAV(SplatTexture);
+		Parameters->RWOutputDepthTexture = bUpsample ? GraphBuilder.CreateUAV(SplatDepthTexture) : nullptr;
+
+		FSceneTileRasterizeCS::FPermutationDomain PermutationVector;
+		PermutationVector.Set<FSceneTileUpsampleDim>(bUpsample);
+		FComputeShaderUtils::AddPass(GraphBuilder, RDG_EVENT_NAME("Rasterize (%dx%d tiles)", TileCount.X, TileCount.Y),
+		                             TShaderMapRef<FSceneTileRasterizeCS>(ShaderMap, PermutationVector), Parameters,
+		                             FIntVector(TileCount.X, TileCount.Y, 1));
+	}
+
+	// =============================== 合成 ===============================
+	{
+		FSceneTileCompositePS::FParameters* Parameters = GraphBuilder.AllocParameters<
+			FSceneTileCompositePS::FParameters>();
+		Parameters->View = View.ViewUniformBuffer;
+		Parameters->ViewMin = ViewRect.Min;
+		Parameters->RasterSize = RasterSize;
+		Parameters->ViewToRasterScale = FVector2f(RasterSize) / FVector2f(ViewSize);
+		Parameters->SplatTexture = SplatTexture;
+		Parameters->SplatDepthTexture = SplatDepthTexture;
+		Parameters->SceneDepthTexture = bUpsample ? SceneDepth : nullptr;
+		Parameters->RenderTargets[0] = FRenderTargetBinding(SceneColor, ERenderTargetLoadAction::ELoad);
+
+		// Dest = Src.rgb + Dest * Src.a，Src.a 是剩余的透射率
+		FSceneTileCompositePS::FPermutationDomain PermutationVector;
+		PermutationVector.Set<FSceneTileUpsampleDim>(bUpsample);
+		FPixelShaderUtils::AddFullscreenPass(GraphBuilder, ShaderMap,
+		                                     RDG_EVENT_NAME("Composite%s", bUpsample ? TEXT(" Upsample") : TEXT("")),
+		                                     TShaderMapRef<FSceneTileCompositePS>(ShaderMap, PermutationVector),
+		                                     Parameters, ViewRect,
+		                                     TStaticBlendState<CW_RGB, BO_Add, BF_One, BF_SourceAlpha>::GetRHI());
+	}
+}
+
+void AddSceneTileRasterPasses(FRDGBuilder& GraphBuilder, const FSceneView& View, const FIntRect& ViewRect,
+                              FRDGTextureRef SceneColor, FRDGTextureRef SceneDepth,
+                              const TConstArrayView<FSceneTileRasterInput> Inputs,
+                              FSceneTileEntryCapacity& EntryCapacity)
+{
+	const FSceneTilePreprocessOutput Preprocessed = AddSceneTilePreprocessPasses(GraphBuilder, View, ViewRect, Inputs,
+	                                                                             EntryCapacity);
+	AddSceneTileRasterizePasses(GraphBuilder, View, Preprocessed, SceneColor, SceneDepth);
+}
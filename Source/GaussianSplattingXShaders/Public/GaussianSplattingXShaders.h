@@ -0,0 +1,11 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Modules/ModuleManager.h"
+
+/// 在 PostConfigInit 阶段加载，负责映射 Shader 目录并注册全局 Shader
+class FGaussianSplattingXShadersModule : public IModuleInterface
+{
+public:
+    virtual void StartupModule() override;
+};
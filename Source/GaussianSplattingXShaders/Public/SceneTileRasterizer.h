@@ -0,0 +1,129 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "RenderGraphFwd.h"
+
+class FRHIGPUBufferReadback;
+class FSceneView;
+
+/// 一个需要用 Compute 光栅化的资产实例，Buffer 的布局和 Niagara Data Interface 使用的一致
+struct GAUSSIANSPLATTINGXSHADERS_API FSceneTileRasterInput
+{
+	FRDGBufferSRVRef PositionOpacityBuffer = nullptr;
+	FRDGBufferSRVRef ScaleBuffer = nullptr;
+	FRDGBufferSRVRef RotationBuffer = nullptr;
+	FRDGBufferSRVRef SHCoefficientsBuffer = nullptr;
+	FRDGBufferSRVRef SlotTableBuffer = nullptr;
+
+	/// 每个 Slot 中 Chunk 的包围盒，为空时这个输入不做遮挡剔除
+	FRDGBufferSRVRef SlotBoundsBuffer = nullptr;
+
+	uint32 ResidentGaussianCount = 0;
+	uint32 ChunkSize = 0;
+	uint32 SHCoefficientsCount = 0;
+
+	/// 绘制预算：不透明度低于 MinOpacity 的高斯被剔除，颜色最多使用 MaxSHCoefficientsCount 个 SH 系数
+	float MinOpacity = 0.0f;
+	uint32 MaxSHCoefficientsCount = MAX_uint32;
+
+	FMatrix LocalToWorld = FMatrix::Identity;
+};
+
+/// 上一帧的 HZB，预处理之前用来剔除被场景几何体完全遮挡的 Chunk
+/// @note 预处理在 BasePass 之前，这一帧的 HZB 还没有生成，所以用上一帧的矩阵把 Chunk 投影到上一帧的 HZB 上测试，
+/// 刚刚被露出来的 Chunk 会晚一帧出现
+struct GAUSSIANSPLATTINGXSHADERS_API FSceneTileOcclusion
+{
+	/// 最远深度的 HZB，为空时不剔除
+	FRDGTextureRef HZB = nullptr;
+
+	/// 生成 HZB 时的视图
+	FMatrix TranslatedWorldToClip = FMatrix::Identity;
+	FVector PreViewTranslation = FVector::ZeroVector;
+	FIntRect ViewRect;
+
+	bool IsValid() const { return HZB != nullptr && ViewRect.Area() > 0; }
+};
+
+/// 预处理的结果，光栅化时读取
+struct GAUSSIANSPLATTINGXSHADERS_API FSceneTilePreprocessOutput
+{
+	FRDGBufferRef Splats = nullptr;
+
+	/// 按 (Tile, 深度) 排序后每个条目对应的高斯序号
+	FRDGBufferRef SortedSplats = nullptr;
+
+	/// 每个 Tile 在 SortedSplats 中的起止位置，每个 Tile 两个 uint
+	FRDGBufferRef TileRanges = nullptr;
+
+	/// 预处理时使用的视图范围，光栅化时的范围不同则需要重新预处理
+	FIntRect ViewRect;
+
+	/// 光栅化的分辨率，小于视图范围时合成时按深度上采样
+	FIntPoint RasterSize = FIntPoint::ZeroValue;
+	FIntPoint TileCount = FIntPoint::ZeroValue;
+
+	bool IsValid() const { return Splats != nullptr; }
+};
+
+/// 记录每个视图实际生成的 Tile 条目数量，用来分配下一帧的条目列表
+/// @note 数量异步读回，突然增长的几帧中超出容量的条目被丢弃，直到读回的数量赶上
+struct GAUSSIANSPLATTINGXSHADERS_API FSceneTileEntryCapacity
+{
+	FSceneTileEntryCapacity();
+	~FSceneTileEntryCapacity();
+
+	/// 按已经读回的最大数量留出余量，还没有读回过时按高斯数量估计，不超过 GaussianSplattingX.TileRaster.MaxTileEntries
+	uint32 GetCapacity(uint32 MaxSplats);
+
+	/// 读回这一帧预处理追加的条目数量
+	void AddReadback(FRDGBuilder& GraphBuilder, FRDGBufferRef EntryCounter);
+
+private:
+	void ResolveReadbacks();
+
+	uint32 EstimatedEntries = 0;
+	TArray<TUniquePtr<FRHIGPUBufferReadback>> Readbacks;
+};
+
+/// 基于 Tile 的 Compute 光栅化：
+/// 1. 预处理：每个高斯投影到屏幕，计算二维协方差、颜色和覆盖的 Tile，每个覆盖的 Tile 追加一个 (深度, Tile) 条目
+/// 2. 排序：所有条目一起按 (Tile, 深度) 做稳定的基数排序，然后找出每个 Tile 的范围
+/// 3. 光栅化：每个 Tile 一个线程组，按排好的顺序从前到后混合，透射率足够低时提前结束，每个 Tile 的高斯数量没有上限
+/// 4. 合成：按透射率把结果混合到 SceneColor 上
+/// @note GaussianSplattingX.TileRaster.ResolutionScale 小于 1 时在低分辨率下光栅化，合成时按深度上采样。
+/// 视图范围已经包含引擎的动态分辨率，两者相乘
+/// @note 所有输入共享 Tile 列表，不同资产之间的高斯也按深度正确混合
+/// @param ViewRect SceneColor 中这个视图的范围
+/// @param EntryCapacity 调用者在帧之间保留，多个视图共用时按其中最多的条目数量分配
+GAUSSIANSPLATTINGXSHADERS_API void AddSceneTileRasterPasses(FRDGBuilder& GraphBuilder, const FSceneView& View,
+                                                            const FIntRect& ViewRect, FRDGTextureRef SceneColor,
+                                                            FRDGTextureRef SceneDepth,
+                                                            TConstArrayView<FSceneTileRasterInput> Inputs,
+                                                            FSceneTileEntryCapacity& EntryCapacity);
+
+/// 只添加预处理的 Pass，不读取场景纹理，所以可以在 BasePass 之前添加，在支持的平台上和 BasePass 在异步计算队列上重叠
+/// @param Occlusion 有效时先剔除被遮挡的 Chunk，预处理只为剩下的 Chunk 启动线程
+/// @return 没有需要绘制的高斯时返回无效的结果
+GAUSSIANSPLATTINGXSHADERS_API FSceneTilePreprocessOutput AddSceneTilePreprocessPasses(
+	FRDGBuilder& GraphBuilder, const FSceneView& View, const FIntRect& ViewRect,
+	TConstArrayView<FSceneTileRasterInput> Inputs, FSceneTileEntryCapacity& EntryCapacity,
+	const FSceneTileOcclusion& Occlusion = FSceneTileOcclusion());
+
+/// 立体渲染的两只眼睛共享一次预处理：每个高斯只读取一次并计算一次三维协方差和颜色，再分别投影到两只眼睛的 Tile 列表
+/// @note 颜色从两只眼睛的中点计算，每只眼睛仍然在各自的 Tile 中按各自的深度排序
+/// @note GaussianSplattingX.TileRaster.StereoSharedPreprocess 为 0 时退回到每只眼睛单独预处理
+/// @note 共享预处理时只剔除在两只眼睛中都被遮挡的 Chunk
+GAUSSIANSPLATTINGXSHADERS_API void AddSceneTileStereoPreprocessPasses(
+	FRDGBuilder& GraphBuilder, const FSceneView& LeftView, const FIntRect& LeftViewRect, const FSceneView& RightView,
+	const FIntRect& RightViewRect, TConstArrayView<FSceneTileRasterInput> Inputs, FSceneTileEntryCapacity& EntryCapacity,
+	const FSceneTileOcclusion& LeftOcclusion, const FSceneTileOcclusion& RightOcclusion,
+	FSceneTilePreprocessOutput& OutLeft, FSceneTilePreprocessOutput& OutRight);
+
+/// 预处理和排序的 Pass 是否在异步计算队列上，不在时它们和光栅化一样占用图形队列的时间
+GAUSSIANSPLATTINGXSHADERS_API bool IsSceneTilePreprocessAsync();
+
+/// 添加光栅化和合成的 Pass，需要在 SceneDepth 完成之后调用
+GAUSSIANSPLATTINGXSHADERS_API void AddSceneTileRasterizePasses(FRDGBuilder& GraphBuilder, const FSceneView& View,
+                                                               const FSceneTilePreprocessOutput& Preprocessed,
+                                                               FRDGTextureRef SceneColor, FRDGTextureRef SceneDepth);